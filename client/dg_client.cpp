@@ -19,12 +19,14 @@
 // [in] server_address - server address
 // [in] connection_timeout_ms - connection timeout in milliseconds
 // [in] inference_timeout_ms - AI server inference timeout in milliseconds
+// [in] client_options - client transport options
 // return - pointer to client object
 //
 DG::Client::ClientPtr DG::Client::create(
 	const std::string &server_address,
 	size_t connection_timeout_ms,
-	size_t inference_timeout_ms )
+	size_t inference_timeout_ms,
+	const ClientOptions &client_options )
 {
 	ClientPtr client;
 
@@ -33,13 +35,92 @@ DG::Client::ClientPtr DG::Client::create(
 	switch( addr.server_type )
 	{
 	case ServerType::ASIO:
-		client = std::make_shared< ClientAsio >( addr, connection_timeout_ms, inference_timeout_ms );
+	case ServerType::UNIX_SOCKET:
+	case ServerType::SHARED_MEMORY:
+		client = std::make_shared< ClientAsio >( addr, connection_timeout_ms, inference_timeout_ms, client_options );
 		break;
 	case ServerType::HTTP:
-		client = std::make_shared< ClientHttp >( addr, connection_timeout_ms, inference_timeout_ms );
+		client = std::make_shared< ClientHttp >( addr, connection_timeout_ms, inference_timeout_ms, client_options );
 		break;
 	default:
 		assert( 0 );
 	}
 	return client;
 }
+
+//
+// Frame slot allocated in the heap: the frame is sent by Client::dataSend() on commit
+//
+class HeapFrameSlot: public DG::FrameSlot
+{
+public:
+	// Constructor
+	// [in] client - client to send the frame
+	// [in] input_sizes - sizes of frame inputs, bytes
+	// [in] frame_info - frame information string to be passed to the callback along the frame result
+	// [in] deadline_ms - frame deadline in milliseconds since the slot is reserved; 0 for no deadline
+	HeapFrameSlot(
+		DG::Client &client,
+		const std::vector< size_t > &input_sizes,
+		const std::string &frame_info,
+		size_t deadline_ms ) :
+		m_client( client ), m_frame_info( frame_info ), m_deadline_ms( deadline_ms ),
+		m_reserved( std::chrono::steady_clock::now() ), m_committed( false )
+	{
+		for( auto size : input_sizes )
+			m_data.emplace_back( size );
+	}
+
+	// Get the number of frame inputs
+	size_t inputCountGet() const override
+	{
+		return m_data.size();
+	}
+
+	// Get the pointer to the data of the given frame input
+	void *inputDataGet( size_t index ) override
+	{
+		return m_data.at( index ).data();
+	}
+
+	// Send the frame; its deadline is counted from the reservation, so the time spent filling the slot is included
+	void commit() override
+	{
+		if( m_committed )
+			DG_ERROR( "FrameSlot::commit: the frame is already committed", ErrIncorrectAPIUse );
+		m_committed = true;
+
+		size_t deadline_ms = 0;
+		if( m_deadline_ms > 0 )
+		{
+			const auto elapsed = std::chrono::duration_cast< std::chrono::milliseconds >(
+				std::chrono::steady_clock::now() - m_reserved );
+			deadline_ms = m_deadline_ms > size_t( elapsed.count() ) ? m_deadline_ms - size_t( elapsed.count() ) : 1;
+		}
+		m_client.dataSend( std::move( m_data ), m_frame_info, deadline_ms );
+	}
+
+private:
+	DG::Client &m_client;                              //!< client to send the frame
+	std::vector< std::vector< char > > m_data;         //!< frame data
+	std::string m_frame_info;                          //!< frame information string
+	size_t m_deadline_ms;                              //!< frame deadline in milliseconds (or 0 for none)
+	std::chrono::steady_clock::time_point m_reserved;  //!< time when the slot is reserved
+	bool m_committed;                                  //!< the frame is committed
+};
+
+//
+// Reserve the space for the data of a single frame to be filled in place by the caller: heap buffers,
+// which are sent by dataSend() on commit
+// [in] input_sizes - sizes of frame inputs in bytes: one size per model input
+// [in] frame_info - optional frame information string to be passed to the callback along the frame result
+// [in] deadline_ms - optional frame deadline in milliseconds since the slot is reserved; 0 for no deadline
+// return frame slot object
+//
+std::unique_ptr< DG::FrameSlot > DG::Client::frameSlotReserve(
+	const std::vector< size_t > &input_sizes,
+	const std::string &frame_info,
+	size_t deadline_ms )
+{
+	return std::make_unique< HeapFrameSlot >( *this, input_sizes, frame_info, deadline_ms );
+}
@@ -12,6 +12,8 @@
 #ifndef DG_CLIENT_H_
 #define DG_CLIENT_H_
 
+#include <atomic>
+#include <chrono>
 #include "Utilities/dg_client_structs.h"
 #include "Utilities/dg_json_helpers.h"
 
@@ -33,11 +35,13 @@ public:
 	/// \param[in] server_address - server address in a format "[http://]host:port"
 	/// \param[in] connection_timeout_ms - connection timeout in milliseconds
 	/// \param[in] inference_timeout_ms - AI server inference timeout in milliseconds
+	/// \param[in] client_options - client transport options
 	/// \return - pointer to client object
 	static ClientPtr create(
 		const std::string &server_address,
 		size_t connection_timeout_ms = DEFAULT_CONNECTION_TIMEOUT_MS,
-		size_t inference_timeout_ms = DEFAULT_INFERENCE_TIMEOUT_MS );
+		size_t inference_timeout_ms = DEFAULT_INFERENCE_TIMEOUT_MS,
+		const ClientOptions &client_options = ClientOptions() );
 
 	/// Destructor
 	virtual ~Client()
@@ -93,10 +97,18 @@ public:
 	// Synchronous prediction API
 	//
 
+	/// Run prediction on given data frame. Stream should be opened by openStream()
+	/// \param[in] data - array of views of frame data: one view per model input
+	/// \param[out] output - prediction result (JSON array)
+	virtual void predict( const std::vector< ByteView > &data, json &output ) = 0;
+
 	/// Run prediction on given data frame. Stream should be opened by openStream()
 	/// \param[in] data - array containing frame data
 	/// \param[out] output - prediction result (JSON array)
-	virtual void predict( std::vector< std::vector< char > > &data, json &output ) = 0;
+	void predict( const std::vector< std::vector< char > > &data, json &output )
+	{
+		predict( byteViewsGet( data ), output );
+	}
 
 	//
 	// Asynchronous prediction API
@@ -112,15 +124,153 @@ public:
 	/// dataSend() methods
 	virtual void resultObserve( callback_t callback ) = 0;
 
+	/// Result post-processing callback type. The callback may modify the prediction result passed as the first
+	/// argument before it is passed to the user callback. Frame info string is passed as the second argument.
+	using postprocess_t = std::function< void( json &, const std::string & ) >;
+
 	/// Send given data frame for prediction. Prerequisites:
 	///   stream should be opened by openStream();
 	///   user callback to receive prediction results should be installed by resultObserve().
 	/// On the very first frame the method launches result receiving thread. This thread asynchronously
 	/// retrieves prediction results and for each result calls user callback installed by resultObserve().
 	/// To terminate this thread dataEnd() should be called when no more data frames are expected.
+	/// Each frame may have its own deadline: the time since the call, after which the frame result is useless.
+	/// Frames, which are still queued when their deadline is passed, are dropped without sending, and late results
+	/// are discarded: the callback is not called for them. See expiredFramesCountGet().
+	/// All dataSend() methods are safe to call from multiple threads concurrently: frame submission is serialized,
+	/// so frames are written to the server in the same order as their frame information strings are queued,
+	/// and each result is passed to the callback along with the frame information string of its own frame.
+	/// \param[in] data - array of views of frame data: one view per model input
+	/// \param[in] frame_info - optional frame information string to be passed to the callback along the frame result
+	/// \param[in] deadline_ms - optional frame deadline: time in milliseconds since the call, after which the frame
+	/// result is useless; 0 for no deadline
+	virtual void dataSend(
+		const std::vector< ByteView > &data,
+		const std::string &frame_info = "",
+		size_t deadline_ms = 0 ) = 0;
+
+	/// Send given data frame for prediction. See dataSend() overload accepting byte views for details.
 	/// \param[in] data - array containing frame data
 	/// \param[in] frame_info - optional frame information string to be passed to the callback along the frame result
-	virtual void dataSend( const std::vector< std::vector< char > > &data, const std::string &frame_info = "" ) = 0;
+	/// \param[in] deadline_ms - optional frame deadline in milliseconds; 0 for no deadline
+	void dataSend(
+		const std::vector< std::vector< char > > &data,
+		const std::string &frame_info = "",
+		size_t deadline_ms = 0 )
+	{
+		dataSend( byteViewsGet( data ), frame_info, deadline_ms );
+	}
+
+	/// Send given data frame for prediction taking ownership of frame data.
+	/// See dataSend() overload accepting byte views for details.
+	/// \param[in] data - array containing frame data; it is moved into the client
+	/// \param[in] frame_info - optional frame information string to be passed to the callback along the frame result
+	/// \param[in] deadline_ms - optional frame deadline in milliseconds; 0 for no deadline
+	virtual void dataSend(
+		std::vector< std::vector< char > > &&data,
+		const std::string &frame_info = "",
+		size_t deadline_ms = 0 )
+	{
+		dataSend( byteViewsGet( data ), frame_info, deadline_ms );
+	}
+
+	/// Send given data frame for prediction taking ownership of frame data, and deliver the frame result to given
+	/// completion object instead of the observation callback, which is not required then. The stream should be
+	/// opened by openStream(). Frames with completion objects and frames with frame information strings may be
+	/// mixed in one session. Safe to call from multiple threads, including completion methods of other frames.
+	/// Does not wait for space in the frame queue: the frame, which does not fit, waits for space after the call.
+	/// Exceptions are thrown only when the frame is not accepted; otherwise the completion object is notified
+	/// exactly once. See FrameCompletion and dataSend() overload accepting byte views for other details.
+	/// \param[in] data - array containing frame data; it is moved into the client
+	/// \param[in] completion - completion object to be notified when the frame result is ready or the frame
+	/// is dropped
+	/// \param[in] deadline_ms - optional frame deadline in milliseconds; 0 for no deadline
+	virtual void dataSend(
+		std::vector< std::vector< char > > &&data,
+		FrameCompletion &completion,
+		size_t deadline_ms = 0 ) = 0;
+
+	/// Try to send given data frame for prediction without waiting, and deliver the frame result to given completion
+	/// object. The frame is accepted only when it fits into the frame queue right away, regardless of frame overflow
+	/// policy: the frame, which does not fit, is neither dropped nor waits for space, and its data is left intact,
+	/// so the caller may retry it later. Frames waiting for space and the frame being sent in chunks by the frame
+	/// writer are not overtaken: the frame is not accepted while they exist. See dataSend() overload accepting
+	/// completion object for other details.
+	/// \param[in] data - array containing frame data; it is moved into the client only when the frame is accepted
+	/// \param[in] completion - completion object to be notified when the frame result is ready or the frame
+	/// is dropped; it is notified only when the frame is accepted
+	/// \param[in] deadline_ms - optional frame deadline in milliseconds; 0 for no deadline
+	/// \return true if the frame is accepted, false if the frame queue is full
+	virtual bool dataTrySend(
+		std::vector< std::vector< char > > &&data,
+		FrameCompletion &completion,
+		size_t deadline_ms = 0 ) = 0;
+
+	/// Send given batch of data frames for prediction. Frame queue space is reserved for as many frames of the batch
+	/// as possible at once, and frames are written using as few system calls as possible, so client overhead
+	/// per frame is lower than when sending frames one by one. See dataSend() overload accepting byte views
+	/// for other details.
+	/// \param[in] frames - array of frames; each frame is array of views of frame data: one view per model input
+	/// \param[in] frame_infos - frame information strings, one per frame, to be passed to the callback along
+	/// the frame results; may be empty to pass empty strings for all frames
+	/// \param[in] deadline_ms - optional deadline of each frame in milliseconds; 0 for no deadline
+	virtual void dataSendBatch(
+		const std::vector< std::vector< ByteView > > &frames,
+		const std::vector< std::string > &frame_infos = {},
+		size_t deadline_ms = 0 )
+	{
+		batchCheck( frames.size(), frame_infos );
+		for( size_t fi = 0; fi < frames.size(); fi++ )
+			dataSend( frames[ fi ], frame_infos.empty() ? std::string() : frame_infos[ fi ], deadline_ms );
+	}
+
+	/// Send given batch of data frames for prediction taking ownership of frames data.
+	/// See dataSendBatch() overload accepting byte views for details.
+	/// \param[in] frames - array of frames; each frame is array containing frame data; it is moved into the client
+	/// \param[in] frame_infos - frame information strings, one per frame, to be passed to the callback along
+	/// the frame results; may be empty to pass empty strings for all frames
+	/// \param[in] deadline_ms - optional deadline of each frame in milliseconds; 0 for no deadline
+	virtual void dataSendBatch(
+		std::vector< std::vector< std::vector< char > > > &&frames,
+		const std::vector< std::string > &frame_infos = {},
+		size_t deadline_ms = 0 )
+	{
+		batchCheck( frames.size(), frame_infos );
+		for( size_t fi = 0; fi < frames.size(); fi++ )
+			dataSend(
+				std::move( frames[ fi ] ),
+				frame_infos.empty() ? std::string() : frame_infos[ fi ],
+				deadline_ms );
+	}
+
+	/// Open writer, which sends the data of a single frame for prediction in chunks as the data becomes available.
+	/// Prerequisites are the same as for dataSend(). The frame is admitted into the frame queue when the writer
+	/// is opened, so the call blocks while the queue is full; when frame overflow policy drops the frame instead,
+	/// all chunks written to the writer are dropped as well. Frames sent by other threads wait until the writer
+	/// is finished or destroyed, and the thread, which opened the writer, cannot send other frames until then.
+	/// The writer should not outlive the client. See FrameWriter for details.
+	/// \param[in] frame_info - optional frame information string to be passed to the callback along the frame result
+	/// \param[in] deadline_ms - optional frame deadline in milliseconds since the writer is opened; 0 for no deadline
+	/// \return frame writer object
+	virtual std::unique_ptr< FrameWriter >
+	frameWriterOpen( const std::string & /*frame_info*/ = "", size_t /*deadline_ms*/ = 0 )
+	{
+		DG_ERROR( "frameWriterOpen: sending frames in chunks is not supported by server protocol", ErrNotSupported );
+		return nullptr;
+	}
+
+	/// Reserve the space for the data of a single frame to be filled in place by the caller and then sent for
+	/// prediction by FrameSlot::commit(). Prerequisites are the same as for dataSend(). By default the space is
+	/// allocated in the heap and the frame is sent by dataSend() on commit. The slot should not outlive the client.
+	/// See FrameSlot for details.
+	/// \param[in] input_sizes - sizes of frame inputs in bytes: one size per model input
+	/// \param[in] frame_info - optional frame information string to be passed to the callback along the frame result
+	/// \param[in] deadline_ms - optional frame deadline in milliseconds since the slot is reserved; 0 for no deadline
+	/// \return frame slot object
+	virtual std::unique_ptr< FrameSlot > frameSlotReserve(
+		const std::vector< size_t > &input_sizes,
+		const std::string &frame_info = "",
+		size_t deadline_ms = 0 );
 
 	/// Finalize the sequence of data frames. Should be called when no more data frames are
 	/// expected to terminate result receiving thread started by dataSend().
@@ -130,9 +280,151 @@ public:
 	/// Get # of outstanding inference results scheduled so far
 	virtual int outstandingResultsCountGet() = 0;
 
+	/// Set the range of adaptive frame queue depth. When max_depth is greater than min_depth, the number of
+	/// outstanding frames is adjusted within the range based on measured throughput and frame round-trip time,
+	/// starting from the frame queue depth given to openStream(). Otherwise the frame queue depth given to
+	/// openStream() is used. Should be called when no frames are outstanding.
+	/// \param[in] min_depth - lower bound of frame queue depth
+	/// \param[in] max_depth - upper bound of frame queue depth
+	virtual void frameQueueDepthRangeSet( size_t min_depth, size_t max_depth ) = 0;
+
+	/// Get frame queue depth status: current depth and, in adaptive mode, the measurements and the reasoning
+	/// of the last depth adjustment
+	virtual FrameQueueDepthStatus frameQueueDepthStatusGet() = 0;
+
+	/// Set the limit of the total size of data of outstanding frames. The limit is enforced along with the frame
+	/// queue depth: a frame is admitted into the frame queue when both the depth and the size limit allow it.
+	/// A frame, which is larger than the limit, is admitted when no other frames are outstanding. Should be called
+	/// when no frames are outstanding.
+	/// \param[in] max_bytes - limit of the total size of data of outstanding frames in bytes; 0 for no limit
+	virtual void frameQueueBytesLimitSet( size_t max_bytes ) = 0;
+
+	/// Set the policy of handling frames sent by dataSend() methods when the frame queue is full.
+	/// See FrameOverflowPolicy for details.
+	/// \param[in] policy - frame overflow policy
+	virtual void frameOverflowPolicySet( FrameOverflowPolicy policy ) = 0;
+
+	/// Get # of frames dropped according to frame overflow policy since the client is created
+	virtual size_t droppedFramesCountGet() = 0;
+
+	/// Get # of frames dropped or discarded due to passed deadlines since the client is created
+	virtual size_t expiredFramesCountGet() = 0;
+
+	/// Set which threads call the user callback installed by resultObserve(). See CallbackExecution for details.
+	/// When the callback is not called inline, dataEnd() also waits until callbacks of all received results return.
+	/// The number of results waiting for callbacks is limited by the maximum frame queue depth: when callbacks fall
+	/// behind, result reception waits for them like in inline mode.
+	/// Should be called when no frames are outstanding.
+	/// \param[in] mode - callback execution mode
+	/// \param[in] thread_count - number of threads for CallbackExecution::Pool mode; 0 for the number of CPU cores
+	/// \param[in] ordered - when true, in CallbackExecution::Pool mode the user callback is called in the order
+	/// of frames, one result at a time, while post-processing callbacks run concurrently
+	/// \param[in] postprocess - optional callback, which post-processes each result before the user callback
+	virtual void callbackExecutionSet(
+		CallbackExecution mode, size_t thread_count, bool ordered = false, postprocess_t postprocess = nullptr ) = 0;
+
 	/// If ever during consecutive calls to predict() methods server reported run-time error, then
 	/// this method will return error message string, otherwise it returns empty string.
 	virtual std::string lastError() = 0;
+
+protected:
+	/// Source of outstanding frame context: frame information string, frame deadline, frame data size,
+	/// and frame completion object
+	struct FrameContextSource
+	{
+		const std::string &info;                         //!< frame information string
+		std::chrono::steady_clock::time_point deadline;  //!< time after which the frame result is useless
+		size_t size;                                     //!< total size of frame inputs, bytes
+		FrameCompletion *completion;                     //!< frame completion object (or nullptr to use callback)
+	};
+
+	/// Context of outstanding frame kept in the frame queue
+	struct FrameContext
+	{
+		std::string info;                                //!< frame information string
+		std::chrono::steady_clock::time_point deadline;  //!< time after which the frame result is useless
+		size_t size = 0;                                 //!< total size of frame inputs, bytes
+		FrameCompletion *completion = nullptr;           //!< frame completion object (or nullptr to use callback)
+
+		/// Assign new frame context
+		/// \param[in] source - frame context source
+		FrameContext &operator=( const FrameContextSource &source )
+		{
+			info = source.info;
+			deadline = source.deadline;
+			size = source.size;
+			completion = source.completion;
+			return *this;
+		}
+
+		/// Check if the frame deadline is passed
+		/// \param[in] now - current time
+		bool expired( std::chrono::steady_clock::time_point now ) const
+		{
+			return deadline < now;
+		}
+	};
+
+	/// Get the deadline of the frame sent now
+	/// \param[in] deadline_ms - frame deadline in milliseconds; 0 for no deadline
+	static std::chrono::steady_clock::time_point deadlineGet( size_t deadline_ms )
+	{
+		return deadline_ms > 0 ? std::chrono::steady_clock::now() + std::chrono::milliseconds( deadline_ms ) :
+								 std::chrono::steady_clock::time_point::max();
+	}
+
+	/// Get total size of frame inputs
+	/// \param[in] frame - array of frame inputs, each element of which should provide data() and size() methods
+	/// \return total size of frame inputs, bytes
+	template< typename Container >
+	static size_t frameSizeGet( const std::vector< Container > &frame )
+	{
+		size_t size = 0;
+		for( const auto &input : frame )
+			size += input.size() * sizeof( *input.data() );
+		return size;
+	}
+
+	/// Reserve the space for frame data in the frame queue: add frame size to the total size of data of
+	/// outstanding frames, unless the limit is exceeded. When no frame data is outstanding, the frame is always
+	/// admitted, so frames larger than the limit can still be sent. Safe to call from multiple threads.
+	/// \param[in,out] queue_bytes - total size of data of outstanding frames, bytes
+	/// \param[in] size - frame size, bytes
+	/// \param[in] limit - limit of the total size of data of outstanding frames, bytes; 0 for no limit
+	/// \return true if the space is reserved
+	static bool frameBytesReserve( std::atomic_size_t &queue_bytes, size_t size, size_t limit )
+	{
+		size_t bytes = queue_bytes.load();
+		do
+		{
+			if( !frameBytesFit( bytes, size, limit ) )
+				return false;
+		} while( !queue_bytes.compare_exchange_weak( bytes, bytes + size ) );
+		return true;
+	}
+
+	/// Check if the frame data fits into the frame queue. See frameBytesReserve() for details.
+	/// \param[in] bytes - total size of data of outstanding frames, bytes
+	/// \param[in] size - frame size, bytes
+	/// \param[in] limit - limit of the total size of data of outstanding frames, bytes; 0 for no limit
+	static bool frameBytesFit( size_t bytes, size_t size, size_t limit )
+	{
+		return limit == 0 || bytes == 0 || bytes + size <= limit;
+	}
+
+	/// Check that frame information array matches the batch of frames
+	/// \param[in] frame_count - number of frames in the batch
+	/// \param[in] frame_infos - frame information strings: either empty or one per frame
+	static void batchCheck( size_t frame_count, const std::vector< std::string > &frame_infos )
+	{
+		if( !frame_infos.empty() && frame_infos.size() != frame_count )
+			DG_ERROR(
+				DG_FORMAT(
+					"dataSendBatch: number of frame info strings (" << frame_infos.size()
+																	<< ") does not match number of frames ("
+																	<< frame_count << ")" ),
+				ErrBadParameter );
+	}
 };
 }  // namespace DG
 
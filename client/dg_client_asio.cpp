@@ -23,22 +23,30 @@ namespace DG
 /// [in] server_address - server address
 /// [in] connection_timeout_ms - connection timeout in milliseconds
 /// [in] inference_timeout_ms - AI server inference timeout in milliseconds
+/// [in] client_options - client transport options
 ClientAsio::ClientAsio(
 	const ServerAddress &server_address,
 	size_t connection_timeout_ms,
-	size_t inference_timeout_ms ) :
+	size_t inference_timeout_ms,
+	const ClientOptions &client_options ) :
 	m_server_address( server_address ), m_command_socket( m_io_context ), m_stream_socket( m_io_context ),
-	m_async_result_callback( nullptr ), m_io_context(), m_async_outstanding_results( 0 ), m_async_stop( false ),
-	m_read_size( 0 ), m_frame_queue_depth( 0 ), m_connection_timeout_ms( connection_timeout_ms ),
-	m_inference_timeout_ms( inference_timeout_ms )
+	m_async_result_callback( nullptr ), m_io_context(), m_io_engine( main_protocol::IoEngine::sharedGet() ),
+	m_async_session( false ), m_async_pending_ops( 0 ), m_async_outstanding_results( 0 ), m_async_stop( false ),
+	m_async_error( false ), m_read_size( 0 ), m_frame_queue_depth( 0 ), m_rx_buffer_pool( BufferPool::create() ),
+	m_send_in_progress( false ), m_mux_stream( 0 ), m_mux_result_ready( false ),
+	m_connection_timeout_ms( connection_timeout_ms ), m_inference_timeout_ms( inference_timeout_ms ),
+	m_client_options( client_options ), m_server_protocol_version( 0 ), m_frame_writer_active( false ),
+	m_shm_writer_waiting( false ), m_shm_releases( 0 ), m_overflow_policy( FrameOverflowPolicy::Block ),
+	m_dropped_frames( 0 ), m_deadline_frames( false ), m_expired_frames( 0 ), m_frame_queue_bytes( 0 ),
+	m_frame_queue_bytes_limit( 0 ), m_pending_frames_count( 0 )
 {
 	DG_TRC_BLOCK( AIClientAsio, constructor, DGTrace::lvlBasic );
 
 	m_command_socket = main_protocol::socket_connect(
 		m_io_context,
-		m_server_address.ip,
-		m_server_address.port,
-		m_connection_timeout_ms / 1000 );
+		m_server_address,
+		m_connection_timeout_ms / 1000,
+		m_client_options );
 }
 
 // Destructor
@@ -47,7 +55,7 @@ ClientAsio::~ClientAsio()
 	DG_TRC_BLOCK( AIClientAsio, destructor, DGTrace::lvlBasic );
 	try
 	{
-		if( m_async_thread.joinable() )
+		if( m_async_session )
 			dataEnd();
 		closeStream();
 		m_command_socket.close();
@@ -73,9 +81,9 @@ void ClientAsio::shutdown()
 		DG_TRC_BLOCK( AIClientAsio, shutdown::socket_connect, DGTrace::lvlBasic );
 		auto temp_socket = main_protocol::socket_connect(
 			m_io_context,
-			m_server_address.ip,
-			m_server_address.port,
-			m_connection_timeout_ms / 1000 );
+			m_server_address,
+			m_connection_timeout_ms / 1000,
+			m_client_options );
 		main_protocol::write( temp_socket, "", 0 );
 		main_protocol::socket_close( temp_socket );
 	}
@@ -107,38 +115,104 @@ void ClientAsio::openStream(
 {
 	DG_TRC_BLOCK( AIClientAsio, openStream, DGTrace::lvlBasic );
 	m_frame_queue_depth = frame_queue_depth;
+	m_depth_controller.depthReset( frame_queue_depth );
+	frameQueuesReset();
 
 	json j_request = json( { { "op", main_protocol::commands::STREAM }, { "name", model_name } } );
 	if( !additional_model_parameters.empty() )
 		j_request[ "config" ] = additional_model_parameters;
 
+	// frames and results are passed in shared memory segment of the stream: create it and pass its descriptor to
+	// the server right after the stream request; the stream needs dedicated socket, so it is never multiplexed
+	const bool shared_memory = m_server_address.server_type == ServerType::SHARED_MEMORY;
+	if( shared_memory )
+	{
+		DG_TRC_BLOCK( AIClientAsio, openStream::shm, DGTrace::lvlBasic );
+		if( m_server_protocol_version == 0 )
+			ping( 0, false );
+		if( m_server_protocol_version < DG::SHM_MIN_PROTOCOL_VERSION )
+			DG_ERROR(
+				DG_FORMAT(
+					"AI server '" << std::string( m_server_address )
+								  << "' does not support shared memory transport. Please upgrade AI server instance "
+									 "to newer one." ),
+				ErrNotSupportedVersion );
+
+		closeStream();
+		m_shm = std::make_unique< SharedMemoryChannel >(
+			m_client_options.shared_memory_input_size,
+			m_client_options.shared_memory_result_size );
+		j_request[ "shm" ] = m_shm->configGet();
+	}
+
 	const auto request = DG::messagePrepare( j_request );
 
+	// open logical stream on multiplexed connection shared with other clients
+	if( MuxConnection::enabledGet() && !shared_memory )
+	{
+		DG_TRC_BLOCK( AIClientAsio, openStream::mux, DGTrace::lvlBasic );
+		closeStream();
+		m_mux = MuxConnection::get( m_server_address, m_connection_timeout_ms, m_client_options );
+		m_mux_stream = m_mux->streamOpen( [ this ]( const asio::error_code &ec, BufferPool::handle_t &&buffer ) {
+			muxReceive( ec, std::move( buffer ) );
+		} );
+		m_mux->write( m_mux_stream, request.data(), request.size() );
+		return;
+	}
+
 	{
 		DG_TRC_BLOCK( AIClientAsio, openStream::socket_connect, DGTrace::lvlBasic );
-		m_stream_socket = main_protocol::socket_connect(
-			m_io_context,
-			m_server_address.ip,
-			m_server_address.port,
-			m_connection_timeout_ms / 1000 );
+		if( m_io_engine != nullptr )
+			m_stream_socket =
+				m_io_engine->connect( m_server_address, m_connection_timeout_ms / 1000, m_client_options );
+		else
+			m_stream_socket = main_protocol::socket_connect(
+				m_io_context,
+				m_server_address,
+				m_connection_timeout_ms / 1000,
+				m_client_options );
 	}
 	main_protocol::write( m_stream_socket, request.data(), request.size() );
+#if !defined( _WIN32 )
+	if( m_shm != nullptr )
+		main_protocol::descriptor_send( m_stream_socket, m_shm->descriptorGet() );
+#endif
 }
 
 // Close stream opened by openStream()
 void ClientAsio::closeStream( void )
 {
 	DG_TRC_BLOCK( AIClientAsio, closeStream, DGTrace::lvlBasic );
-	if( m_stream_socket.is_open() )
+	if( m_mux != nullptr )
+	{
+		// send end-of-stream packet and release multiplexed connection
+		m_mux->streamClose( m_mux_stream );
+		m_mux.reset();
+	}
+	else if( m_stream_socket.is_open() )
 	{
 		// send empty packet to indicate end-of-stream;
 		// we use async write to avoid long timeouts when writing to closed socket
-		main_protocol::write_async( m_stream_socket, "", 0 );
+		auto wait_sent = main_protocol::write_async( m_stream_socket, std::vector< char >() );
 		DG_TRC_BLOCK( AIClientAsio, closeStream : write0, DGTrace::lvlDetailed );
-		main_protocol::run_async( m_io_context, std::min( m_connection_timeout_ms, size_t{ 500 } ) );
+		const size_t write_timeout_ms = std::min( m_connection_timeout_ms, size_t{ 500 } );
+		if( m_io_engine != nullptr )
+			wait_sent( write_timeout_ms );
+		else
+			main_protocol::run_async( m_io_context, write_timeout_ms );
 
 		main_protocol::socket_close( m_stream_socket );
+
+		// shared engine threads may still run completion handlers of cancelled reads and writes: wait for them
+		if( m_io_engine != nullptr )
+		{
+			std::unique_lock< std::mutex > lock( m_communication_mutex );
+			m_waiter.wait( lock, [ & ] { return m_async_pending_ops == 0; } );
+		}
 	}
+
+	// the server has its own mapping of shared memory segment: it is released when the server closes the stream
+	m_shm.reset();
 }
 
 // Get list of models in all model zoos of all active servers
@@ -240,28 +314,139 @@ bool ClientAsio::ping( double sleep_ms, bool ignore_errors )
 }
 
 // Run prediction on given data frame. Stream should be opened by openStream()
-// [in] data - array containing frame data
+// [in] data - array of views of frame data: one view per model input
 // [out] output - prediction result (JSON array)
-void ClientAsio::predict( std::vector< std::vector< char > > &data, json &output )
+void ClientAsio::predict( const std::vector< ByteView > &data, json &output )
 {
 	DG_TRC_BLOCK( AIClientAsio, predict::vector, DGTrace::lvlBasic );
-	if( !m_stream_socket.is_open() )
+	if( !streamIsOpen() )
 		DG_ERROR( "predict: socket was not opened", ErrIncorrectAPIUse );
 
-	// Send frame data
-	for( const auto &d : data )
-		main_protocol::write( m_stream_socket, d.data(), d.size() );
+	if( m_mux != nullptr )
+	{
+		{
+			std::lock_guard< std::mutex > lock( m_communication_mutex );
+			m_mux_result_ready = false;
+		}
+
+		// Send frame data and wait for the reply passed by multiplexed connection reader
+		streamWrite( &data, 1 );
 
-	// Read reply message
-	DG::JsonHelper::serial_container_t response_buffer;
-	main_protocol::read( m_stream_socket, response_buffer );
-	output = DG::JsonHelper::jsonDeserialize( response_buffer );
+		std::unique_lock< std::mutex > lock( m_communication_mutex );
+		if( !m_waiter.wait_for( lock, std::chrono::milliseconds( m_inference_timeout_ms ), [ & ] {
+				return m_mux_result_ready;
+			} ) )
+			DG_ERROR(
+				DG_FORMAT(
+					"Timeout " << m_inference_timeout_ms << " ms waiting for response from AI server '"
+							   << std::string( m_server_address ) << "'" ),
+				ErrTimeout );
+		if( m_mux_error )
+			DG_ERROR( m_mux_error.message(), ErrSystem );
+
+		output = DG::JsonHelper::jsonDeserialize( m_mux_result->data(), m_mux_result->size() );
+		m_mux_result.reset();
+	}
+	else
+	{
+		// Send frame data
+		streamWrite( &data, 1 );
+
+		// Read reply message into recycled buffer
+		auto response_buffer = m_rx_buffer_pool->acquire();
+		main_protocol::read( m_stream_socket, *response_buffer );
+		main_protocol::socket_quick_ack_rearm( m_stream_socket, m_client_options );
+		output = resultParse( response_buffer->data(), response_buffer->size() );
+	}
 
 	m_last_error = DG::JsonHelper::errorCheck( output, {}, false );
 	if( !m_last_error.empty() )
 		throw DGException( m_last_error, ErrOperationFailed );
 }
 
+//
+// Write frames to the stream, synchronously
+// [in] frames - pointer to the array of frames; each frame is an array of frame inputs
+// [in] frame_count - number of frames to write
+//
+template< typename Container >
+void ClientAsio::streamWrite( const std::vector< Container > *frames, size_t frame_count )
+{
+	if( m_shm != nullptr )
+	{
+		// copy frame inputs into shared memory and send their descriptors instead, frame by frame:
+		// space of the batch larger than the ring is released only by results of its first frames;
+		// waiting for space is abandoned when asynchronous session is aborted
+		std::vector< SharedMemoryChannel::Descriptor > descriptors;
+		std::vector< ByteView > descriptor_frame;
+		for( size_t fi = 0; fi < frame_count; fi++ )
+		{
+			descriptors.resize( frames[ fi ].size() );
+			if( !m_shm->framePut( frames[ fi ], descriptors.data(), m_inference_timeout_ms, [ this ] {
+					return m_async_session && m_async_error;
+				} ) )
+				DG_ERROR( lastError(), ErrOperationFailed );
+
+			descriptor_frame.clear();
+			for( const auto &descriptor : descriptors )
+				descriptor_frame.emplace_back( &descriptor, sizeof( descriptor ) );
+			try
+			{
+				main_protocol::write_frames( m_stream_socket, &descriptor_frame, 1 );
+			}
+			catch( ... )
+			{
+				// the frame is not delivered: its space is never released by the result
+				m_shm->frameUnreserve();
+				throw;
+			}
+		}
+	}
+	else if( m_mux != nullptr )
+		m_mux->writeFrames( m_mux_stream, frames, frame_count );
+	else
+		main_protocol::write_frames( m_stream_socket, frames, frame_count );
+}
+
+//
+// Parse result packet received from the stream. With shared memory transport the packet is the descriptor
+// of the result kept in shared memory.
+// [in] packet - result packet data
+// [in] size - result packet size, bytes
+// return parsed result
+//
+json ClientAsio::resultParse( const uint8_t *packet, size_t size )
+{
+	if( m_shm != nullptr )
+		return m_shm->resultProcess( packet, size, []( const uint8_t *data, size_t data_size ) {
+			return DG::JsonHelper::jsonDeserialize( data, data_size );
+		} );
+	return DG::JsonHelper::jsonDeserialize( packet, size );
+}
+
+//
+// Handler of results received for this client stream on multiplexed connection
+// [in] ec - connection error code
+// [in] buffer - received result packet
+//
+void ClientAsio::muxReceive( const asio::error_code &ec, BufferPool::handle_t &&buffer )
+{
+	// results of asynchronous session are processed the same way as results received from stream socket
+	if( m_async_session )
+	{
+		m_rx_buffer = std::move( buffer );
+		dataReceive( ec );
+		return;
+	}
+
+	// result of synchronous prediction
+	std::lock_guard< std::mutex > lock( m_communication_mutex );
+	m_mux_result = std::move( buffer );
+	m_mux_error = ec;
+	m_mux_result_ready = true;
+	m_waiter.notify_all();
+}
+
 //
 // Install prediction results observation callback
 // [in] callback - user callback, which will be called as soon as prediction result is ready when using dataSend()
@@ -270,201 +455,1685 @@ void ClientAsio::predict( std::vector< std::vector< char > > &data, json &output
 void ClientAsio::resultObserve( callback_t callback )
 {
 	DG_TRC_BLOCK( AIClientAsio, resultObserve, DGTrace::lvlBasic );
-	if( m_async_thread.joinable() )
+	if( m_async_session )
 		DG_ERROR(
-			"resultObserve: cannot install observation callback while result receiving thread is running",
+			"resultObserve: cannot install observation callback while asynchronous inference is running",
 			ErrIncorrectAPIUse );
 
 	m_async_result_callback = callback;
 }
 
+//
+// Lock, which serializes frame submission by concurrent producers: contexts of frames are put into the ring
+// of outstanding frames in the same order, in which frame data is queued or written. So frame submission is not
+// lock-free: the lock is held for admission of frames into the frame queue together with the push of their data
+// into the send queue, which must follow in the same order; both are short moves. The lock is released while
+// waiting for space and while the producer writes frame data itself; the result receiving thread takes it only
+// to admit pending frames. When the lock is released, completion objects of frames dropped during submission
+// are notified: they may submit new frames right away.
+//
+class ClientAsio::SubmitLock
+{
+public:
+	// Constructor. Acquires the lock.
+	// [in] client - client, which frame submission is serialized
+	explicit SubmitLock( ClientAsio &client ) : m_client( client ), m_lock( client.m_submit_mutex )
+	{}
+
+	// Destructor. Releases the lock and notifies completion objects of dropped frames.
+	~SubmitLock()
+	{
+		if( !m_lock.owns_lock() )
+			m_lock.lock();
+		if( m_client.m_dropped_completions.empty() )
+			return;
+
+		std::vector< dropped_frame_t > dropped;
+		dropped.swap( m_client.m_dropped_completions );
+		m_lock.unlock();
+		for( const auto &frame : dropped )
+		{
+			try
+			{
+				frame.first->frameDropped( frame.second );
+			}
+			catch( ... )
+			{}
+		}
+	}
+
+	// Release the lock while waiting
+	void unlock()
+	{
+		m_lock.unlock();
+	}
+
+	// Acquire the lock after waiting
+	void lock()
+	{
+		m_lock.lock();
+	}
+
+private:
+	ClientAsio &m_client;                  //!< client, which frame submission is serialized
+	std::unique_lock< std::mutex > m_lock;  //!< submission lock
+};
+
 //
 // Send given data frame for prediction. Prerequisites:
 //   stream should be opened by openStream();
 //   user callback to receive prediction results should be installed by resultObserve().
-// On the very first frame the method launches result receiving thread. This thread asynchronously
-// retrieves prediction results and for each result calls user callback installed by resultObserve().
-// To terminate this thread dataEnd() should be called when no more data frames are expected.
-// [in] data - array containing frame data
+// On the very first frame the method starts asynchronous inference session: when shared I/O engine is not used,
+// it launches result receiving thread. Results are retrieved asynchronously and for each result the user callback
+// installed by resultObserve() is called.
+// To finish the session dataEnd() should be called when no more data frames are expected.
+// [in] data - array of views of frame data: one view per model input
+// [in] frame_info - optional frame information string to be passed to the callback along the frame result
+// [in] deadline_ms - optional frame deadline in milliseconds; 0 for no deadline
 //
-void ClientAsio::dataSend( const std::vector< std::vector< char > > &data, const std::string &frame_info )
+void ClientAsio::dataSend( const std::vector< ByteView > &data, const std::string &frame_info, size_t deadline_ms )
 {
 	DG_TRC_BLOCK( AIClientAsio, dataSend, DGTrace::lvlDetailed, "(%zu bytes)", data.size() );
 
-	if( !m_stream_socket.is_open() )
-		DG_ERROR( "dataSend: socket was not opened", ErrIncorrectAPIUse );
+	// deadlines are counted from the call, so the time spent waiting for space is included
+	const size_t size = frameSizeGet( data );
+	SubmitLock lock( *this );
+	if( framesAdmit( lock, &frame_info, &size, 1, deadlineGet( deadline_ms ) ) > 0 )
+		viewFramesSend( lock, &data, 1 );
+}
 
-	if( m_async_result_callback == nullptr )
-		DG_ERROR( "dataSend: observation callback is not installed", ErrIncorrectAPIUse );
+//
+// Send given data frame for prediction, taking ownership of frame data.
+// The frame is put into the send queue and the method returns immediately: the frame is sent asynchronously
+// by the writer. See dataSend() overload accepting byte views for other details.
+// [in] data - vector of input data for each model input where each data element is a vector of bytes
+// [in] frame_info - optional frame information string to be passed to the callback along the frame result
+// [in] deadline_ms - optional frame deadline in milliseconds; 0 for no deadline
+//
+void ClientAsio::dataSend(
+	std::vector< std::vector< char > > &&data,
+	const std::string &frame_info,
+	size_t deadline_ms )
+{
+	DG_TRC_BLOCK( AIClientAsio, dataSend::queue, DGTrace::lvlDetailed, "(%zu bytes)", data.size() );
 
+	const size_t size = frameSizeGet( data );
 	{
-		std::unique_lock< std::mutex > lock( m_communication_mutex );
+		SubmitLock lock( *this );
+		if( framesAdmit( lock, &frame_info, &size, 1, deadlineGet( deadline_ms ) ) == 0 )
+			return;
+		sendEnqueue( std::move( data ) );
+	}
 
-		// check if error was detected
-		auto check_last_error = [ & ]() {
-			return m_async_stop && !m_last_error.empty();
-		};
+	// The frame order is defined by the send queue, so the writer is started without submission lock
+	sendStart();
+}
+
+//
+// Send given data frame for prediction taking ownership of frame data, and deliver the frame result to given
+// completion object. The frame is queued for sending the same way as by dataSend() overload accepting frame
+// information string. Once the frame is admitted, the completion object is notified exactly once.
+// [in] data - vector of input data for each model input where each data element is a vector of bytes
+// [in] completion - completion object to be notified when the frame result is ready or the frame is dropped
+// [in] deadline_ms - optional frame deadline in milliseconds; 0 for no deadline
+//
+void ClientAsio::dataSend(
+	std::vector< std::vector< char > > &&data,
+	FrameCompletion &completion,
+	size_t deadline_ms )
+{
+	DG_TRC_BLOCK( AIClientAsio, dataSend::completion, DGTrace::lvlDetailed, "(%zu bytes)", data.size() );
 
-		// If error occurred then return: no need to send frame
-		if( check_last_error() )
+	const auto deadline = deadlineGet( deadline_ms );
+	const size_t size = frameSizeGet( data );
+	bool admitted = false;
+	{
+		SubmitLock lock( *this );
+		if( framePend( data, completion, size, deadline ) )
 			return;
+		if( framesAdmit( lock, nullptr, &size, 1, deadline, &completion ) > 0 )
+		{
+			sendEnqueue( std::move( data ) );
+			admitted = true;
+		}
+	}
+
+	if( admitted )
+	{
+		sendStart();
+		return;
+	}
+
+	// The frame is not admitted: it is either dropped according to frame overflow policy, or the session is aborted
+	completion.frameDropped( m_async_error ? lastError() : "Frame is dropped according to frame overflow policy" );
+}
+
+//
+// Try to send given data frame for prediction without waiting, and deliver the frame result to given completion
+// object. The frame is accepted only when it fits into the frame queue right away; then it is queued for sending
+// the same way as by dataSend() overload accepting completion object.
+// [in] data - vector of input data for each model input; it is moved only when the frame is accepted
+// [in] completion - completion object to be notified when the frame result is ready or the frame is dropped
+// [in] deadline_ms - optional frame deadline in milliseconds; 0 for no deadline
+// return true if the frame is accepted, false if the frame queue is full
+//
+bool ClientAsio::dataTrySend(
+	std::vector< std::vector< char > > &&data,
+	FrameCompletion &completion,
+	size_t deadline_ms )
+{
+	DG_TRC_BLOCK( AIClientAsio, dataTrySend, DGTrace::lvlDetailed, "(%zu bytes)", data.size() );
+
+	const auto deadline = deadlineGet( deadline_ms );
+	const size_t size = frameSizeGet( data );
+	bool admitted = false;
+	{
+		SubmitLock lock( *this );
+
+		// the frame does not overtake pending frames, and does not wait for the frame being sent in chunks
+		if( !m_async_error && ( m_frame_writer_active || !m_pending_frames.empty() ) )
+			return false;
 
-		// Wait until number of outstanding frames becomes less than frame queue depth
-		if( m_async_outstanding_results >= m_frame_queue_depth )
+		if( framesAdmit( lock, nullptr, &size, 1, deadline, &completion, true ) > 0 )
 		{
-			if( !m_waiter.wait_for( lock, std::chrono::milliseconds( m_inference_timeout_ms ), [ & ] {
-					return m_async_outstanding_results < m_frame_queue_depth || m_async_stop;
-				} ) )
-			{
-				DG_ERROR(
-					DG_FORMAT(
-						"Timeout " << m_inference_timeout_ms << " ms waiting for space in queue on AI server '"
-								   << m_command_socket.remote_endpoint().address().to_string() << ":"
-								   << m_command_socket.remote_endpoint().port() << " (queue depth is "
-								   << m_frame_queue_depth << ")" ),
-					ErrTimeout );
-			}
+			sendEnqueue( std::move( data ) );
+			admitted = true;
 		}
+		else if( !m_async_error )
+			return false;
+	}
+
+	if( admitted )
+		sendStart();
+	else
+		completion.frameDropped( lastError() );  // the session is aborted: the frame is accepted and dropped
+	return true;
+}
+
+//
+// Send given batch of data frames for prediction. Frame queue space is reserved for as many frames of the batch
+// as possible at once, and all admitted frames are written by single gathered write, or copied into the send queue,
+// when other frames are being sent.
+// [in] frames - array of frames; each frame is array of views of frame data: one view per model input
+// [in] frame_infos - frame information strings, one per frame; may be empty to pass empty strings for all frames
+// [in] deadline_ms - optional deadline of each frame in milliseconds; 0 for no deadline
+//
+void ClientAsio::dataSendBatch(
+	const std::vector< std::vector< ByteView > > &frames,
+	const std::vector< std::string > &frame_infos,
+	size_t deadline_ms )
+{
+	DG_TRC_BLOCK( AIClientAsio, dataSendBatch, DGTrace::lvlDetailed, "(%zu frames)", frames.size() );
+	batchCheck( frames.size(), frame_infos );
 
-		// Check for error one more time: it may happen while waiting in the previous statement
-		if( check_last_error() )
+	std::vector< size_t > sizes( frames.size() );
+	for( size_t fi = 0; fi < frames.size(); fi++ )
+		sizes[ fi ] = frameSizeGet( frames[ fi ] );
+
+	// all frames of the batch share the deadline counted from the call
+	const auto deadline = deadlineGet( deadline_ms );
+	SubmitLock lock( *this );
+	for( size_t sent = 0; sent < frames.size(); )
+	{
+		const size_t admitted = framesAdmit(
+			lock,
+			frame_infos.empty() ? nullptr : &frame_infos[ sent ],
+			&sizes[ sent ],
+			frames.size() - sent,
+			deadline );
+		if( admitted == 0 )
 			return;
 
-		// Put frame info into the queue first
-		m_frame_info_queue.push( frame_info );
+		viewFramesSend( lock, &frames[ sent ], admitted );
+		sent += admitted;
+	}
+}
 
-		m_async_outstanding_results++;
+//
+// Send admitted frames, which data is owned by the caller. When the writer is idle, this thread takes it over
+// and writes the frames synchronously, so no data copy is made; the submission lock is released during the write,
+// so other producers, including completions called by the result receiving thread, are not blocked by the network:
+// their frames are queued and sent by the writer after these ones. When the writer is busy, the frames are copied
+// into the send queue behind the frames queued before. Multiplexed connection is shared by streams of other
+// clients, so it is written only asynchronously: the frames are always copied into the send queue.
+// [in] submit_lock - submission lock held by the caller
+// [in] frames - pointer to the array of frames; each frame is array of views of frame data
+// [in] frame_count - number of frames to send
+//
+void ClientAsio::viewFramesSend( SubmitLock &submit_lock, const std::vector< ByteView > *frames, size_t frame_count )
+{
+	if( m_mux == nullptr && m_send_ring.empty() && !m_send_in_progress.exchange( true ) )
+	{
+		submit_lock.unlock();
+		try
+		{
+			streamWrite( frames, frame_count );
+		}
+		catch( std::exception &e )
+		{
+			asyncAbort( e.what() );
+			sendPump();  // release the writer
+			throw;
+		}
+		sendPump();  // send frames queued meanwhile, or release the writer
+		submit_lock.lock();
+		return;
+	}
 
-		// If no read is in progress, initialize read
-		if( m_async_outstanding_results == 1 )
-			main_protocol::initiate_read( m_stream_socket, &m_read_size, [ this ]() { this->dataReceive(); } );
+	for( size_t fi = 0; fi < frame_count; fi++ )
+	{
+		frame_t frame;
+		frame.reserve( frames[ fi ].size() );
+		for( const auto &input : frames[ fi ] )
+			frame.emplace_back( input.data(), input.data() + input.size() );
+		sendEnqueue( std::move( frame ) );
 	}
+	sendStart();
+}
+
+//
+// Send given batch of data frames for prediction taking ownership of frames data.
+// Frames are put into the send queue as they are admitted into the frame queue, and sent asynchronously.
+// [in] frames - array of frames; each frame is array containing frame data; it is moved into the client
+// [in] frame_infos - frame information strings, one per frame; may be empty to pass empty strings for all frames
+// [in] deadline_ms - optional deadline of each frame in milliseconds; 0 for no deadline
+//
+void ClientAsio::dataSendBatch(
+	std::vector< std::vector< std::vector< char > > > &&frames,
+	const std::vector< std::string > &frame_infos,
+	size_t deadline_ms )
+{
+	DG_TRC_BLOCK( AIClientAsio, dataSendBatch::queue, DGTrace::lvlDetailed, "(%zu frames)", frames.size() );
+	batchCheck( frames.size(), frame_infos );
 
-	// Send data frames to server
-	for( const auto &d : data )
-		main_protocol::write( m_stream_socket, d.data(), d.size() );
+	std::vector< size_t > sizes( frames.size() );
+	for( size_t fi = 0; fi < frames.size(); fi++ )
+		sizes[ fi ] = frameSizeGet( frames[ fi ] );
 
-	// Start result receiving thread if not started yet
-	if( !m_async_thread.joinable() )
+	// all frames of the batch share the deadline counted from the call
+	const auto deadline = deadlineGet( deadline_ms );
+	SubmitLock lock( *this );
+	for( size_t sent = 0; sent < frames.size(); )
 	{
-		// If dataSend() is called on stopped thread, this means that either this is the very first call,
-		// or previous batch of frames was stopped, and somebody wants to restart it;
-		// either way we want to restart pipeline, so we reset m_async_stop flag
-		m_async_stop = false;
-		m_last_error = "";
+		const size_t admitted = framesAdmit(
+			lock,
+			frame_infos.empty() ? nullptr : &frame_infos[ sent ],
+			&sizes[ sent ],
+			frames.size() - sent,
+			deadline );
+		if( admitted == 0 )
+			return;
 
-		m_async_thread = std::thread( [ this ]() {
+		// Queue all admitted frames and wake up the writer, if it is idle
+		for( const size_t end = sent + admitted; sent < end; sent++ )
+			sendEnqueue( std::move( frames[ sent ] ) );
+		sendStart();
+	}
+}
+
+//
+// Writer of frame sent in chunks. Each chunk is sent by the caller thread before write() returns.
+// The frame is admitted into the frame queue when the writer is opened. When the session is aborted while
+// the frame is being sent, or the writer is destroyed before the frame is finished, the rest of the frame is dropped.
+//
+class ClientAsio::ChunkedWriter: public FrameWriter
+{
+public:
+	// Constructor
+	// [in] client - client, which stream is used to send the frame
+	// [in] dropped - true to drop all chunks: the frame is not admitted, since the session is aborted, or the frame
+	// is dropped according to frame overflow policy
+	ChunkedWriter( ClientAsio &client, bool dropped ) : m_client( client ), m_dropped( dropped )
+	{}
+
+	// Destructor. Aborts the frame, if it is not finished.
+	~ChunkedWriter() override
+	{
+		if( m_finished )
+			return;
+
+		// the server replies to aborted frame with error result, which aborts the session
+		if( !m_dropped )
+			drop();
+		m_client.frameWriterRelease();
+	}
+
+	// Send the next chunk of the current frame input
+	// [in] data - pointer to the chunk data
+	// [in] size - size of the chunk data in bytes
+	// [in] last - true when this is the last chunk of the current input
+	void write( const void *data, size_t size, bool last ) override
+	{
+		DG_TRC_BLOCK( AIClientAsio, ChunkedWriter::write, DGTrace::lvlDetailed, "(%zu bytes)", size );
+
+		if( m_finished )
+			DG_ERROR( "FrameWriter::write: the frame is already finished", ErrIncorrectAPIUse );
+
+		// session may be aborted while the frame is being sent: its result is not expected anymore
+		if( !m_dropped && m_client.m_async_error )
+			drop();
+
+		if( !m_dropped )
+		{
 			try
 			{
-				// Loop until stop is requested AND then all outstanding results are received
-				while( !m_async_stop || m_async_outstanding_results > 0 )
-				{
-					// Run ASIO executor until result is received or server disconnects or timeout happens
-					const size_t completed_tasks = main_protocol::run_async( m_io_context, m_inference_timeout_ms );
-					if( completed_tasks == 0 )
-						DG_ERROR(
-							DG_FORMAT(
-								"Timeout " << m_inference_timeout_ms << " ms waiting for response from AI server '"
-										   << m_stream_socket.remote_endpoint().address().to_string() << ":"
-										   << m_stream_socket.remote_endpoint().port() ),
-							ErrTimeout );
-
-					// Wait until a restart is signaled
-					{
-						std::unique_lock< std::mutex > lock( m_communication_mutex );
-						m_waiter.wait( lock, [ & ] { return m_async_outstanding_results > 0 || m_async_stop; } );
-					}
-				}
+				m_client.chunkSend( static_cast< const char * >( data ), size, last );
 			}
 			catch( std::exception &e )
 			{
-				// signal abort in case of communication error
-				{
-					std::lock_guard< std::mutex > lock( m_communication_mutex );
-					m_last_error = e.what();
-					m_async_outstanding_results = 0;
-					m_async_stop = true;
-				}
-				m_waiter.notify_all();  // notify main thread to stop waiting
+				// partially sent frame breaks the stream
+				m_dropped = true;
+				m_client.asyncAbort( e.what() );
+				throw;
 			}
-		} );
+		}
+		m_input_open = !last;
 	}
-	else
+
+	// Finish the frame
+	void finish() override
 	{
-		// Signal a restart
-		m_waiter.notify_all();  // notify result receiving thread
+		if( m_finished )
+			return;
+		if( m_input_open )
+			write( nullptr, 0, true );
+		m_finished = true;
+		m_client.frameWriterRelease();
 	}
-}
+
+private:
+	// Drop the rest of the frame: make the server drop the frame
+	void drop()
+	{
+		m_dropped = true;
+		m_client.chunkAbortSend();
+	}
+
+	ClientAsio &m_client;       //!< client, which stream is used to send the frame
+	bool m_dropped;             //!< the rest of the frame is dropped
+	bool m_input_open = false;  //!< the last chunk of the current input is not sent yet
+	bool m_finished = false;    //!< the frame is finished
+};
 
 //
-// Callback for asynchronous read. Receives incoming message size and completes read. Schedules next read, if any are
-// outstanding.
+// Open writer, which sends the data of a single frame for prediction in chunks as the data becomes available.
+// Chunks are written synchronously by the caller thread.
+// [in] frame_info - optional frame information string to be passed to the callback along the frame result
+// [in] deadline_ms - optional frame deadline in milliseconds since the writer is opened; 0 for no deadline
+// return frame writer object
 //
-void ClientAsio::dataReceive()
+std::unique_ptr< FrameWriter > ClientAsio::frameWriterOpen( const std::string &frame_info, size_t deadline_ms )
 {
-	DG_TRC_BLOCK( AIClientAsio, dataReceive, DGTrace::lvlDetailed );
+	DG_TRC_BLOCK( AIClientAsio, frameWriterOpen, DGTrace::lvlDetailed );
+	const auto deadline = deadlineGet( deadline_ms );
 
-	// We now know size of incoming message, and can complete its read
-	DG::JsonHelper::serial_container_t response_buffer;
-	main_protocol::handle_read( m_stream_socket, response_buffer, m_read_size );
+	if( m_shm != nullptr )
+		DG_ERROR( "Sending frames in chunks is not supported by shared memory transport", ErrNotSupported );
 
-	// Parse result and check for error
-	const json result = DG::JsonHelper::jsonDeserialize( response_buffer );
-	const std::string err_msg = DG::JsonHelper::errorCheck( result, "", false );
+	// the server should support chunked frame inputs: query its protocol version, if not known yet
+	if( m_server_protocol_version == 0 )
+		ping( 0, false );
+	if( m_server_protocol_version < DG::CHUNKED_MIN_PROTOCOL_VERSION )
+		DG_ERROR(
+			DG_FORMAT(
+				"AI server '" << std::string( m_server_address )
+							  << "' does not support sending frames in chunks. Please upgrade AI server instance to "
+								 "newer one." ),
+			ErrNotSupportedVersion );
 
-	std::string frame_info;
+	// the size of the frame is not known in advance: it is not accounted in the frame queue size
+	bool admitted;
 	{
-		std::lock_guard< std::mutex > lock( m_communication_mutex );
-
-		// Get frame info
-		frame_info = m_frame_info_queue.front();
-		m_frame_info_queue.pop();
+		// other frames are not admitted after this one until the writer is finished
+		SubmitLock lock( *this );
+		admitted = framesAdmit( lock, &frame_info, nullptr, 1, deadline ) > 0;
+		m_frame_writer_thread = std::this_thread::get_id();
+		m_frame_writer_active = true;
+	}
 
-		if( !err_msg.empty() )
+	// chunks are sent synchronously after all queued frames, so frame order is kept;
+	// the writer is not yet returned, so it is released here on error
+	if( admitted )
+	{
+		try
 		{
-			m_last_error = err_msg;
-
-			// abort worker thread in case of error
-			m_async_outstanding_results = 0;
-			m_async_stop = true;
+			sendQueueDrain();
+		}
+		catch( ... )
+		{
+			m_frame_writer_active = false;
+			m_frame_info_ring.notifyAll();
+			throw;
 		}
-		else
-			m_async_outstanding_results--;
-
-		// If there are unanswered requests, initialize another read
-		if( m_async_outstanding_results > 0 )
-			main_protocol::initiate_read( m_stream_socket, &m_read_size, [ this ]() { this->dataReceive(); } );
-
-		m_waiter.notify_all();  // notify result receiving thread
 	}
 
-	// Invoke user callback: catch all errors
-	try
+	return std::make_unique< ChunkedWriter >( *this, !admitted );
+}
+
+//
+// Let other frames be sent after the frame opened by frameWriterOpen() or frameSlotReserve() is finished:
+// wake up producers waiting for the writer, and admit frames, which became pending while the frame was being sent
+//
+void ClientAsio::frameWriterRelease()
+{
+	m_frame_writer_active = false;
+	m_frame_info_ring.notifyAll();
+	if( m_pending_frames_count > 0 )
 	{
-		m_async_result_callback( result, frame_info );
+		SubmitLock lock( *this );
+		pendingFramesAdmit();
 	}
-	catch( ... )
-	{}
 }
 
 //
-// Finalize the sequence of data frames. Should be called when no more data frames are
-// expected to terminate result receiving thread started by dataSend().
+// Frame slot located in shared memory segment of the stream. Input space is reserved in the input ring when
+// the slot is created, and only input descriptors are sent on commit. When the frame is not admitted, inputs are
+// filled into heap buffers, which are discarded on commit.
 //
-void ClientAsio::dataEnd()
+class ClientAsio::SharedMemorySlot: public FrameSlot
 {
-	DG_TRC_BLOCK( AIClientAsio, dataEnd, DGTrace::lvlBasic );
+public:
+	// Constructor
+	// [in] client - client, which stream is used to send the frame
+	// [in] input_sizes - sizes of frame inputs, bytes
+	// [in] descriptors - descriptors of reserved input space, one per input; empty to drop the frame
+	SharedMemorySlot(
+		ClientAsio &client,
+		const std::vector< size_t > &input_sizes,
+		std::vector< SharedMemoryChannel::Descriptor > &&descriptors ) :
+		m_client( client ), m_descriptors( std::move( descriptors ) ), m_committed( false )
+	{
+		if( m_descriptors.empty() )
+			for( auto size : input_sizes )
+				m_dropped_data.emplace_back( size );
+	}
 
-	// set stop flag under lock to serialize with result receiving thread
+	// Destructor. Aborts the frame, if it is not committed: reserved space is released only by the frame result,
+	// so the session is aborted.
+	~SharedMemorySlot() override
 	{
-		std::lock_guard< std::mutex > lock( m_communication_mutex );
-		m_async_stop = true;
+		if( m_committed )
+			return;
+		if( !m_descriptors.empty() )
+			m_client.asyncAbort( "Frame slot is destroyed without commit" );
+		m_client.frameWriterRelease();
 	}
-	m_waiter.notify_all();  // notify result receiving thread
 
-	// join result receiving thread
-	if( m_async_thread.joinable() )
-		m_async_thread.join();
+	// Get the number of frame inputs
+	size_t inputCountGet() const override
+	{
+		return m_descriptors.empty() ? m_dropped_data.size() : m_descriptors.size();
+	}
+
+	// Get the pointer to the data of the given frame input
+	void *inputDataGet( size_t index ) override
+	{
+		if( m_descriptors.empty() )
+			return m_dropped_data.at( index ).data();
+		return m_client.m_shm->inputDataGet( m_descriptors.at( index ) );
+	}
+
+	// Send the frame: send descriptors of its inputs
+	void commit() override
+	{
+		DG_TRC_BLOCK( AIClientAsio, SharedMemorySlot::commit, DGTrace::lvlDetailed );
+
+		if( m_committed )
+			DG_ERROR( "FrameSlot::commit: the frame is already committed", ErrIncorrectAPIUse );
+		m_committed = true;
+
+		if( !m_descriptors.empty() )
+		{
+			try
+			{
+				std::vector< ByteView > frame;
+				for( const auto &descriptor : m_descriptors )
+					frame.emplace_back( &descriptor, sizeof( descriptor ) );
+				main_protocol::write_frames( m_client.m_stream_socket, &frame, 1 );
+			}
+			catch( std::exception &e )
+			{
+				// partially sent frame breaks the stream
+				m_client.asyncAbort( e.what() );
+				m_client.frameWriterRelease();
+				throw;
+			}
+		}
+		m_client.frameWriterRelease();
+	}
+
+private:
+	ClientAsio &m_client;                                         //!< client, which stream is used to send the frame
+	std::vector< SharedMemoryChannel::Descriptor > m_descriptors;  //!< descriptors of reserved input space
+	std::vector< std::vector< char > > m_dropped_data;             //!< input buffers of the dropped frame
+	bool m_committed;                                              //!< the frame is committed
+};
+
+//
+// Reserve the space for the data of a single frame to be filled in place by the caller. With shared memory
+// transport the space is reserved in the input ring of the segment, so the frame is admitted into the frame
+// queue right away, and other frames wait until the slot is committed or destroyed, as for the frame writer.
+// [in] input_sizes - sizes of frame inputs in bytes: one size per model input
+// [in] frame_info - optional frame information string to be passed to the callback along the frame result
+// [in] deadline_ms - optional frame deadline in milliseconds since the slot is reserved; 0 for no deadline
+// return frame slot object
+//
+std::unique_ptr< FrameSlot > ClientAsio::frameSlotReserve(
+	const std::vector< size_t > &input_sizes,
+	const std::string &frame_info,
+	size_t deadline_ms )
+{
+	DG_TRC_BLOCK( AIClientAsio, frameSlotReserve, DGTrace::lvlDetailed );
+
+	if( m_shm == nullptr )
+		return Client::frameSlotReserve( input_sizes, frame_info, deadline_ms );
+
+	const auto deadline = deadlineGet( deadline_ms );
+
+	size_t size = 0;
+	for( auto input_size : input_sizes )
+		size += input_size;
+
+	bool admitted;
+	{
+		// other frames are not admitted after this one until the slot is committed
+		SubmitLock lock( *this );
+		admitted = framesAdmit( lock, &frame_info, &size, 1, deadline ) > 0;
+		m_frame_writer_thread = std::this_thread::get_id();
+		m_frame_writer_active = true;
+	}
+
+	// the space is reserved after all queued frames, so frame order is kept; waiting for space is abandoned
+	// when asynchronous session is aborted; the slot is not yet returned, so it is released here on error
+	std::vector< SharedMemoryChannel::Descriptor > descriptors;
+	if( admitted )
+	{
+		try
+		{
+			sendQueueDrain();
+			descriptors.resize( input_sizes.size() );
+			if( !m_shm->frameReserve( input_sizes, descriptors.data(), m_inference_timeout_ms, [ this ] {
+					return m_async_session && m_async_error;
+				} ) )
+				descriptors.clear();
+		}
+		catch( ... )
+		{
+			frameWriterRelease();
+			throw;
+		}
+	}
+
+	return std::make_unique< SharedMemorySlot >( *this, input_sizes, std::move( descriptors ) );
+}
+
+//
+// Send next chunk of the frame opened by frameWriterOpen(), synchronously
+// [in] data - chunk data
+// [in] size - size of chunk data, in bytes
+// [in] last - true for the last chunk of frame input
+//
+void ClientAsio::chunkSend( const char *data, size_t size, bool last )
+{
+	if( m_mux != nullptr )
+		m_mux->writeChunk( m_mux_stream, data, size, last );
+	else
+		main_protocol::write_chunk( m_stream_socket, data, size, last );
+}
+
+//
+// Send chunk abort marker to drop partially sent frame on the server side.
+// The server replies to the dropped frame with error result; when the marker cannot be sent, the session is aborted.
+//
+void ClientAsio::chunkAbortSend()
+{
+	try
+	{
+		if( m_mux != nullptr )
+			m_mux->writeChunkAbort( m_mux_stream );
+		else
+			main_protocol::write_chunk_abort( m_stream_socket );
+	}
+	catch( std::exception &e )
+	{
+		asyncAbort( e.what() );
+	}
+}
+
+//
+// Set the range of adaptive frame queue depth. See Client::frameQueueDepthRangeSet() for details.
+// [in] min_depth - lower bound of frame queue depth
+// [in] max_depth - upper bound of frame queue depth
+//
+void ClientAsio::frameQueueDepthRangeSet( size_t min_depth, size_t max_depth )
+{
+	DG_TRC_BLOCK( AIClientAsio, frameQueueDepthRangeSet, DGTrace::lvlBasic );
+
+	if( m_async_outstanding_results > 0 || !m_frame_info_ring.empty() )
+		DG_ERROR(
+			"frameQueueDepthRangeSet: frame queue depth cannot be changed while frames are outstanding",
+			ErrIncorrectAPIUse );
+
+	m_depth_controller.rangeSet( min_depth, max_depth, m_frame_queue_depth );
+	frameQueuesReset();
+}
+
+//
+// Set the limit of the total size of data of outstanding frames. See Client::frameQueueBytesLimitSet() for details.
+// [in] max_bytes - limit of the total size of data of outstanding frames in bytes; 0 for no limit
+//
+void ClientAsio::frameQueueBytesLimitSet( size_t max_bytes )
+{
+	DG_TRC_BLOCK( AIClientAsio, frameQueueBytesLimitSet, DGTrace::lvlBasic );
+
+	if( m_async_outstanding_results > 0 || !m_frame_info_ring.empty() )
+		DG_ERROR(
+			"frameQueueBytesLimitSet: frame queue size limit cannot be changed while frames are outstanding",
+			ErrIncorrectAPIUse );
+
+	m_frame_queue_bytes_limit = max_bytes;
+}
+
+//
+// Set which threads call the user callback. See Client::callbackExecutionSet() for details.
+// [in] mode - callback execution mode
+// [in] thread_count - number of threads for CallbackExecution::Pool mode; 0 for the number of CPU cores
+// [in] ordered - call the user callback in the order of frames in CallbackExecution::Pool mode
+// [in] postprocess - optional callback, which post-processes each result before the user callback
+//
+void ClientAsio::callbackExecutionSet(
+	CallbackExecution mode, size_t thread_count, bool ordered, postprocess_t postprocess )
+{
+	DG_TRC_BLOCK( AIClientAsio, callbackExecutionSet, DGTrace::lvlBasic );
+
+	if( m_async_outstanding_results > 0 || !m_frame_info_ring.empty() )
+		DG_ERROR(
+			"callbackExecutionSet: callback execution mode cannot be changed while frames are outstanding",
+			ErrIncorrectAPIUse );
+
+	m_callback_executor.configure( mode, thread_count, ordered );
+	m_result_postprocess = postprocess;
+}
+
+//
+// Reallocate frame queues for the maximum depth allowed by the depth controller and apply its current depth.
+// Should be called when no frames are outstanding.
+//
+void ClientAsio::frameQueuesReset()
+{
+	const size_t capacity = m_depth_controller.capacityGet();
+	m_frame_info_ring.reset( capacity );
+	m_send_ring.reset( capacity );
+	m_frame_info_ring.limitSet( m_depth_controller.depthGet() );
+	m_callback_executor.capacitySet( capacity );
+}
+
+//
+// Admit next frames into asynchronous inference session: start session if not started, wait for space in
+// the ring of outstanding frames and for space for frame data, and put as many frames as fit there.
+// Should be called under submission lock, which is released while waiting, so other producers are not blocked
+// by the waiting one. In steady state the ring mutex is held only for each push, and the communication lock
+// is taken only to start the read chain, when the first frame becomes outstanding.
+// [in] submit_lock - submission lock held by the caller
+// [in] frame_infos - pointer to the array of frame information strings; nullptr to use empty strings
+// [in] frame_sizes - pointer to the array of frame sizes in bytes; nullptr when sizes are not known
+// [in] count - number of frames to admit
+// [in] deadline - deadline of all frames to admit; time_point::max() for no deadline
+// [in] completion - completion object of the single frame to admit (or nullptr to use callback)
+// [in] no_wait - true to admit frames only when they fit right away, without waiting and without dropping
+// return number of admitted frames, from 1 to count; 0 if the session is aborted due to error,
+// or all frames are dropped according to frame overflow policy (or not admitted in no-wait mode)
+//
+size_t ClientAsio::framesAdmit(
+	SubmitLock &submit_lock,
+	const std::string *frame_infos,
+	const size_t *frame_sizes,
+	size_t count,
+	std::chrono::steady_clock::time_point deadline,
+	FrameCompletion *completion,
+	bool no_wait )
+{
+	if( !streamIsOpen() )
+		DG_ERROR( "dataSend: socket was not opened", ErrIncorrectAPIUse );
+
+	if( completion == nullptr && m_async_result_callback == nullptr )
+		DG_ERROR( "dataSend: observation callback is not installed", ErrIncorrectAPIUse );
+
+	// Frames of concurrent producers are not admitted until the frame being sent in chunks is finished
+	frameWriterWait( submit_lock );
+
+	// If dataSend() is called outside of session, this means that either this is the very first call,
+	// or previous batch of frames was finished by dataEnd(), and somebody wants to restart it;
+	// either way we want to restart pipeline, so we reset stop flag and error
+	if( !m_async_session )
+	{
+		std::lock_guard< std::mutex > lock( m_communication_mutex );
+		m_async_session = true;
+		m_async_stop = false;
+		m_async_error = false;
+		m_async_outstanding_results = 0;
+		m_deadline_frames = false;
+		m_frame_queue_bytes = 0;
+		m_last_error = "";
+		m_depth_controller.restart();  // idle time before the session would distort depth measurements
+	}
+
+	// If error occurred then return: no need to send frame
+	if( m_async_error )
+		return 0;
+
+	// Frames with deadlines may wait in the send queue: drop expired ones to free their space
+	if( deadline != std::chrono::steady_clock::time_point::max() )
+		m_deadline_frames = true;
+	if( m_deadline_frames && !m_send_ring.empty() )
+		unsentFramesExpire();
+
+	static const std::string empty_frame_info;
+	auto frame_info = [ & ]( size_t i ) {
+		return FrameContextSource{ frame_infos != nullptr ? frame_infos[ i ] : empty_frame_info,
+								   deadline,
+								   frame_sizes != nullptr ? frame_sizes[ i ] : 0,
+								   completion };
+	};
+
+	// Put frame into the ring of outstanding frames, when there is space for its data, without waiting
+	auto frame_try_push = [ & ]( const FrameContextSource &frame ) {
+		if( !bytesReserve( frame.size ) )
+			return false;
+		if( m_frame_info_ring.tryPush( frame ) )
+			return true;
+		m_frame_queue_bytes -= frame.size;
+		return false;
+	};
+
+	const FrameContextSource first = frame_info( 0 );
+	const FrameOverflowPolicy policy = m_overflow_policy;
+	if( no_wait )
+	{
+		// The caller decides what to do with frames, which do not fit
+		if( !frame_try_push( first ) )
+			return 0;
+	}
+	else if( policy != FrameOverflowPolicy::Block )
+	{
+		// Do not wait for space in the frame queue: either replace unsent frame or drop all frames
+		if( !frame_try_push( first ) )
+		{
+			if( policy == FrameOverflowPolicy::DropOldestUnsent && unsentFrameReplace( first ) )
+				return 1;  // the number of outstanding frames is not changed, and the read chain is running
+			m_dropped_frames += count;
+			return 0;
+		}
+	}
+	else
+	{
+		// Wait until there is a space for frame data and a space in the ring of outstanding frames;
+		// other producers may take the space meanwhile, so the frame is pushed under the lock after waiting
+		const auto wait_end = std::chrono::steady_clock::now() + std::chrono::milliseconds( m_inference_timeout_ms );
+		auto space = [ & ] {
+			return ( m_frame_info_ring.size() < m_frame_info_ring.limitGet() &&
+					 frameBytesFit( m_frame_queue_bytes, first.size, m_frame_queue_bytes_limit ) ) ||
+				   m_async_error;
+		};
+
+		bool pushed = frame_try_push( first );
+		while( !pushed )
+		{
+			const auto now = std::chrono::steady_clock::now();
+			if( now >= wait_end )
+				break;
+
+			submit_lock.unlock();
+			const bool waited = m_frame_info_ring.wait(
+				space,
+				std::chrono::duration_cast< std::chrono::milliseconds >( wait_end - now ) );
+			submit_lock.lock();
+			if( !waited || m_async_error )
+				break;
+
+			// frame writer may be opened by other thread while the lock was released
+			frameWriterWait( submit_lock );
+			pushed = frame_try_push( first );
+		}
+
+		if( !pushed )
+		{
+			// Error may happen while waiting
+			if( m_async_error )
+				return 0;
+
+			DG_ERROR(
+				DG_FORMAT(
+					"Timeout " << m_inference_timeout_ms << " ms waiting for space in queue on AI server '"
+							   << main_protocol::endpoint_to_string( m_command_socket.remote_endpoint() )
+							   << " (queue depth is " << m_frame_info_ring.limitGet() << ", queue size is "
+							   << m_frame_queue_bytes << " bytes)" ),
+				ErrTimeout );
+		}
+	}
+
+	// Admit as many other frames as fit into the frame queue without waiting
+	size_t admitted = 1;
+	while( admitted < count && frame_try_push( frame_info( admitted ) ) )
+		admitted++;
+
+	// The thread, which makes the first frame outstanding, starts the read chain
+	if( m_async_outstanding_results.fetch_add( int( admitted ) ) == 0 )
+	{
+		{
+			std::lock_guard< std::mutex > lock( m_communication_mutex );
+			readInitiate();
+		}
+		receiverStart();
+	}
+	return admitted;
+}
+
+//
+// Replace the oldest frame, which is queued but not yet taken by the writer, by the new frame: the old frame
+// is dropped, and the new frame takes the last place in the ring of outstanding frames.
+// Frame infos of unsent frames are the newest ones in the ring: producer puts frame info into the ring before
+// the frame data is queued or sent, and the writer takes frames from the send queue under the same lock.
+// [in] frame - context of the new frame
+// return true if the frame is replaced, false if there are no unsent frames
+//
+bool ClientAsio::unsentFrameReplace( const FrameContextSource &frame )
+{
+	// when the session is aborted, outstanding frames are dropped by the consumer under the same lock
+	std::lock_guard< std::mutex > lock( m_send_mutex );
+	const size_t unsent = m_send_ring.size();
+	if( unsent == 0 || m_async_error )
+		return false;
+
+	// the new frame data should fit into the space of the dropped one
+	const size_t dropped_size = m_frame_info_ring.back( unsent - 1 )->size;
+	const size_t bytes = m_frame_queue_bytes;
+	if( m_frame_queue_bytes_limit > 0 && bytes > dropped_size &&
+		bytes - dropped_size + frame.size > m_frame_queue_bytes_limit )
+		return false;
+
+	frame_t dropped;
+	if( !m_send_ring.tryPop( dropped ) )
+		return false;
+	m_frame_queue_bytes += frame.size;
+	m_frame_queue_bytes -= dropped_size;
+	droppedFrameNotify( *m_frame_info_ring.back( unsent - 1 ), "Frame is dropped according to frame overflow policy" );
+
+	// shift frame infos of the rest of unsent frames over the dropped one, and put the new one in the last place
+	for( size_t i = unsent - 1; i > 0; i-- )
+		*m_frame_info_ring.back( i ) = std::move( *m_frame_info_ring.back( i - 1 ) );
+	*m_frame_info_ring.back() = frame;
+
+	m_dropped_frames++;
+	return true;
+}
+
+//
+// Drop frames, which are queued but not yet taken by the writer, when their deadlines are passed.
+// Contexts of unsent frames are the newest ones in the ring, so contexts of the rest of unsent frames are moved
+// over the dropped ones keeping the order, and the ring is shortened. When the read chain waits for the result
+// of an unsent frame, the newest expired frame is kept: its result is discarded on arrival.
+//
+void ClientAsio::unsentFramesExpire()
+{
+	size_t kept = 0;
+	{
+		std::lock_guard< std::mutex > lock( m_send_mutex );
+		if( m_async_error )
+			return;
+		const size_t unsent = m_send_ring.size();
+		const auto now = std::chrono::steady_clock::now();
+
+		int expired = 0;
+		for( size_t i = 0; i < unsent; i++ )
+			if( m_frame_info_ring.back( i )->expired( now ) )
+				expired++;
+
+		// results of dropped frames are not expected anymore; results of sent frames are received concurrently
+		int outstanding = m_async_outstanding_results;
+		int dropped;
+		do
+			dropped = std::min( expired, outstanding - 1 );
+		while( dropped > 0 &&
+			   !m_async_outstanding_results.compare_exchange_weak( outstanding, outstanding - dropped ) );
+		if( dropped <= 0 )
+			return;
+
+		// take all unsent frames from the queue, and put back the ones, which are not dropped, in the same order
+		frame_t frame;
+		int left = dropped;
+		for( size_t pos = 0; pos < unsent; pos++ )
+		{
+			m_send_ring.tryPop( frame );
+			FrameContext &context = *m_frame_info_ring.back( unsent - 1 - pos );
+			if( left > 0 && context.expired( now ) )
+			{
+				m_frame_queue_bytes -= context.size;
+				droppedFrameNotify( context, "Frame deadline is passed" );
+				left--;
+				continue;
+			}
+			if( kept != pos )
+				*m_frame_info_ring.back( unsent - 1 - kept ) = std::move( context );
+			m_send_ring.tryPush( std::move( frame ) );
+			kept++;
+		}
+
+		m_frame_info_ring.popBack( size_t( dropped ) );
+		m_expired_frames += size_t( dropped );
+	}
+
+	// the writer may be released while the queue is being refilled: make sure it sends the rest of frames
+	if( kept > 0 )
+		sendStart();
+}
+
+//
+// Wait until the frame being sent by the frame writer or frame slot of another thread is finished.
+// Should be called under submission lock, which is released while waiting. Throws error on timeout.
+// [in] submit_lock - submission lock held by the caller
+//
+void ClientAsio::frameWriterWait( SubmitLock &submit_lock )
+{
+	if( !m_frame_writer_active )
+		return;
+
+	// the thread, which opened the writer, would wait for itself
+	if( m_frame_writer_thread == std::this_thread::get_id() )
+		DG_ERROR(
+			"dataSend: the frame opened by frameWriterOpen() or frameSlotReserve() is not finished",
+			ErrIncorrectAPIUse );
+
+	const auto wait_end = std::chrono::steady_clock::now() + std::chrono::milliseconds( m_inference_timeout_ms );
+	while( m_frame_writer_active && !m_async_error )
+	{
+		const auto now = std::chrono::steady_clock::now();
+		bool finished = false;
+		if( now < wait_end )
+		{
+			submit_lock.unlock();
+			finished = m_frame_info_ring.wait(
+				[ this ] { return !m_frame_writer_active || m_async_error; },
+				std::chrono::duration_cast< std::chrono::milliseconds >( wait_end - now ) );
+			submit_lock.lock();
+		}
+
+		if( !finished )
+			DG_ERROR(
+				DG_FORMAT(
+					"Timeout " << m_inference_timeout_ms << " ms waiting for the end of the frame being sent in chunks "
+							   << "to AI server '" << std::string( m_server_address ) << "'" ),
+				ErrTimeout );
+	}
+}
+
+//
+// Put the frame with completion object into the queue of pending frames instead of waiting for space in the frame
+// queue, so the caller, which may be the thread receiving results, is not blocked. Pending frames are admitted in
+// order by the thread, which frees the space. Should be called under submission lock.
+// [in,out] data - frame data; it is moved into the queue when the frame is pending
+// [in] completion - frame completion object
+// [in] size - total size of frame inputs, bytes
+// [in] deadline - frame deadline; time_point::max() for no deadline
+// return true if the frame is pending, false if it should be admitted as usual
+//
+bool ClientAsio::framePend(
+	frame_t &data,
+	FrameCompletion &completion,
+	size_t size,
+	std::chrono::steady_clock::time_point deadline )
+{
+	// outside of session the frame queue is empty; frames, which are dropped instead of waiting, are not pending
+	if( !m_async_session || m_async_error || m_overflow_policy != FrameOverflowPolicy::Block )
+		return false;
+
+	// frames wait for space in order, and after the frame being sent in chunks
+	if( !m_frame_writer_active && m_pending_frames.empty() &&
+		m_frame_info_ring.size() < m_frame_info_ring.limitGet() &&
+		frameBytesFit( m_frame_queue_bytes, size, m_frame_queue_bytes_limit ) )
+		return false;
+
+	if( deadline != std::chrono::steady_clock::time_point::max() )
+		m_deadline_frames = true;
+	m_pending_frames.push_back( PendingFrame{ std::move( data ), &completion, deadline, size } );
+	m_pending_frames_count = m_pending_frames.size();
+
+	// the consumer may free the space before it sees the new pending frame: re-check the space
+	pendingFramesAdmit();
+	return true;
+}
+
+//
+// Admit as many pending frames as fit into the frame queue, and queue them for sending. Should be called under
+// submission lock. When called by the consumer, the frame it completes is still counted as outstanding,
+// so the read chain is kept by the consumer.
+//
+void ClientAsio::pendingFramesAdmit()
+{
+	static const std::string empty_frame_info;
+	const auto now = std::chrono::steady_clock::now();
+	size_t admitted = 0;
+	while( !m_pending_frames.empty() && !m_async_error && !m_frame_writer_active )
+	{
+		PendingFrame &frame = m_pending_frames.front();
+		if( frame.deadline < now )
+		{
+			m_expired_frames++;
+			m_dropped_completions.emplace_back( frame.completion, "Frame deadline is passed" );
+		}
+		else
+		{
+			if( !bytesReserve( frame.size ) )
+				break;
+			if( !m_frame_info_ring.tryPush(
+					FrameContextSource{ empty_frame_info, frame.deadline, frame.size, frame.completion } ) )
+			{
+				m_frame_queue_bytes -= frame.size;
+				break;
+			}
+
+			// the read chain stops, when all results are received before the frame is admitted
+			if( m_async_outstanding_results.fetch_add( 1 ) == 0 )
+			{
+				{
+					std::lock_guard< std::mutex > lock( m_communication_mutex );
+					readInitiate();
+				}
+				receiverStart();
+			}
+			sendEnqueue( std::move( frame.data ) );
+			admitted++;
+		}
+		m_pending_frames.pop_front();
+	}
+
+	m_pending_frames_count = m_pending_frames.size();
+	if( admitted > 0 )
+		sendStart();
+}
+
+//
+// Schedule notification of completion object of the frame dropped during frame submission: it is notified
+// when submission lock is released, so it may submit new frames without breaking the order of the frames
+// being submitted. Should be called under submission lock.
+// [in] frame - context of the dropped frame
+// [in] reason - description of the reason why the frame is dropped
+//
+void ClientAsio::droppedFrameNotify( const FrameContext &frame, const char *reason )
+{
+	if( frame.completion != nullptr )
+		m_dropped_completions.emplace_back( frame.completion, reason );
+}
+
+//
+// Drop all outstanding and pending frames, which results will never be received since the session is aborted,
+// and notify their completion objects. Should be called only by the consumer of outstanding frames.
+// Frames are taken under the locks serializing frame submission and taking unsent frames, and the notification
+// is done without locks.
+//
+void ClientAsio::framesDrop()
+{
+	std::vector< FrameCompletion * > dropped;
+	{
+		std::lock_guard< std::mutex > submit_lock( m_submit_mutex );
+		std::lock_guard< std::mutex > lock( m_send_mutex );
+		for( FrameContext *frame = m_frame_info_ring.front(); frame != nullptr; frame = m_frame_info_ring.front() )
+		{
+			if( frame->completion != nullptr )
+				dropped.push_back( frame->completion );
+			m_frame_queue_bytes -= frame->size;
+			m_frame_info_ring.pop();
+		}
+
+		// pending frames are not admitted after error
+		for( const auto &frame : m_pending_frames )
+			dropped.push_back( frame.completion );
+		m_pending_frames.clear();
+		m_pending_frames_count = 0;
+	}
+
+	if( dropped.empty() )
+		return;
+	std::string reason = lastError();
+	if( reason.empty() )
+		reason = "Inference session is aborted";
+	for( auto completion : dropped )
+	{
+		try
+		{
+			completion->frameDropped( reason );
+		}
+		catch( ... )
+		{}
+	}
+}
+
+//
+// Start result receiving thread if not started yet, or wake it up (not used with shared I/O engine)
+//
+void ClientAsio::receiverStart()
+{
+	// Shared I/O engine threads or multiplexed connection reader handle all results: no need in own thread
+	if( m_io_engine != nullptr || m_mux != nullptr )
+		return;
+
+	// Start result receiving thread if not started yet
+	if( !m_async_thread.joinable() )
+	{
+		m_async_thread = std::thread( [ this ]() {
+			try
+			{
+				// Loop until stop is requested AND then all outstanding results are received
+				while( !m_async_stop || m_async_outstanding_results > 0 )
+				{
+					// Run ASIO executor until result is received or server disconnects or timeout happens
+					const size_t completed_tasks = main_protocol::run_async( m_io_context, m_inference_timeout_ms );
+					if( completed_tasks == 0 )
+						DG_ERROR(
+							DG_FORMAT(
+								"Timeout " << m_inference_timeout_ms << " ms waiting for response from AI server '"
+										   << main_protocol::endpoint_to_string( m_stream_socket.remote_endpoint() ) ),
+							ErrTimeout );
+
+					// Wait until a restart is signaled
+					{
+						std::unique_lock< std::mutex > lock( m_communication_mutex );
+						m_waiter.wait( lock, [ & ] { return m_async_outstanding_results > 0 || m_async_stop; } );
+					}
+				}
+			}
+			catch( std::exception &e )
+			{
+				// signal abort in case of communication error; no I/O handlers are running in this thread anymore
+				asyncAbort( e.what() );
+				framesDrop();
+			}
+		} );
+	}
+	else
+	{
+		// Signal a restart
+		m_waiter.notify_all();  // notify result receiving thread
+	}
+}
+
+//
+// Put frame into the send queue
+// [in] data - frame data to be moved into the queue
+//
+void ClientAsio::sendEnqueue( frame_t &&data )
+{
+	// The send queue holds only outstanding frames, so it never overflows
+	if( !m_send_ring.tryPush( std::move( data ) ) )
+		DG_ERROR( "dataSend: send queue overflow", ErrOperationFailed );
+}
+
+//
+// Start the writer, if it is idle
+//
+void ClientAsio::sendStart()
+{
+	if( !m_send_in_progress.exchange( true ) )
+		sendPump();
+}
+
+//
+// Wait until the writer sends all queued frames. Chunks of the frame sent by frame writer are sent synchronously
+// by the caller thread after that, so frame order is kept.
+//
+void ClientAsio::sendQueueDrain()
+{
+	auto drained = [ & ]() {
+		return ( !m_send_in_progress && m_send_ring.empty() ) || m_async_error;
+	};
+
+	if( !drained() && !m_send_ring.wait( drained, std::chrono::milliseconds( m_inference_timeout_ms ) ) )
+		DG_ERROR(
+			DG_FORMAT(
+				"Timeout " << m_inference_timeout_ms << " ms waiting for sending frames to AI server '"
+						   << std::string( m_server_address ) << "'" ),
+			ErrTimeout );
+}
+
+//
+// Initiate asynchronous gathered write of all frames in the send queue, or release the writer if the queue is empty.
+// Should be called only by the writer owner: the thread, which switched m_send_in_progress flag to true.
+// Only one write is in progress at a time, so writes never interleave with each other. With shared memory transport
+// frame inputs are copied into shared memory, and only their descriptors are written; frames are taken only while
+// they fit there right away, otherwise the writer waits for results to release the space, and dataReceive()
+// resumes it, so neither producers nor I/O threads block on shared memory.
+//
+void ClientAsio::sendPump()
+{
+	for( ;; )
+	{
+		// Take queued frames; drop them if the session is aborted
+		m_send_batch.clear();
+		m_shm_descriptors.clear();
+		size_t input_count = 0;
+		bool shm_full = false;
+		const size_t shm_releases = m_shm_releases;
+		try
+		{
+			// unsentFrameReplace() may take frames from the queue as well
+			std::lock_guard< std::mutex > lock( m_send_mutex );
+			for( frame_t *frame = m_send_ring.front(); frame != nullptr; frame = m_send_ring.front() )
+			{
+				if( !m_async_error && m_shm != nullptr && !shmFramePut( *frame ) )
+				{
+					shm_full = true;
+					break;
+				}
+				if( !m_async_error )
+				{
+					input_count += frame->size();
+					m_send_batch.push_back( std::move( *frame ) );
+				}
+				m_send_ring.pop();
+			}
+		}
+		catch( std::exception &e )
+		{
+			// the frame does not fit into shared memory at all: it is dropped with the rest of frames
+			asyncAbort( e.what() );
+			continue;
+		}
+
+		if( !m_send_batch.empty() && m_mux != nullptr )
+		{
+			// Multiplexed connection queues the write after writes of other streams
+			m_async_pending_ops++;
+			m_mux->writeFramesAsync(
+				m_mux_stream,
+				m_send_batch.data(),
+				m_send_batch.size(),
+				[ this ]( const asio::error_code &ec ) {
+					dataSent( ec );
+					asyncOpDone();
+				} );
+			return;
+		}
+
+		if( !m_send_batch.empty() )
+		{
+			// Prepare gather list of all inputs of all frames, or of their descriptors in shared memory:
+			// headers storage is not reallocated after this point
+			m_send_bufs.clear();
+			if( m_shm != nullptr )
+			{
+				m_shm_packets.clear();
+				for( const auto &descriptor : m_shm_descriptors )
+					m_shm_packets.emplace_back( &descriptor, sizeof( descriptor ) );
+				m_send_headers.resize( m_shm_packets.size() );
+				main_protocol::frame_buffers_prepare( m_shm_packets, m_send_headers.data(), m_send_bufs );
+			}
+			else
+			{
+				m_send_headers.resize( input_count );
+				uint32_t *headers = m_send_headers.data();
+				for( const auto &f : m_send_batch )
+				{
+					main_protocol::frame_buffers_prepare( f, headers, m_send_bufs );
+					headers += f.size();
+				}
+			}
+
+			m_async_pending_ops++;
+			asio::async_write( m_stream_socket, m_send_bufs, [ this ]( const asio::error_code &ec, size_t ) {
+				dataSent( ec );
+				asyncOpDone();
+			} );
+			return;
+		}
+
+		// Shared memory is full: let the next result resume the writer. Results may release the space before
+		// the writer is marked waiting: then take the writer back and retry, unless the result has resumed it
+		if( shm_full )
+		{
+			m_shm_writer_waiting = true;
+			if( m_shm_releases == shm_releases || !m_shm_writer_waiting.exchange( false ) )
+				return;
+			continue;
+		}
+
+		// Nothing to send: release the writer and notify sendQueueDrain().
+		// Producer may queue a frame after the queue was found empty, but before the writer is released,
+		// so it does not start the writer: check the queue once again
+		m_send_in_progress = false;
+		m_send_ring.notifyAll( false );
+		if( m_send_ring.empty() || m_send_in_progress.exchange( true ) )
+			return;
+	}
+}
+
+//
+// Copy inputs of the frame into shared memory, when they fit there right away, and append their descriptors
+// to m_shm_descriptors
+// [in] frame - frame to copy
+// return true if the frame is copied, false if shared memory is full
+//
+bool ClientAsio::shmFramePut( const frame_t &frame )
+{
+	const size_t first = m_shm_descriptors.size();
+	m_shm_descriptors.resize( first + frame.size() );
+	if( m_shm->framePut( frame, &m_shm_descriptors[ first ], 0, nullptr ) )
+		return true;
+	m_shm_descriptors.resize( first );
+	return false;
+}
+
+//
+// Callback for asynchronous write. Releases sent frames and continues sending frames queued meanwhile.
+//
+void ClientAsio::dataSent( const asio::error_code &ec )
+{
+	DG_TRC_BLOCK( AIClientAsio, dataSent, DGTrace::lvlDetailed );
+
+	m_send_batch.clear();
+
+	// signal abort in case of communication error
+	if( ec )
+		asyncAbort( ec == asio::error::operation_aborted ? "Stream was closed while sending frames" : ec.message() );
+
+	sendPump();
+}
+
+//
+// Initiate asynchronous read of next result packet. Should be called only by the owner of the read chain:
+// either by the thread, which made the first frame outstanding, or by the handler of the previous read
+//
+void ClientAsio::readInitiate()
+{
+	// Multiplexed connection reader receives all results: it passes them to muxReceive()
+	if( m_mux != nullptr )
+		return;
+
+	m_rx_buffer = m_rx_buffer_pool->acquire();
+	m_async_pending_ops++;
+	main_protocol::initiate_packet_read(
+		m_stream_socket,
+		&m_read_size,
+		*m_rx_buffer,
+		[ this ]( const asio::error_code &ec ) {
+			dataReceive( ec );
+			asyncOpDone();
+		} );
+}
+
+//
+// Mark asynchronous I/O operation as handled
+//
+void ClientAsio::asyncOpDone()
+{
+	// fast path: this is not the last pending operation
+	int pending = m_async_pending_ops;
+	while( pending > 1 && !m_async_pending_ops.compare_exchange_weak( pending, pending - 1 ) )
+		;
+	if( pending > 1 )
+		return;
+
+	// this object may be destroyed right after the last pending operation is handled
+	std::lock_guard< std::mutex > lock( m_communication_mutex );
+	m_async_pending_ops--;
+	m_waiter.notify_all();
+}
+
+//
+// Abort asynchronous inference session due to error
+// [in] message - error message to be reported by lastError(); the first error is kept
+//
+void ClientAsio::asyncAbort( const std::string &message )
+{
+	{
+		std::lock_guard< std::mutex > lock( m_communication_mutex );
+		if( m_last_error.empty() )
+			m_last_error = message;
+		m_async_error = true;
+		m_async_outstanding_results = 0;
+		m_async_stop = true;
+		m_waiter.notify_all();  // notify main thread to stop waiting
+	}
+
+	// wake up producers waiting for space in frame queue, in shared memory, or for the writer
+	m_frame_info_ring.notifyAll();
+	m_send_ring.notifyAll();
+	if( m_shm != nullptr )
+		m_shm->wake();
+}
+
+//
+// Callback for asynchronous read. Receives complete result packet or read error.
+// Continues the read chain, if any frames are outstanding.
+//
+void ClientAsio::dataReceive( const asio::error_code &ec )
+{
+	DG_TRC_BLOCK( AIClientAsio, dataReceive, DGTrace::lvlDetailed );
+
+	json result;
+	try
+	{
+		if( ec == asio::error::eof )
+			DG_ERROR( "Connection was closed by AI server", ErrOperationFailed );
+		else if( ec )
+			DG_ERROR( ec.message(), ErrSystem );
+		main_protocol::socket_quick_ack_rearm( m_stream_socket, m_client_options );
+
+		// Parse result; return buffer to the pool as soon as it is parsed
+		result = resultParse( m_rx_buffer->data(), m_rx_buffer->size() );
+		m_rx_buffer.reset();
+	}
+	catch( std::exception &e )
+	{
+		// signal abort in case of communication error
+		m_rx_buffer.reset();
+		asyncAbort( e.what() );
+		framesDrop();
+		return;
+	}
+
+	// The result has released frame inputs in shared memory: resume the writer waiting for the space
+	if( m_shm != nullptr )
+	{
+		m_shm_releases++;
+		if( m_shm_writer_waiting.exchange( false ) )
+			sendPump();
+	}
+
+	// Session may be already aborted (e.g. by timeout): result is not expected
+	const FrameContext *frame = m_frame_info_ring.front();
+	if( m_async_error || frame == nullptr )
+	{
+		{
+			std::lock_guard< std::mutex > lock( m_communication_mutex );
+			m_async_outstanding_results = 0;
+			m_waiter.notify_all();
+		}
+		framesDrop();
+		return;
+	}
+
+	// Check for error: abort the session in case of error
+	const std::string err_msg = DG::JsonHelper::errorCheck( result, "", false );
+	if( !err_msg.empty() )
+		asyncAbort( err_msg );
+
+	// Results received after the frame deadline are discarded, unless they report errors
+	const bool expired = err_msg.empty() && frame->deadline != std::chrono::steady_clock::time_point::max() &&
+						 frame->expired( std::chrono::steady_clock::now() );
+	if( expired )
+		m_expired_frames++;
+
+	// Let the depth controller account the frame; the new depth takes effect for next admissions
+	if( m_depth_controller.frameCompleted( m_frame_info_ring.size() ) )
+		m_frame_info_ring.limitSet( m_depth_controller.depthGet() );
+	m_frame_queue_bytes -= frame->size;
+
+	FrameCompletion *completion = frame->completion;
+	if( completion != nullptr )
+	{
+		// Release the frame before its completion is notified, so the completion may submit the next frame
+		// into the freed space; the frame is still counted as outstanding, so the read chain is kept by this handler
+		m_frame_info_ring.pop();
+		try
+		{
+			if( expired )
+				completion->frameDropped( "Frame deadline is passed" );
+			else
+				completion->resultReady( std::move( result ) );
+		}
+		catch( ... )
+		{}
+	}
+	else
+	{
+		// Invoke user callback: catch all errors; the callback executor either calls it right here,
+		// or hands it over to its own threads, so the slow callback does not delay reception of next results;
+		// the post-processing callback is called before it as a separate stage, which may run concurrently
+		if( !expired )
+		{
+			if( m_callback_executor.isInline() )
+			{
+				try
+				{
+					if( m_result_postprocess != nullptr )
+						m_result_postprocess( result, frame->info );
+					m_async_result_callback( result, frame->info );
+				}
+				catch( ... )
+				{}
+			}
+			else
+			{
+				auto shared_result = std::make_shared< json >( std::move( result ) );
+				m_callback_executor.post(
+					[ this, shared_result, info = frame->info ]() {
+						if( m_result_postprocess != nullptr )
+							m_result_postprocess( *shared_result, info );
+					},
+					[ this, shared_result, info = frame->info ]() {
+						m_async_result_callback( *shared_result, info );
+					} );
+			}
+		}
+
+		// Release the frame only after the inline callback returns, so when there are no outstanding frames,
+		// all inline callbacks are completed; dataEnd() waits for the rest
+		m_frame_info_ring.pop();
+	}
+
+	// Results of other outstanding frames will never be received after error
+	if( !err_msg.empty() )
+	{
+		framesDrop();
+		return;
+	}
+
+	// Admit pending frames into the freed space
+	if( m_pending_frames_count > 0 )
+	{
+		SubmitLock lock( *this );
+		pendingFramesAdmit();
+	}
+
+	// If there are unanswered requests, continue the read chain
+	if( m_async_outstanding_results.fetch_sub( 1 ) > 1 )
+		readInitiate();
+	else
+	{
+		std::lock_guard< std::mutex > lock( m_communication_mutex );
+		m_waiter.notify_all();  // notify dataEnd() and result receiving thread
+	}
+}
+
+//
+// Finalize the sequence of data frames. Should be called when no more data frames are
+// expected to finish asynchronous inference session started by dataSend().
+//
+void ClientAsio::dataEnd()
+{
+	DG_TRC_BLOCK( AIClientAsio, dataEnd, DGTrace::lvlBasic );
+
+	// result of the frame being sent by the frame writer or frame slot would never come
+	if( m_frame_writer_active )
+		DG_ERROR(
+			"dataEnd: the frame opened by frameWriterOpen() or frameSlotReserve() is not finished",
+			ErrIncorrectAPIUse );
+
+	bool mux_timeout = false;
+
+	// set stop flag under lock to serialize with result receiving thread
+	{
+		std::unique_lock< std::mutex > lock( m_communication_mutex );
+		m_async_stop = true;
+
+		// with shared I/O engine or multiplexed connection wait for all outstanding results right here
+		if( m_io_engine != nullptr || m_mux != nullptr )
+		{
+			while( m_async_outstanding_results > 0 && !m_async_error )
+			{
+				const int outstanding = m_async_outstanding_results;
+				if( !m_waiter.wait_for( lock, std::chrono::milliseconds( m_inference_timeout_ms ), [ & ] {
+						return m_async_outstanding_results <= 0 || m_async_error;
+					} ) &&
+					m_async_outstanding_results == outstanding )
+				{
+					// no progress during inference timeout: abort session and cancel pending read and write
+					if( m_last_error.empty() )
+						m_last_error = DG_FORMAT(
+							"Timeout " << m_inference_timeout_ms << " ms waiting for response from AI server '"
+									   << std::string( m_server_address ) << "'" );
+					m_async_error = true;
+					m_async_outstanding_results = 0;
+					if( m_mux != nullptr )
+					{
+						// the write in progress is not cancelled: it is expected to finish, unless the connection fails
+						m_mux->writeCancel( m_mux_stream );
+						mux_timeout = true;
+					}
+					else
+					{
+						asio::error_code ec;
+						m_stream_socket.cancel( ec );
+					}
+				}
+			}
+
+			// wait for completion handlers of cancelled operations and for the last result callback,
+			// which may still run in engine thread
+			m_waiter.wait( lock, [ & ] { return m_async_pending_ops == 0; } );
+		}
+	}
+	m_waiter.notify_all();  // notify result receiving thread
+
+	// join result receiving thread
+	if( m_async_thread.joinable() )
+		m_async_thread.join();
+
+	if( m_mux != nullptr )
+	{
+		// results still may be passed by multiplexed connection reader: wait until it leaves the handler;
+		// late results of aborted session are not expected by the server-side stream anymore, so close it
+		m_async_session = false;
+		m_mux->dispatchSync();
+		if( mux_timeout )
+			closeStream();
+	}
+
+	// finish the session: drop frames, which results will never be received due to abort;
+	// no I/O handlers are running at this point
+	framesDrop();
+	m_send_ring.clear();
+	m_frame_queue_bytes = 0;
+
+	// the writer may wait for space in shared memory, which results of dropped frames never release
+	if( m_shm_writer_waiting.exchange( false ) )
+		m_send_in_progress = false;
+	if( m_shm != nullptr )
+		m_shm->reset();
+	m_async_session = false;
+
+	// wait for callbacks handed over to callback executor threads
+	m_callback_executor.drain();
 }
 
 /// Transmit command JSON packet to server, receive response, parse it, and analyze for errors
@@ -484,21 +2153,23 @@ bool ClientAsio::transmitCommand( const std::string &source, const json &request
 
 	// Read reply message
 	main_protocol::read( m_command_socket, response_buffer );
+	main_protocol::socket_quick_ack_rearm( m_command_socket, m_client_options );
 
 	response = json::parse( response_buffer );
 	if( !response.is_object() )
 		DG_ERROR(
 			DG_FORMAT(
-				"Response from server '" << m_command_socket.remote_endpoint().address().to_string() << ":"
-										 << m_command_socket.remote_endpoint().port() << "' is incorrect." ),
+				"Response from server '" << main_protocol::endpoint_to_string( m_command_socket.remote_endpoint() )
+										 << "' is incorrect." ),
 			ErrNotSupportedVersion );
 	if( !response.contains( DG::PROTOCOL_VERSION_TAG ) )
 		DG_ERROR(
 			DG_FORMAT(
 				"AI server protocol version data is missing in response from server '"
-				<< m_command_socket.remote_endpoint().address().to_string() << ":"
-				<< m_command_socket.remote_endpoint().port() << "'. Please upgrade AI server instance to newer one." ),
+				<< main_protocol::endpoint_to_string( m_command_socket.remote_endpoint() )
+				<< "'. Please upgrade AI server instance to newer one." ),
 			ErrNotSupportedVersion );
+	m_server_protocol_version = response[ DG::PROTOCOL_VERSION_TAG ].get< int >();
 
 	DG::JsonHelper::errorCheck( response, source );
 	return true;
@@ -12,8 +12,14 @@
 #ifndef DG_CLIENT_ASIO_H_
 #define DG_CLIENT_ASIO_H_
 
-#include <queue>
+#include <deque>
+#include "Utilities/dg_buffer_pool.h"
+#include "Utilities/dg_callback_executor.h"
+#include "Utilities/dg_frame_ring.h"
+#include "Utilities/dg_queue_depth_controller.h"
 #include "dg_client.h"
+#include "dg_client_mux.h"
+#include "dg_client_shm.h"
 #include "dg_socket.h"
 
 namespace DG
@@ -28,10 +34,12 @@ public:
 	/// \param[in] server_address - server address
 	/// \param[in] connection_timeout_ms - connection timeout in milliseconds
 	/// \param[in] inference_timeout_ms - AI server inference timeout in milliseconds
+	/// \param[in] client_options - client transport options
 	ClientAsio(
 		const ServerAddress &server_address,
 		size_t connection_timeout_ms = DEFAULT_CONNECTION_TIMEOUT_MS,
-		size_t inference_timeout_ms = DEFAULT_INFERENCE_TIMEOUT_MS );
+		size_t inference_timeout_ms = DEFAULT_INFERENCE_TIMEOUT_MS,
+		const ClientOptions &client_options = ClientOptions() );
 
 	ClientAsio( const Client &s ) = delete;
 	ClientAsio &operator=( const ClientAsio & ) = delete;
@@ -89,10 +97,12 @@ public:
 	// Synchronous prediction API
 	//
 
+	using Client::predict;
+
 	/// Run prediction on given data frame. Stream should be opened by openStream()
-	/// \param[in] data - array containing frame data
+	/// \param[in] data - array of views of frame data: one view per model input
 	/// \param[out] output - prediction result (JSON array)
-	void predict( std::vector< std::vector< char > > &data, json &output ) override;
+	void predict( const std::vector< ByteView > &data, json &output ) override;
 
 	//
 	// Asynchronous prediction API
@@ -103,18 +113,113 @@ public:
 	/// dataSend() methods
 	void resultObserve( callback_t callback ) override;
 
+	using Client::dataSend;
+
 	/// Send given data frame for prediction. Prerequisites:
 	///   stream should be opened by openStream();
 	///   user callback to receive prediction results should be installed by resultObserve().
-	/// On the very first frame the method launches result receiving thread. This thread asynchronously
-	/// retrieves prediction results and for each result calls user callback installed by resultObserve().
-	/// To terminate this thread dataEnd() should be called when no more data frames are expected.
-	/// \param[in] data - array containing frame data
+	/// On the very first frame the method starts asynchronous inference session: when shared I/O engine is not
+	/// used, it launches result receiving thread. Results are retrieved asynchronously and for each result
+	/// the user callback installed by resultObserve() is called.
+	/// To finish the session dataEnd() should be called when no more data frames are expected.
+	/// The frame is written synchronously by the caller thread, when no other frames are being sent; otherwise
+	/// frame data is copied into the send queue.
+	/// \param[in] data - array of views of frame data: one view per model input
+	/// \param[in] frame_info - optional frame information string to be passed to the callback along the frame result
+	/// \param[in] deadline_ms - optional frame deadline in milliseconds; 0 for no deadline
+	void dataSend(
+		const std::vector< ByteView > &data,
+		const std::string &frame_info = "",
+		size_t deadline_ms = 0 ) override;
+
+	/// Send given data frame for prediction, taking ownership of frame data.
+	/// The frame is put into the send queue and the method returns immediately: the frame is sent to the server
+	/// asynchronously by the writer, so the caller is not blocked by the network. The number of frames queued
+	/// for sending and frames waiting for results is limited by frame queue depth. No data copy is made.
+	/// See dataSend() overload accepting byte views for other details.
+	/// \param[in] data - vector of input data for each model input where each data element is a vector of bytes
+	/// \param[in] frame_info - optional frame information string to be passed to the callback along the frame result
+	/// \param[in] deadline_ms - optional frame deadline in milliseconds; 0 for no deadline
+	void dataSend(
+		std::vector< std::vector< char > > &&data,
+		const std::string &frame_info = "",
+		size_t deadline_ms = 0 ) override;
+
+	/// Send given data frame for prediction taking ownership of frame data, and deliver the frame result to given
+	/// completion object. The frame is queued for sending the same way as by dataSend() overload accepting
+	/// frame information string. See Client::dataSend() overload accepting completion object for other details.
+	/// \param[in] data - vector of input data for each model input where each data element is a vector of bytes
+	/// \param[in] completion - completion object to be notified when the frame result is ready or the frame
+	/// is dropped
+	/// \param[in] deadline_ms - optional frame deadline in milliseconds; 0 for no deadline
+	void dataSend(
+		std::vector< std::vector< char > > &&data,
+		FrameCompletion &completion,
+		size_t deadline_ms = 0 ) override;
+
+	/// Try to send given data frame for prediction without waiting, and deliver the frame result to given
+	/// completion object. See Client::dataTrySend() for details.
+	/// \param[in] data - array containing frame data; it is moved into the client only when the frame is accepted
+	/// \param[in] completion - completion object to be notified when the frame result is ready or the frame
+	/// is dropped
+	/// \param[in] deadline_ms - optional frame deadline in milliseconds; 0 for no deadline
+	/// \return true if the frame is accepted, false if the frame queue is full
+	bool dataTrySend(
+		std::vector< std::vector< char > > &&data,
+		FrameCompletion &completion,
+		size_t deadline_ms = 0 ) override;
+
+	/// Send given batch of data frames for prediction. Frame queue space is reserved for as many frames of the batch
+	/// as possible under single lock, and all admitted frames are written by single gathered write, or copied into
+	/// the send queue, when other frames are being sent.
+	/// See dataSend() overload accepting byte views for other details.
+	/// \param[in] frames - array of frames; each frame is array of views of frame data: one view per model input
+	/// \param[in] frame_infos - frame information strings, one per frame, to be passed to the callback along
+	/// the frame results; may be empty to pass empty strings for all frames
+	/// \param[in] deadline_ms - optional deadline of each frame in milliseconds; 0 for no deadline
+	void dataSendBatch(
+		const std::vector< std::vector< ByteView > > &frames,
+		const std::vector< std::string > &frame_infos = {},
+		size_t deadline_ms = 0 ) override;
+
+	/// Send given batch of data frames for prediction taking ownership of frames data.
+	/// Frames are put into the send queue as they are admitted into the frame queue, and sent asynchronously.
+	/// See dataSendBatch() overload accepting byte views for other details.
+	/// \param[in] frames - array of frames; each frame is array containing frame data; it is moved into the client
+	/// \param[in] frame_infos - frame information strings, one per frame, to be passed to the callback along
+	/// the frame results; may be empty to pass empty strings for all frames
+	/// \param[in] deadline_ms - optional deadline of each frame in milliseconds; 0 for no deadline
+	void dataSendBatch(
+		std::vector< std::vector< std::vector< char > > > &&frames,
+		const std::vector< std::string > &frame_infos = {},
+		size_t deadline_ms = 0 ) override;
+
+	/// Open writer, which sends the data of a single frame for prediction in chunks as the data becomes available.
+	/// Chunks are written synchronously by the caller thread, so the memory of each chunk can be reused as soon as
+	/// FrameWriter::write() returns. Requires AI server supporting CHUNKED_MIN_PROTOCOL_VERSION.
+	/// See Client::frameWriterOpen() for other details.
 	/// \param[in] frame_info - optional frame information string to be passed to the callback along the frame result
-	void dataSend( const std::vector< std::vector< char > > &data, const std::string &frame_info = "" ) override;
+	/// \param[in] deadline_ms - optional frame deadline in milliseconds since the writer is opened; 0 for no deadline
+	/// \return frame writer object
+	std::unique_ptr< FrameWriter >
+	frameWriterOpen( const std::string &frame_info = "", size_t deadline_ms = 0 ) override;
+
+	/// Reserve the space for the data of a single frame to be filled in place by the caller. With shared memory
+	/// transport the space is reserved in the input ring of the shared memory segment, so frame data is not copied,
+	/// and only input descriptors are sent on commit. Frames sent by other threads wait until the slot is committed
+	/// or destroyed, and the thread, which reserved the slot, cannot send other frames until then. Otherwise the
+	/// frame is sent as by Client::frameSlotReserve(). See Client::frameSlotReserve() for other details.
+	/// \param[in] input_sizes - sizes of frame inputs in bytes: one size per model input
+	/// \param[in] frame_info - optional frame information string to be passed to the callback along the frame result
+	/// \param[in] deadline_ms - optional frame deadline in milliseconds since the slot is reserved; 0 for no deadline
+	/// \return frame slot object
+	std::unique_ptr< FrameSlot > frameSlotReserve(
+		const std::vector< size_t > &input_sizes,
+		const std::string &frame_info = "",
+		size_t deadline_ms = 0 ) override;
 
 	/// Finalize the sequence of data frames. Should be called when no more data frames are
-	/// expected to terminate result receiving thread started by dataSend().
+	/// expected to finish asynchronous inference session started by dataSend().
 	/// NOTE: will wait until all outstanding results are received
 	void dataEnd() override;
 
@@ -124,6 +229,55 @@ public:
 		return m_async_outstanding_results;
 	}
 
+	/// Set the range of adaptive frame queue depth. See Client::frameQueueDepthRangeSet() for details.
+	/// \param[in] min_depth - lower bound of frame queue depth
+	/// \param[in] max_depth - upper bound of frame queue depth
+	void frameQueueDepthRangeSet( size_t min_depth, size_t max_depth ) override;
+
+	/// Get frame queue depth status
+	FrameQueueDepthStatus frameQueueDepthStatusGet() override
+	{
+		FrameQueueDepthStatus status = m_depth_controller.statusGet();
+		status.bytes = m_frame_queue_bytes;
+		status.bytes_limit = m_frame_queue_bytes_limit;
+		return status;
+	}
+
+	/// Set the limit of the total size of data of outstanding frames.
+	/// See Client::frameQueueBytesLimitSet() for details.
+	/// \param[in] max_bytes - limit of the total size of data of outstanding frames in bytes; 0 for no limit
+	void frameQueueBytesLimitSet( size_t max_bytes ) override;
+
+	/// Set the policy of handling frames sent by dataSend() methods when the frame queue is full.
+	/// See Client::frameOverflowPolicySet() for details.
+	/// \param[in] policy - frame overflow policy
+	void frameOverflowPolicySet( FrameOverflowPolicy policy ) override
+	{
+		m_overflow_policy = policy;
+	}
+
+	/// Get # of frames dropped according to frame overflow policy since the client is created
+	size_t droppedFramesCountGet() override
+	{
+		return m_dropped_frames;
+	}
+
+	/// Get # of frames dropped or discarded due to passed deadlines since the client is created
+	size_t expiredFramesCountGet() override
+	{
+		return m_expired_frames;
+	}
+
+	/// Set which threads call the user callback. See Client::callbackExecutionSet() for details.
+	/// \param[in] mode - callback execution mode
+	/// \param[in] thread_count - number of threads for CallbackExecution::Pool mode; 0 for the number of CPU cores
+	/// \param[in] ordered - call the user callback in the order of frames in CallbackExecution::Pool mode
+	/// \param[in] postprocess - optional callback, which post-processes each result before the user callback
+	void callbackExecutionSet( CallbackExecution mode,
+		size_t thread_count,
+		bool ordered = false,
+		postprocess_t postprocess = nullptr ) override;
+
 	/// If ever during consecutive calls to predict() methods server reported run-time error, then
 	/// this method will return error message string, otherwise it returns empty string.
 	std::string lastError() override
@@ -144,33 +298,273 @@ private:
 	/// \param[in] request - request string
 	void transmitCommand( const std::string &source, const std::string &request );
 
-	//
-	// Callback for asynchronous read. Receives incoming message size and completes read. Schedules next read, if any
-	// are outstanding.
-	//
-	void dataReceive();
+	/// Writer of frame sent in chunks
+	class ChunkedWriter;
+
+	/// Frame slot located in shared memory segment
+	class SharedMemorySlot;
+
+	/// Let other frames be sent after the frame opened by frameWriterOpen() or frameSlotReserve() is finished
+	void frameWriterRelease();
+
+	/// Send next chunk of the frame opened by frameWriterOpen(), synchronously
+	/// \param[in] data - chunk data
+	/// \param[in] size - size of chunk data, in bytes
+	/// \param[in] last - true for the last chunk of frame input
+	void chunkSend( const char *data, size_t size, bool last );
+
+	/// Send chunk abort marker to drop partially sent frame on the server side.
+	/// The server replies to the dropped frame with error result; when the marker cannot be sent, the session
+	/// is aborted.
+	void chunkAbortSend();
+
+	/// Frame data type owned by the send queue
+	using frame_t = std::vector< std::vector< char > >;
+
+	/// Lock, which serializes frame submission by concurrent producers
+	class SubmitLock;
+
+	/// Completion object of the frame dropped during submission, and the reason why the frame is dropped
+	using dropped_frame_t = std::pair< FrameCompletion *, const char * >;
+
+	/// Frame with completion object waiting for space in the frame queue
+	struct PendingFrame
+	{
+		frame_t data;                                    //!< frame data
+		FrameCompletion *completion;                     //!< frame completion object
+		std::chrono::steady_clock::time_point deadline;  //!< time after which the frame result is useless
+		size_t size;                                     //!< total size of frame inputs, bytes
+	};
+
+	/// Admit next frames into asynchronous inference session: start session if not started, wait for space in
+	/// the ring of outstanding frames and for space for frame data, and put as many frames as fit there.
+	/// Should be called under submission lock, which is released while waiting.
+	/// \param[in] submit_lock - submission lock held by the caller
+	/// \param[in] frame_infos - pointer to the array of frame information strings to be passed to the callback
+	/// along the frame results; nullptr to use empty strings
+	/// \param[in] frame_sizes - pointer to the array of frame sizes in bytes; nullptr when sizes are not known
+	/// \param[in] count - number of frames to admit
+	/// \param[in] deadline - deadline of all frames to admit; time_point::max() for no deadline
+	/// \param[in] completion - completion object of the single frame to admit (or nullptr to use callback)
+	/// \param[in] no_wait - true to admit frames only when they fit right away: frames, which do not fit,
+	/// are neither waited for nor dropped according to frame overflow policy
+	/// \return number of admitted frames, from 1 to count; 0 if the session is aborted due to error,
+	/// or the frame queue is full and all frames are dropped according to frame overflow policy
+	/// (or not admitted in no-wait mode), and frames should not be sent
+	size_t framesAdmit(
+		SubmitLock &submit_lock,
+		const std::string *frame_infos,
+		const size_t *frame_sizes,
+		size_t count,
+		std::chrono::steady_clock::time_point deadline,
+		FrameCompletion *completion = nullptr,
+		bool no_wait = false );
+
+	/// Wait until the frame being sent by the frame writer or frame slot of another thread is finished.
+	/// Should be called under submission lock, which is released while waiting. Throws error on timeout.
+	/// \param[in] submit_lock - submission lock held by the caller
+	void frameWriterWait( SubmitLock &submit_lock );
+
+	/// Reserve the space for frame data in the frame queue. See Client::frameBytesReserve() for details.
+	/// \param[in] size - frame size, bytes
+	/// \return true if the space is reserved
+	bool bytesReserve( size_t size )
+	{
+		return frameBytesReserve( m_frame_queue_bytes, size, m_frame_queue_bytes_limit );
+	}
+
+	/// Replace the oldest frame, which is queued but not yet taken by the writer, by the new frame: the old frame
+	/// is dropped, and the new frame takes the last place in the ring of outstanding frames. The data of the new
+	/// frame should be either put into the send queue or sent after the queue is drained, as for admitted frames.
+	/// \param[in] frame - context of the new frame
+	/// \return true if the frame is replaced, false if there are no unsent frames
+	bool unsentFrameReplace( const FrameContextSource &frame );
+
+	/// Drop frames, which are queued but not yet taken by the writer, when their deadlines are passed
+	void unsentFramesExpire();
+
+	/// Put the frame with completion object into the queue of pending frames instead of waiting for space in the frame
+	/// queue, so the caller, which may be the thread receiving results, is not blocked. Should be called under
+	/// submission lock.
+	/// \param[in,out] data - frame data; it is moved into the queue when the frame is pending
+	/// \param[in] completion - frame completion object
+	/// \param[in] size - total size of frame inputs, bytes
+	/// \param[in] deadline - frame deadline; time_point::max() for no deadline
+	/// \return true if the frame is pending, false if it should be admitted as usual
+	bool framePend(
+		frame_t &data,
+		FrameCompletion &completion,
+		size_t size,
+		std::chrono::steady_clock::time_point deadline );
+
+	/// Admit as many pending frames as fit into the frame queue, and queue them for sending.
+	/// Should be called under submission lock.
+	void pendingFramesAdmit();
+
+	/// Schedule notification of completion object of the frame dropped during frame submission: it is notified
+	/// when submission lock is released. Should be called under submission lock.
+	/// \param[in] frame - context of the dropped frame
+	/// \param[in] reason - description of the reason why the frame is dropped
+	void droppedFrameNotify( const FrameContext &frame, const char *reason );
+
+	/// Drop all outstanding frames, which results will never be received since the session is aborted,
+	/// and notify their completion objects. Should be called only by the consumer of outstanding frames:
+	/// by the owner of the read chain, or when no I/O handlers are running.
+	void framesDrop();
+
+	/// Reallocate frame queues for the maximum depth allowed by the depth controller and apply its current depth.
+	/// Should be called when no frames are outstanding.
+	void frameQueuesReset();
+
+	/// Start result receiving thread if not started yet, or wake it up (not used with shared I/O engine)
+	void receiverStart();
+
+	/// Put frame into the send queue
+	/// \param[in] data - frame data to be moved into the queue
+	void sendEnqueue( frame_t &&data );
+
+	/// Start the writer, if it is idle
+	void sendStart();
+
+	/// Send admitted frames, which data is owned by the caller: when the writer is idle, write them synchronously
+	/// without holding submission lock, otherwise copy them into the send queue. Frames sent over multiplexed
+	/// connection are always copied into the send queue. Should be called under submission lock right after
+	/// the frames are admitted.
+	/// \param[in] submit_lock - submission lock held by the caller
+	/// \param[in] frames - pointer to the array of frames; each frame is array of views of frame data
+	/// \param[in] frame_count - number of frames to send
+	void viewFramesSend( SubmitLock &submit_lock, const std::vector< ByteView > *frames, size_t frame_count );
+
+	/// Wait until the writer sends all queued frames
+	void sendQueueDrain();
+
+	/// Initiate asynchronous gathered write of all frames in the send queue, or release the writer if the queue
+	/// is empty. With shared memory transport frames are taken only while they fit into shared memory right away;
+	/// otherwise the writer waits for results to release the space, and dataReceive() resumes it.
+	/// Should be called only by the writer owner: the thread, which switched m_send_in_progress to true
+	void sendPump();
+
+	/// Copy inputs of the frame into shared memory, when they fit there right away, and append their descriptors
+	/// to m_shm_descriptors
+	/// \param[in] frame - frame to copy
+	/// \return true if the frame is copied, false if shared memory is full
+	bool shmFramePut( const frame_t &frame );
+
+	/// Callback for asynchronous write. Releases sent frames and continues sending frames queued meanwhile.
+	void dataSent( const asio::error_code &ec );
+
+	/// Initiate asynchronous read of next result packet. Should be called only by the owner of the read chain:
+	/// either by the thread, which made the first frame outstanding, or by the handler of the previous read
+	void readInitiate();
+
+	/// Callback for asynchronous read. Receives complete result packet or read error.
+	/// Continues the read chain, if any frames are outstanding.
+	void dataReceive( const asio::error_code &ec );
+
+	/// Mark asynchronous I/O operation as handled
+	void asyncOpDone();
+
+	/// Abort asynchronous inference session due to error
+	/// \param[in] message - error message to be reported by lastError(); the first error is kept
+	void asyncAbort( const std::string &message );
+
+	/// Check if stream is opened by openStream(): either dedicated stream socket is connected,
+	/// or logical stream is opened on multiplexed connection
+	bool streamIsOpen() const
+	{
+		return m_mux != nullptr || m_stream_socket.is_open();
+	}
+
+	/// Write frames to the stream, synchronously
+	/// \param[in] frames - pointer to the array of frames; each frame is an array of frame inputs
+	/// \param[in] frame_count - number of frames to write
+	template< typename Container >
+	void streamWrite( const std::vector< Container > *frames, size_t frame_count );
+
+	/// Parse result packet received from the stream. With shared memory transport the packet is the descriptor
+	/// of the result kept in shared memory.
+	/// \param[in] packet - result packet data
+	/// \param[in] size - result packet size, bytes
+	/// \return parsed result
+	json resultParse( const uint8_t *packet, size_t size );
+
+	/// Handler of results received for this client stream on multiplexed connection
+	/// \param[in] ec - connection error code
+	/// \param[in] buffer - received result packet
+	void muxReceive( const asio::error_code &ec, BufferPool::handle_t &&buffer );
+
+	/// Get I/O context, which drives stream socket: either shared engine context or own context
+	main_protocol::io_context_t &streamContext()
+	{
+		return m_io_engine != nullptr ? m_io_engine->context() : m_io_context;
+	}
 
 	/// Close stream opened by openStream()
 	void closeStream();
 
-	main_protocol::io_context_t m_io_context;  //!< ASIO context
-	main_protocol::socket_t m_stream_socket;   //!< socket object for streaming operation
-	main_protocol::socket_t m_command_socket;  //!< socket object for sending commands
-	DG::ServerAddress m_server_address;        //!< address of active server
+	main_protocol::io_context_t m_io_context;                //!< ASIO context
+	std::shared_ptr< main_protocol::IoEngine > m_io_engine;  //!< shared I/O engine (or nullptr to use own context)
+	main_protocol::socket_t m_stream_socket;                 //!< socket object for streaming operation
+	main_protocol::socket_t m_command_socket;                //!< socket object for sending commands
+	DG::ServerAddress m_server_address;                      //!< address of active server
 
 	// asynchronous prediction support
-	std::thread m_async_thread;                    //!< result receiving thread
-	callback_t m_async_result_callback;            //!< asynchronous inference result callback
-	std::atomic_int m_async_outstanding_results;   //!< # of outstanding inference results scheduled so far
-	std::condition_variable m_waiter;              //!< condition variable for result receiving thread synchronization
-	std::atomic_bool m_async_stop;                 //!< stop request for receiving thread
-	std::mutex m_communication_mutex;              //!< mutex to protect the above
-	uint32_t m_read_size;                          //!< size of received response
-	size_t m_frame_queue_depth;                    //!< depth of frame queue
-	std::queue< std::string > m_frame_info_queue;  //!< frame info queue
-	std::string m_last_error;                      //!< last prediction error (or empty)
-	size_t m_connection_timeout_ms;                //!< socket connection timeout, in milliseconds
-	size_t m_inference_timeout_ms;                 //!< AI server inference timeout, in milliseconds
+	std::thread m_async_thread;                      //!< result receiving thread (not used with shared I/O engine)
+	std::atomic_bool m_async_session;                //!< asynchronous inference session is started by dataSend()
+	std::atomic_int m_async_pending_ops;             //!< # of initiated async. I/O operations not yet handled
+	callback_t m_async_result_callback;              //!< asynchronous inference result callback
+	postprocess_t m_result_postprocess;              //!< result post-processing callback
+	CallbackExecutor m_callback_executor;            //!< executor of m_async_result_callback calls
+	std::atomic_int m_async_outstanding_results;     //!< # of outstanding inference results scheduled so far
+	std::condition_variable m_waiter;                //!< condition variable for result receiving thread synchronization
+	std::atomic_bool m_async_stop;                   //!< stop request for receiving thread
+	std::atomic_bool m_async_error;                  //!< asynchronous inference session is aborted due to error
+	std::mutex m_communication_mutex;                //!< mutex to protect the above
+	uint32_t m_read_size;                            //!< size of received response
+	size_t m_frame_queue_depth;                      //!< depth of frame queue
+	FrameRing< FrameContext > m_frame_info_ring;     //!< contexts of outstanding frames
+	QueueDepthController m_depth_controller;         //!< frame queue depth controller
+	std::string m_last_error;                        //!< last prediction error (or empty)
+	std::shared_ptr< BufferPool > m_rx_buffer_pool;  //!< pool of reusable buffers for received results
+	BufferPool::handle_t m_rx_buffer;                //!< buffer for result being received
+	FrameRing< frame_t > m_send_ring;                //!< frames waiting to be sent by the writer
+	std::mutex m_send_mutex;                         //!< mutex to serialize taking frames from m_send_ring
+	std::vector< frame_t > m_send_batch;             //!< frames being sent by the write in progress
+	std::vector< uint32_t > m_send_headers;          //!< input size headers of frames being sent
+	std::vector< asio::const_buffer > m_send_bufs;   //!< gather list of the write in progress
+	std::atomic_bool m_send_in_progress;             //!< the writer is active
+	std::shared_ptr< MuxConnection > m_mux;          //!< multiplexed connection (or nullptr to use stream socket)
+	uint32_t m_mux_stream;                           //!< stream ID on multiplexed connection
+	BufferPool::handle_t m_mux_result;               //!< result of synchronous prediction on multiplexed connection
+	asio::error_code m_mux_error;                    //!< connection error received instead of m_mux_result
+	bool m_mux_result_ready;                         //!< m_mux_result or m_mux_error is received
+	size_t m_connection_timeout_ms;                  //!< socket connection timeout, in milliseconds
+	size_t m_inference_timeout_ms;                   //!< AI server inference timeout, in milliseconds
+	ClientOptions m_client_options;                  //!< client transport options
+	int m_server_protocol_version;                   //!< server protocol version (0 until the first command)
+	std::atomic_bool m_frame_writer_active;          //!< frame writer or frame slot is not finished
+	std::unique_ptr< SharedMemoryChannel > m_shm;    //!< shared memory channel (or nullptr to pass frames in packets)
+
+	// writer of shared memory transport
+	std::vector< SharedMemoryChannel::Descriptor > m_shm_descriptors;  //!< input descriptors of frames being sent
+	std::vector< ByteView > m_shm_packets;                             //!< packets of m_shm_descriptors being sent
+	std::atomic_bool m_shm_writer_waiting;                             //!< the writer waits for space in shared memory
+	std::atomic_size_t m_shm_releases;                                 //!< # of results released space in shared memory
+
+	// frame admission control
+	std::atomic< FrameOverflowPolicy > m_overflow_policy;  //!< policy of handling frames when frame queue is full
+	std::atomic_size_t m_dropped_frames;                   //!< # of frames dropped according to m_overflow_policy
+	std::atomic_bool m_deadline_frames;                    //!< frames with deadlines are admitted in the session
+	std::atomic_size_t m_expired_frames;                   //!< # of frames dropped or discarded due to deadlines
+	std::atomic_size_t m_frame_queue_bytes;                //!< total size of data of outstanding frames, bytes
+	size_t m_frame_queue_bytes_limit;                      //!< limit of m_frame_queue_bytes (or 0 for no limit)
+
+	// frame submission by concurrent producers
+	std::mutex m_submit_mutex;                            //!< mutex to serialize frame submission
+	std::vector< dropped_frame_t > m_dropped_completions;  //!< frames dropped during submission, to be notified
+	std::deque< PendingFrame > m_pending_frames;           //!< frames waiting for space in the frame queue
+	std::atomic_size_t m_pending_frames_count;             //!< size of m_pending_frames: can be checked without lock
+	std::thread::id m_frame_writer_thread;                 //!< thread, which opened the active frame writer
 };
 }  // namespace DG
 
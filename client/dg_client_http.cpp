@@ -32,8 +32,9 @@ public:
 
 	/// Constructor
 	/// \param[in] url WebSocket URL
-	WebSocketClient( const std::string &url ) :
-		m_url( url ), m_ews_client( easywsclient::WebSocket::from_url_no_mask( url ) )
+	/// \param[in] socket_setup socket setup callback called before the socket is connected
+	WebSocketClient( const std::string &url, const easywsclient::WebSocket::socket_setup_t &socket_setup = nullptr ) :
+		m_url( url ), m_ews_client( easywsclient::WebSocket::from_url_no_mask( url, std::string(), socket_setup ) )
 	{}
 
 	/// Destructor
@@ -81,12 +82,12 @@ public:
 	}
 
 	/// Send binary message
-	/// \param[in] data - binary data to send
-	void binarySend( const std::vector< char > &data )
+	/// \param[in] data - view of binary data to send
+	void binarySend( const ByteView &data )
 	{
 		DG_TRC_BLOCK( AIClientHttp, binarySend, DGTrace::lvlDetailed );
 		std::lock_guard< std::mutex > lk( m_mx );
-		m_ews_client->sendBinary( data );  // buffer data
+		m_ews_client->sendBinary( data.data(), data.size() );  // buffer data
 		m_ews_client->poll( 0 );           // send immediately
 	}
 
@@ -183,15 +184,19 @@ private:
 // [in] server_address - server address
 // [in] connection_timeout_ms - connection timeout in milliseconds
 // [in] inference_timeout_ms - AI server inference timeout in milliseconds
+// [in] client_options - client transport options
 //
 ClientHttp::ClientHttp(
 	const ServerAddress &server_address,
 	size_t connection_timeout_ms,
-	size_t inference_timeout_ms ) :
+	size_t inference_timeout_ms,
+	const ClientOptions &client_options ) :
 	m_server_address( server_address ),
 	m_connection_timeout_ms( connection_timeout_ms ), m_inference_timeout_ms( inference_timeout_ms ),
+	m_client_options( client_options ),
 	m_ws_client( nullptr ), m_async_result_callback( nullptr ), m_frame_queue_depth( 0 ),
-	m_http_client( server_address )
+	m_http_client( server_address ), m_overflow_policy( FrameOverflowPolicy::Block ), m_dropped_frames( 0 ),
+	m_expired_frames( 0 ), m_frame_queue_bytes( 0 ), m_frame_queue_bytes_limit( 0 ), m_pending_frames_count( 0 )
 {
 	DG_TRC_BLOCK( AIClientHttp, constructor, DGTrace::lvlBasic );
 
@@ -200,6 +205,55 @@ ClientHttp::ClientHttp(
 	m_http_client.set_connection_timeout( std::chrono::milliseconds( m_connection_timeout_ms ) );
 	m_http_client.set_read_timeout( std::chrono::milliseconds( m_connection_timeout_ms ) );
 	m_http_client.set_write_timeout( std::chrono::milliseconds( m_connection_timeout_ms ) );
+	m_http_client.set_tcp_nodelay( m_client_options.tcp_no_delay );
+	m_http_client.set_socket_options( [ this ]( httplib::socket_t sock ) { socketSetup( sock ); } );
+}
+
+//
+// Apply client transport options to the socket before it is connected.
+// HTTP and WebSocket clients provide no way to fail the connection from socket setup, so each option, which
+// cannot be set, is reported as a warning: the connection proceeds with system default for that option.
+// [in] sock - native socket handle
+//
+void ClientHttp::socketSetup( std::uintptr_t sock )
+{
+	const auto failures = main_protocol::socket_options_apply(
+		static_cast< main_protocol::socket_t::native_handle_type >( sock ),
+		m_client_options );
+	for( const auto &failure : failures )
+		DG_WARNING(
+			DG_FORMAT(
+				"Cannot set socket option " << failure.name << " for connection to " << std::string( m_server_address )
+											<< ": " << failure.error.message() ),
+			ErrSystem );
+}
+
+//
+// Resolve server host name using process-wide resolver cache
+// return server IP address string
+//
+std::string ClientHttp::hostResolve()
+{
+	DG_TRC_BLOCK( AIClientHttp, hostResolve, DGTrace::lvlDetailed );
+	return main_protocol::Resolver::instance()
+		.resolve( m_server_address.ip, m_server_address.port, m_connection_timeout_ms )
+		.front()
+		.address()
+		.to_string();
+}
+
+//
+// Point HTTP client to the server address taken from resolver cache before each request: HTTP client would resolve
+// host name again on each reconnect, and the address changes, when the cached resolution expires
+//
+void ClientHttp::httpAddressRefresh()
+{
+	const std::string addr = hostResolve();
+	if( addr != m_http_host_addr )
+	{
+		m_http_client.set_hostname_addr_map( { { m_server_address.ip, addr } } );
+		m_http_host_addr = addr;
+	}
 }
 
 // Destructor
@@ -231,7 +285,7 @@ void ClientHttp::checkHttpResult( const httplib::Result &result, const std::stri
 	else if( result->status >= 300 || result->status < 200 )
 		DG_ERROR(
 			DG_FORMAT( prefix() << result->reason << "(" << result->status << ") " << result->body ),
-			ErrOperationFailed );
+			ErrServerError );
 }
 
 //
@@ -372,8 +426,16 @@ void ClientHttp::openStream(
 	if( m_ws_client != nullptr )
 		closeStream();
 
+	// no results are received at this point: ring can be safely reallocated
+	m_depth_controller.depthReset( frame_queue_depth );
+	m_frame_info_ring.reset( m_depth_controller.capacityGet() );
+	m_frame_info_ring.limitSet( m_depth_controller.depthGet() );
+	m_callback_executor.capacitySet( m_depth_controller.capacityGet() );
+	m_frame_queue_bytes = 0;
+
 	m_ws_client = new WebSocketClient(
-		WebSocketClient::urlCompose( m_server_address.ip, m_server_address.port, "/v1/stream" ) );
+		WebSocketClient::urlCompose( hostResolve(), m_server_address.port, "/v1/stream" ),
+		[ this ]( std::uintptr_t sock ) { socketSetup( sock ); } );
 
 	// configure connection
 	json req = { { "name", model_name }, { "config", additional_model_parameters } };
@@ -387,6 +449,7 @@ void ClientHttp::openStream(
 	{
 		std::lock_guard< std::mutex > lock( m_state );
 		m_state.m_last_error = "";
+		m_state.m_has_error = false;
 	}
 
 	// re-set callback, if it was set before opening stream
@@ -421,67 +484,148 @@ void ClientHttp::resultObserve( callback_t callback )
 		DG_TRC_BLOCK( AIClientHttp, callback_adapter, DGTrace::lvlDetailed );
 
 		// parse result and check for error
-		const json result = DG::JsonHelper::jsonDeserialize( raw_data );
+		json result = DG::JsonHelper::jsonDeserialize( raw_data );
 		const std::string err_msg = DG::JsonHelper::errorCheck( result, "", false );
 
-		std::unique_lock< std::mutex > lock( m_state );                   // acquire runtime state lock
-		const bool has_frame_info = !m_state.m_frame_info_queue.empty();  // check if there is frame info
-		std::string frame_info = has_frame_info ? m_state.m_frame_info_queue.front() : "";  // get frame info
-		const bool was_error = !m_state.m_last_error.empty();  // check if there was an error before
+		const FrameContext *frame = m_frame_info_ring.front();  // get frame context, if any
+		const bool was_error = m_state.m_has_error;               // check if there was an error before
+
+		// results received after the frame deadline are discarded, unless they report errors
+		const bool expired = err_msg.empty() && frame != nullptr &&
+							 frame->deadline != std::chrono::steady_clock::time_point::max() &&
+							 frame->expired( std::chrono::steady_clock::now() );
+		if( expired )
+			m_expired_frames++;
 
 		// save last error
 		if( !err_msg.empty() )
-			m_state.m_last_error = err_msg;
+			errorSet( err_msg );
 
-		// invoke user callback; not under lock; catch and ignore all errors;
-		// do it only for the first error - skip for consecutive errors to avoid race conditions
-		// when callback is called in parallel with main thread after dataEnd() exits
-		if( !was_error )
+		// remove frame info from the ring and notify waiting threads; let the depth controller account the frame
+		// before; then send pending frames into the freed space, or drop them after error
+		auto frame_remove = [ & ]() {
+			if( m_depth_controller.frameCompleted( m_frame_info_ring.size() ) )
+				m_frame_info_ring.limitSet( m_depth_controller.depthGet() );
+			m_frame_queue_bytes -= frame->size;
+			m_frame_info_ring.pop();
+
+			if( m_pending_frames_count > 0 )
+			{
+				try
+				{
+					std::lock_guard< std::mutex > lock( m_submit_mutex );
+					pendingFramesSend();
+				}
+				catch( std::exception &e )
+				{
+					errorSet( e.what() );
+				}
+				expiredFramesNotify();
+				if( m_state.m_has_error )
+					pendingFramesDrop();
+			}
+		};
+
+		// frame with completion object: remove frame info from the ring before notifying the completion,
+		// so it may send the next frame into the freed space; the completion is notified even after error,
+		// since it waits for each frame
+		FrameCompletion *completion = frame != nullptr ? frame->completion : nullptr;
+		if( completion != nullptr )
 		{
-			lock.unlock();
+			frame_remove();
 			try
 			{
-				m_async_result_callback( result, frame_info );
+				if( was_error )
+					completion->frameDropped( lastError() );
+				else if( expired )
+					completion->frameDropped( "Frame deadline is passed" );
+				else
+					completion->resultReady( std::move( result ) );
 			}
 			catch( ... )
 			{}
-			lock.lock();
+			return;
+		}
+
+		// invoke user callback; catch and ignore all errors;
+		// do it only for the first error - skip for consecutive errors to avoid race conditions
+		// when callback is called in parallel with main thread after dataEnd() exits
+		if( !was_error && !expired && m_async_result_callback != nullptr )
+		{
+			// the callback executor either calls it right here, or hands it over to its own threads;
+			// the post-processing callback is called before it as a separate stage, which may run concurrently
+			const std::string info = frame != nullptr ? frame->info : std::string();
+			if( m_callback_executor.isInline() )
+			{
+				try
+				{
+					if( m_result_postprocess != nullptr )
+						m_result_postprocess( result, info );
+					m_async_result_callback( result, info );
+				}
+				catch( ... )
+				{}
+			}
+			else
+			{
+				auto shared_result = std::make_shared< json >( std::move( result ) );
+				m_callback_executor.post(
+					[ this, shared_result, info ]() {
+						if( m_result_postprocess != nullptr )
+							m_result_postprocess( *shared_result, info );
+					},
+					[ this, shared_result, info ]() { m_async_result_callback( *shared_result, info ); } );
+			}
 		}
 
-		// remove frame info from queue and notify result receiving thread;
-		// do it after invoking user callback
-		if( has_frame_info )
-			m_state.m_frame_info_queue.pop();
-		m_waiter.notify_all();
+		// remove frame info from the ring after invoking inline user callback
+		if( frame != nullptr )
+			frame_remove();
+		else if( !err_msg.empty() )
+			m_frame_info_ring.notifyAll();
 	};
 
+	// results are dispatched even without the callback: frames with completion objects do not need it
 	if( m_ws_client != nullptr )
-		m_ws_client->callbackSet(
-			m_async_result_callback != nullptr ? callback_adapter : WebSocketClient::callback_t() );
+		m_ws_client->callbackSet( callback_adapter );
+}
+
+//
+// Set last error
+// [in] message - error message
+//
+void ClientHttp::errorSet( const std::string &message )
+{
+	std::lock_guard< std::mutex > lock( m_state );
+	m_state.m_last_error = message;
+	m_state.m_has_error = true;
 }
 
 //
-// Wait until the number of outstanding frames becomes less or equal to the given value or until error is detected
+// Wait until the number of outstanding and pending frames becomes less or equal to the given value
+// or until error is detected
 // [in] outstanding_frames - number of outstanding frames to wait for
-// [in] lock - acquired lock to use for waiting
 // Throws error on timeout
 // return true if no error occurred during the wait
 //
-bool ClientHttp::waitFor( size_t outstanding_frames, std::unique_lock< std::mutex > &lock )
+bool ClientHttp::waitFor( size_t outstanding_frames )
 {
 	DG_TRC_BLOCK( AIClientHttp, waitFor, DGTrace::lvlDetailed );
 
 	try
 	{
-		// wait until number of outstanding frames becomes less or equal to the given value
-		for( auto cur_size = m_state.m_frame_info_queue.size();
-			 cur_size > outstanding_frames && m_state.m_last_error.empty();
-			 cur_size = m_state.m_frame_info_queue.size() )
+		// wait until number of outstanding frames becomes less or equal to the given value;
+		// pending frames are counted as well, since they are sent as soon as outstanding frames complete
+		auto frames_count = [ this ]() { return m_frame_info_ring.size() + m_pending_frames_count; };
+		for( auto cur_size = frames_count(); cur_size > outstanding_frames && !m_state.m_has_error;
+			 cur_size = frames_count() )
 		{
-			if( !m_waiter.wait_for( lock, std::chrono::milliseconds( m_inference_timeout_ms ), [ & ] {
-					m_ws_client->errorCheck();
-					return m_state.m_frame_info_queue.size() < cur_size || !m_state.m_last_error.empty();
-				} ) )
+			if( !m_frame_info_ring.wait(
+					[ & ] {
+						m_ws_client->errorCheck();
+						return frames_count() < cur_size || m_state.m_has_error;
+					},
+					std::chrono::milliseconds( m_inference_timeout_ms ) ) )
 			{
 				DG_ERROR(
 					DG_FORMAT(
@@ -494,10 +638,49 @@ bool ClientHttp::waitFor( size_t outstanding_frames, std::unique_lock< std::mute
 	}
 	catch( std::exception &e )
 	{
-		m_state.m_last_error = e.what();  // preserve exception as last error
+		errorSet( e.what() );  // preserve exception as last error
+		throw;
+	}
+	return !m_state.m_has_error;
+}
+
+//
+// Wait until there is space for the frame in the frame queue: both for frame data and in the ring of outstanding
+// frames, or until error is detected
+// [in] size - frame size, bytes
+// [in] timeout - max. time to wait
+// Throws error on timeout
+// return true if no error occurred during the wait
+//
+bool ClientHttp::spaceWait( size_t size, std::chrono::milliseconds timeout )
+{
+	DG_TRC_BLOCK( AIClientHttp, spaceWait, DGTrace::lvlDetailed );
+
+	try
+	{
+		if( !m_frame_info_ring.wait(
+				[ & ] {
+					m_ws_client->errorCheck();
+					return ( m_frame_info_ring.size() < m_frame_info_ring.limitGet() &&
+							 frameBytesFit( m_frame_queue_bytes, size, m_frame_queue_bytes_limit ) ) ||
+						   m_state.m_has_error;
+				},
+				timeout ) )
+		{
+			DG_ERROR(
+				DG_FORMAT(
+					"Timeout " << m_inference_timeout_ms << " ms waiting for inference completion on AI server '"
+							   << std::string( m_server_address ) << " (current queue size is "
+							   << m_frame_info_ring.size() << " frames, " << m_frame_queue_bytes << " bytes)" ),
+				ErrTimeout );
+		}
+	}
+	catch( std::exception &e )
+	{
+		errorSet( e.what() );  // preserve exception as last error
 		throw;
 	}
-	return m_state.m_last_error.empty();
+	return !m_state.m_has_error;
 }
 
 //
@@ -507,33 +690,312 @@ bool ClientHttp::waitFor( size_t outstanding_frames, std::unique_lock< std::mute
 // On the very first frame the method launches result receiving thread. This thread asynchronously
 // retrieves prediction results and for each result calls user callback installed by resultObserve().
 // To terminate this thread dataEnd() should be called when no more data frames are expected.
-// [in] data - array containing frame data
+// [in] data - array of views of frame data: one view per model input
+// [in] frame_info - optional frame information string to be passed to the callback along the frame result
+// [in] deadline_ms - optional frame deadline in milliseconds; 0 for no deadline
 //
-void ClientHttp::dataSend( const std::vector< std::vector< char > > &data, const std::string &frame_info )
+void ClientHttp::dataSend( const std::vector< ByteView > &data, const std::string &frame_info, size_t deadline_ms )
 {
 	DG_TRC_BLOCK( AIClientHttp, dataSend, DGTrace::lvlDetailed );
 
+	if( m_async_result_callback == nullptr )
+		DG_ERROR( "dataSend: observation callback is not installed", ErrIncorrectAPIUse );
+
+	const FrameContextSource frame{ frame_info, deadlineGet( deadline_ms ), frameSizeGet( data ), nullptr };
+	frameSend( data, frame );
+}
+
+//
+// Send given data frame for prediction, and deliver the frame result to given completion object.
+// Once the frame is accepted, the completion object is notified exactly once.
+// [in] data - array containing frame data; it is moved into the client
+// [in] completion - completion object to be notified when the frame result is ready or the frame is dropped
+// [in] deadline_ms - optional frame deadline in milliseconds; 0 for no deadline
+//
+void ClientHttp::dataSend(
+	std::vector< std::vector< char > > &&data,
+	FrameCompletion &completion,
+	size_t deadline_ms )
+{
+	DG_TRC_BLOCK( AIClientHttp, dataSend::completion, DGTrace::lvlDetailed );
+
+	static const std::string no_frame_info;
+	const FrameContextSource frame{ no_frame_info, deadlineGet( deadline_ms ), frameSizeGet( data ), &completion };
+
+	// the frame, which does not fit into the frame queue, becomes pending instead of waiting for space:
+	// the caller may be the coroutine resumed in the result receiving thread
+	if( !frameSend( byteViewsGet( data ), frame, &data ) )
+		completion.frameDropped(
+			m_state.m_has_error ? lastError() : "Frame is dropped according to frame overflow policy" );
+}
+
+//
+// Try to send given data frame for prediction without waiting for space in the frame queue, and deliver the frame
+// result to given completion object. Frames waiting for space are not overtaken.
+// [in] data - array containing frame data; it is moved into the client only when the frame is accepted
+// [in] completion - completion object to be notified when the frame result is ready or the frame is dropped
+// [in] deadline_ms - optional frame deadline in milliseconds; 0 for no deadline
+// return true if the frame is accepted, false if the frame queue is full
+//
+bool ClientHttp::dataTrySend(
+	std::vector< std::vector< char > > &&data,
+	FrameCompletion &completion,
+	size_t deadline_ms )
+{
+	DG_TRC_BLOCK( AIClientHttp, dataTrySend, DGTrace::lvlDetailed );
+
 	if( m_ws_client == nullptr )
 		DG_ERROR( "dataSend: socket was not opened", ErrIncorrectAPIUse );
 
-	if( m_async_result_callback == nullptr )
-		DG_ERROR( "dataSend: observation callback is not installed", ErrIncorrectAPIUse );
+	static const std::string no_frame_info;
+	const FrameContextSource frame{ no_frame_info, deadlineGet( deadline_ms ), frameSizeGet( data ), &completion };
+	{
+		std::lock_guard< std::mutex > lock( m_submit_mutex );
+		if( !m_state.m_has_error )
+			return m_pending_frames.empty() && frameTrySend( byteViewsGet( data ), frame );
+	}
+
+	// do not post new frames if error was detected: the frame is accepted and dropped
+	completion.frameDropped( lastError() );
+	return true;
+}
 
+//
+// Put frame context into the ring of outstanding frames and send frame data to the server.
+// Frame submission is serialized, so frames are sent in the order of their contexts in the ring.
+// [in] data - array of views of frame data: one view per model input
+// [in] frame - frame context source
+// [in] pending_data - frame data to be moved into the queue of pending frames instead of waiting for space
+// in the frame queue (or nullptr to wait)
+// return true if the frame is sent or pending, false if it is dropped according to frame overflow policy,
+// or error was detected
+//
+bool ClientHttp::frameSend(
+	const std::vector< ByteView > &data,
+	const FrameContextSource &frame,
+	std::vector< std::vector< char > > *pending_data )
+{
+	if( m_ws_client == nullptr )
+		DG_ERROR( "dataSend: socket was not opened", ErrIncorrectAPIUse );
+
+	const auto wait_deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds( m_inference_timeout_ms );
+	std::unique_lock< std::mutex > lock( m_submit_mutex );
+	for( ;; )
 	{
-		// acquire runtime state lock
-		std::unique_lock< std::mutex > lock( m_state );
+		// do not post new frames if error was detected
+		if( m_state.m_has_error )
+			return false;
+
+		// frames to become pending do not overtake already pending ones
+		if( ( pending_data == nullptr || m_pending_frames.empty() ) && frameTrySend( data, frame ) )
+			return true;
+
+		// wait for space only when frame overflow policy does not drop frames
+		if( m_overflow_policy != FrameOverflowPolicy::Block )
+		{
+			m_dropped_frames++;
+			return false;
+		}
+
+		if( pending_data != nullptr )
+		{
+			m_pending_frames.push_back( { std::move( *pending_data ), frame.completion, frame.deadline, frame.size } );
+			m_pending_frames_count = m_pending_frames.size();
+
+			// outstanding frames may complete before the frame became pending: retry
+			pendingFramesSend();
+			lock.unlock();
+			expiredFramesNotify();
+			return true;
+		}
 
-		// wait until there is a space in outstanding frame queue
-		if( !waitFor( m_frame_queue_depth - 1, lock ) )
-			return;  // do not post new frames if error was detected
+		// wait without submission lock: result receiving thread sends pending frames under this lock
+		lock.unlock();
+		const auto now = std::chrono::steady_clock::now();
+		const bool no_error = spaceWait(
+			frame.size,
+			std::chrono::duration_cast< std::chrono::milliseconds >( std::max( wait_deadline, now ) - now ) );
+		lock.lock();
+		if( !no_error )
+			return false;
+	}
+}
 
-		// put frame info into the outstanding frame queue
-		m_state.m_frame_info_queue.push( frame_info );
+//
+// Put frame context into the ring of outstanding frames and send frame data to the server, when the frame fits
+// into the frame queue right away. Should be called under submission lock.
+// [in] data - array of views of frame data: one view per model input
+// [in] frame - frame context source
+// return true if the frame is sent, false if it does not fit
+//
+bool ClientHttp::frameTrySend( const std::vector< ByteView > &data, const FrameContextSource &frame )
+{
+	// idle time before the first outstanding frame would distort depth measurements
+	if( m_frame_info_ring.empty() )
+		m_depth_controller.restart();
+
+	// reserve space for frame data and put frame info into the ring of outstanding frames
+	if( !frameBytesReserve( m_frame_queue_bytes, frame.size, m_frame_queue_bytes_limit ) )
+		return false;
+	if( !m_frame_info_ring.tryPush( frame ) )
+	{
+		m_frame_queue_bytes -= frame.size;
+		return false;
 	}
 
 	// send frame to the server
 	for( const auto &d : data )
 		m_ws_client->binarySend( d );
+	return true;
+}
+
+//
+// Send as many pending frames as fit into the frame queue, and drop pending frames, which deadline is passed,
+// the same way as frames expired in the send queue of ASIO client. Should be called under submission lock.
+//
+void ClientHttp::pendingFramesSend()
+{
+	DG_TRC_BLOCK( AIClientHttp, pendingFramesSend, DGTrace::lvlDetailed );
+
+	static const std::string no_frame_info;
+	const auto now = std::chrono::steady_clock::now();
+	while( !m_pending_frames.empty() && !m_state.m_has_error )
+	{
+		PendingFrame &pending = m_pending_frames.front();
+
+		// the result of the frame would be discarded anyway: do not send it
+		if( now >= pending.deadline )
+		{
+			m_expired_completions.push_back( pending.completion );
+			m_pending_frames.pop_front();
+			m_pending_frames_count = m_pending_frames.size();
+			m_expired_frames++;
+			continue;
+		}
+
+		if( !frameBytesReserve( m_frame_queue_bytes, pending.size, m_frame_queue_bytes_limit ) )
+			break;
+		if( !m_frame_info_ring.tryPush(
+				FrameContextSource{ no_frame_info, pending.deadline, pending.size, pending.completion } ) )
+		{
+			m_frame_queue_bytes -= pending.size;
+			break;
+		}
+
+		const auto data = std::move( pending.data );
+		m_pending_frames.pop_front();
+		m_pending_frames_count = m_pending_frames.size();
+		for( const auto &d : byteViewsGet( data ) )
+			m_ws_client->binarySend( d );
+	}
+}
+
+//
+// Notify completion objects of pending frames dropped by pendingFramesSend() after their deadline.
+// Should be called without submission lock, since completion objects may send new frames.
+//
+void ClientHttp::expiredFramesNotify()
+{
+	std::vector< FrameCompletion * > expired;
+	{
+		std::lock_guard< std::mutex > lock( m_submit_mutex );
+		expired.swap( m_expired_completions );
+	}
+	for( auto completion : expired )
+	{
+		try
+		{
+			completion->frameDropped( "Frame deadline is passed" );
+		}
+		catch( ... )
+		{}
+	}
+}
+
+//
+// Drop all pending frames after error and notify their completion objects
+//
+void ClientHttp::pendingFramesDrop()
+{
+	DG_TRC_BLOCK( AIClientHttp, pendingFramesDrop, DGTrace::lvlDetailed );
+
+	std::deque< PendingFrame > dropped;
+	{
+		std::lock_guard< std::mutex > lock( m_submit_mutex );
+		dropped.swap( m_pending_frames );
+		m_pending_frames_count = 0;
+	}
+	if( dropped.empty() )
+		return;
+
+	m_frame_info_ring.notifyAll();  // pending frames are counted by waiters
+	const std::string reason = m_state.m_has_error ? lastError() : "Inference session is aborted";
+	for( auto &pending : dropped )
+	{
+		try
+		{
+			pending.completion->frameDropped( reason );
+		}
+		catch( ... )
+		{}
+	}
+}
+
+//
+// Set the limit of the total size of data of outstanding frames. See Client::frameQueueBytesLimitSet() for details.
+// [in] max_bytes - limit of the total size of data of outstanding frames in bytes; 0 for no limit
+//
+void ClientHttp::frameQueueBytesLimitSet( size_t max_bytes )
+{
+	DG_TRC_BLOCK( AIClientHttp, frameQueueBytesLimitSet, DGTrace::lvlBasic );
+
+	if( !m_frame_info_ring.empty() )
+		DG_ERROR(
+			"frameQueueBytesLimitSet: frame queue size limit cannot be changed while frames are outstanding",
+			ErrIncorrectAPIUse );
+
+	m_frame_queue_bytes_limit = max_bytes;
+}
+
+//
+// Set which threads call the user callback. See Client::callbackExecutionSet() for details.
+// [in] mode - callback execution mode
+// [in] thread_count - number of threads for CallbackExecution::Pool mode; 0 for the number of CPU cores
+// [in] ordered - call the user callback in the order of frames in CallbackExecution::Pool mode
+// [in] postprocess - optional callback, which post-processes each result before the user callback
+//
+void ClientHttp::callbackExecutionSet(
+	CallbackExecution mode, size_t thread_count, bool ordered, postprocess_t postprocess )
+{
+	DG_TRC_BLOCK( AIClientHttp, callbackExecutionSet, DGTrace::lvlBasic );
+
+	if( !m_frame_info_ring.empty() )
+		DG_ERROR(
+			"callbackExecutionSet: callback execution mode cannot be changed while frames are outstanding",
+			ErrIncorrectAPIUse );
+
+	m_callback_executor.configure( mode, thread_count, ordered );
+	m_result_postprocess = postprocess;
+}
+
+//
+// Set the range of adaptive frame queue depth. See Client::frameQueueDepthRangeSet() for details.
+// [in] min_depth - lower bound of frame queue depth
+// [in] max_depth - upper bound of frame queue depth
+//
+void ClientHttp::frameQueueDepthRangeSet( size_t min_depth, size_t max_depth )
+{
+	DG_TRC_BLOCK( AIClientHttp, frameQueueDepthRangeSet, DGTrace::lvlBasic );
+
+	if( !m_frame_info_ring.empty() )
+		DG_ERROR(
+			"frameQueueDepthRangeSet: frame queue depth cannot be changed while frames are outstanding",
+			ErrIncorrectAPIUse );
+
+	m_depth_controller.rangeSet( min_depth, max_depth, m_frame_queue_depth );
+	m_frame_info_ring.reset( m_depth_controller.capacityGet() );
+	m_frame_info_ring.limitSet( m_depth_controller.depthGet() );
+	m_callback_executor.capacitySet( m_depth_controller.capacityGet() );
 }
 
 //
@@ -543,17 +1005,29 @@ void ClientHttp::dataSend( const std::vector< std::vector< char > > &data, const
 void ClientHttp::dataEnd()
 {
 	DG_TRC_BLOCK( AIClientHttp, dataEnd, DGTrace::lvlBasic );
+	auto finish = [ this ]() {
+		pendingFramesDrop();
+		m_callback_executor.drain();  // wait for callbacks handed over to callback executor threads
+	};
 
-	std::unique_lock< std::mutex > lock( m_state );
-	waitFor( 0, lock );
+	try
+	{
+		waitFor( 0 );
+	}
+	catch( ... )
+	{
+		finish();
+		throw;
+	}
+	finish();
 }
 
 //
 // Run prediction on given data frame. Stream should be opened by openStream()
-// [in] data - array containing frame data
+// [in] data - array of views of frame data: one view per model input
 // [out] output - prediction result (JSON array)
 //
-void ClientHttp::predict( std::vector< std::vector< char > > &data, json &output )
+void ClientHttp::predict( const std::vector< ByteView > &data, json &output )
 {
 	DG_TRC_BLOCK( AIClientHttp, predict::vector, DGTrace::lvlBasic );
 
@@ -569,8 +1043,8 @@ void ClientHttp::predict( std::vector< std::vector< char > > &data, json &output
 	dataSend( data, "" );
 	dataEnd();
 
-	if( !m_state.m_last_error.empty() )
-		throw DGException( m_state.m_last_error, ErrOperationFailed );
+	if( m_state.m_has_error )
+		throw DGException( lastError(), ErrOperationFailed );
 }
 
 }  // namespace DG
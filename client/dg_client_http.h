@@ -12,8 +12,11 @@
 #ifndef DG_CLIENT_HTTP_H_
 #define DG_CLIENT_HTTP_H_
 
+#include <deque>
 #include <mutex>
-#include <queue>
+#include "Utilities/dg_callback_executor.h"
+#include "Utilities/dg_frame_ring.h"
+#include "Utilities/dg_queue_depth_controller.h"
 #include "dg_client.h"
 #include "dg_socket.h"
 #include "httplib.h"
@@ -30,10 +33,12 @@ public:
 	/// \param[in] server_address - server address
 	/// \param[in] connection_timeout_ms - connection timeout in milliseconds
 	/// \param[in] inference_timeout_ms - AI server inference timeout in milliseconds
+	/// \param[in] client_options - client transport options
 	ClientHttp(
 		const ServerAddress &server_address,
 		size_t connection_timeout_ms = DEFAULT_CONNECTION_TIMEOUT_MS,
-		size_t inference_timeout_ms = DEFAULT_INFERENCE_TIMEOUT_MS );
+		size_t inference_timeout_ms = DEFAULT_INFERENCE_TIMEOUT_MS,
+		const ClientOptions &client_options = ClientOptions() );
 
 	ClientHttp( const Client &s ) = delete;
 	ClientHttp &operator=( const ClientHttp & ) = delete;
@@ -91,10 +96,12 @@ public:
 	// Synchronous prediction API
 	//
 
+	using Client::predict;
+
 	/// Run prediction on given data frame. Stream should be opened by openStream()
-	/// \param[in] data - array containing frame data
+	/// \param[in] data - array of views of frame data: one view per model input
 	/// \param[out] output - prediction result (JSON array)
-	void predict( std::vector< std::vector< char > > &data, json &output ) override;
+	void predict( const std::vector< ByteView > &data, json &output ) override;
 
 	//
 	// Asynchronous prediction API
@@ -105,15 +112,50 @@ public:
 	/// dataSend() methods
 	void resultObserve( callback_t callback ) override;
 
+	using Client::dataSend;
+
 	/// Send given data frame for prediction. Prerequisites:
 	///   stream should be opened by openStream();
 	///   user callback to receive prediction results should be installed by resultObserve().
 	/// On the very first frame the method launches result receiving thread. This thread asynchronously
 	/// retrieves prediction results and for each result calls user callback installed by resultObserve().
 	/// To terminate this thread dataEnd() should be called when no more data frames are expected.
-	/// \param[in] data - array containing frame data
+	/// Frames are sent right away, so only late results are discarded after the frame deadline; frames with
+	/// completion objects, which wait for space in the frame queue, are dropped when their deadline is passed.
+	/// Safe to call from multiple threads: the frame information string is queued, and the frame is written
+	/// to the WebSocket under the same submission lock, so their orders match.
+	/// \param[in] data - array of views of frame data: one view per model input
 	/// \param[in] frame_info - optional frame information string to be passed to the callback along the frame result
-	void dataSend( const std::vector< std::vector< char > > &data, const std::string &frame_info = "" ) override;
+	/// \param[in] deadline_ms - optional frame deadline in milliseconds; 0 for no deadline
+	void dataSend(
+		const std::vector< ByteView > &data,
+		const std::string &frame_info = "",
+		size_t deadline_ms = 0 ) override;
+
+	/// Send given data frame for prediction, and deliver the frame result to given completion object.
+	/// Frame data is sent right away, as by dataSend() overload accepting frame information string.
+	/// See Client::dataSend() overload accepting completion object for other details.
+	/// \param[in] data - array containing frame data; it is moved into the client
+	/// \param[in] completion - completion object to be notified when the frame result is ready or the frame
+	/// is dropped
+	/// \param[in] deadline_ms - optional frame deadline in milliseconds; 0 for no deadline
+	void dataSend(
+		std::vector< std::vector< char > > &&data,
+		FrameCompletion &completion,
+		size_t deadline_ms = 0 ) override;
+
+	/// Try to send given data frame for prediction without waiting for space in the frame queue, and deliver
+	/// the frame result to given completion object. The accepted frame is sent right away.
+	/// See Client::dataTrySend() for details.
+	/// \param[in] data - array containing frame data; it is moved into the client only when the frame is accepted
+	/// \param[in] completion - completion object to be notified when the frame result is ready or the frame
+	/// is dropped
+	/// \param[in] deadline_ms - optional frame deadline in milliseconds; 0 for no deadline
+	/// \return true if the frame is accepted, false if the frame queue is full
+	bool dataTrySend(
+		std::vector< std::vector< char > > &&data,
+		FrameCompletion &completion,
+		size_t deadline_ms = 0 ) override;
 
 	/// Finalize the sequence of data frames. Should be called when no more data frames are
 	/// expected to terminate result receiving thread started by dataSend().
@@ -123,10 +165,58 @@ public:
 	/// Get # of outstanding inference results scheduled so far
 	int outstandingResultsCountGet() override
 	{
-		std::lock_guard< std::mutex > lock( m_state );
-		return (int)m_state.m_frame_info_queue.size();
+		return (int)m_frame_info_ring.size();
+	}
+
+	/// Set the range of adaptive frame queue depth. See Client::frameQueueDepthRangeSet() for details.
+	/// \param[in] min_depth - lower bound of frame queue depth
+	/// \param[in] max_depth - upper bound of frame queue depth
+	void frameQueueDepthRangeSet( size_t min_depth, size_t max_depth ) override;
+
+	/// Get frame queue depth status
+	FrameQueueDepthStatus frameQueueDepthStatusGet() override
+	{
+		FrameQueueDepthStatus status = m_depth_controller.statusGet();
+		status.bytes = m_frame_queue_bytes;
+		status.bytes_limit = m_frame_queue_bytes_limit;
+		return status;
+	}
+
+	/// Set the limit of the total size of data of outstanding frames.
+	/// See Client::frameQueueBytesLimitSet() for details.
+	/// \param[in] max_bytes - limit of the total size of data of outstanding frames in bytes; 0 for no limit
+	void frameQueueBytesLimitSet( size_t max_bytes ) override;
+
+	/// Set the policy of handling frames sent by dataSend() methods when the frame queue is full.
+	/// There is no send queue: frames are sent right away, so DropOldestUnsent policy drops new frames.
+	/// \param[in] policy - frame overflow policy
+	void frameOverflowPolicySet( FrameOverflowPolicy policy ) override
+	{
+		m_overflow_policy = policy;
+	}
+
+	/// Get # of frames dropped according to frame overflow policy since the client is created
+	size_t droppedFramesCountGet() override
+	{
+		return m_dropped_frames;
 	}
 
+	/// Get # of frames dropped or results discarded due to passed deadlines since the client is created
+	size_t expiredFramesCountGet() override
+	{
+		return m_expired_frames;
+	}
+
+	/// Set which threads call the user callback. See Client::callbackExecutionSet() for details.
+	/// \param[in] mode - callback execution mode
+	/// \param[in] thread_count - number of threads for CallbackExecution::Pool mode; 0 for the number of CPU cores
+	/// \param[in] ordered - call the user callback in the order of frames in CallbackExecution::Pool mode
+	/// \param[in] postprocess - optional callback, which post-processes each result before the user callback
+	void callbackExecutionSet( CallbackExecution mode,
+		size_t thread_count,
+		bool ordered = false,
+		postprocess_t postprocess = nullptr ) override;
+
 	/// If ever during consecutive calls to predict() methods server reported run-time error, then
 	/// this method will return error message string, otherwise it returns empty string.
 	std::string lastError() override
@@ -141,20 +231,63 @@ private:
 	size_t m_frame_queue_depth;          //!< depth of frame queue
 	size_t m_connection_timeout_ms;      //!< socket connection timeout, in milliseconds
 	size_t m_inference_timeout_ms;       //!< AI server inference timeout, in milliseconds
+	ClientOptions m_client_options;      //!< client transport options
 	callback_t m_async_result_callback;  //!< asynchronous inference result callback
+	postprocess_t m_result_postprocess;  //!< result post-processing callback
 
 	// internal objects:
 	httplib::Client m_http_client;       //!< HTTP client
+	std::string m_http_host_addr;        //!< server address HTTP client connects to (empty before first request)
 	class WebSocketClient *m_ws_client;  //!< WebSocket client
 
+	CallbackExecutor m_callback_executor;  //!< executor of m_async_result_callback calls
+
 	/// Asynchronous prediction runtime state structure
 	struct State: public std::mutex
 	{
-		std::queue< std::string > m_frame_info_queue;  //!< frame info queue
-		std::string m_last_error;                      //!< last prediction error (or empty)
-	} m_state;                                         //!< runtime state object
+		std::string m_last_error;               //!< last prediction error (or empty)
+		std::atomic_bool m_has_error{ false };  //!< last error is set: can be checked without lock
+	} m_state;                                  //!< runtime state object
+
+	FrameRing< FrameContext > m_frame_info_ring;  //!< contexts of outstanding frames
+	QueueDepthController m_depth_controller;      //!< frame queue depth controller
+
+	// frame admission control
+	std::atomic< FrameOverflowPolicy > m_overflow_policy;  //!< policy of handling frames when frame queue is full
+	std::atomic_size_t m_dropped_frames;                   //!< # of frames dropped according to m_overflow_policy
+	std::atomic_size_t m_expired_frames;                   //!< # of frames dropped or discarded due to deadlines
+	std::atomic_size_t m_frame_queue_bytes;                //!< total size of data of outstanding frames, bytes
+	size_t m_frame_queue_bytes_limit;                      //!< limit of m_frame_queue_bytes (or 0 for no limit)
+
+	/// Frame with completion object waiting for space in the frame queue
+	struct PendingFrame
+	{
+		std::vector< std::vector< char > > data;         //!< frame data
+		FrameCompletion *completion;                     //!< frame completion object
+		std::chrono::steady_clock::time_point deadline;  //!< time after which the frame result is useless
+		size_t size;                                     //!< total size of frame inputs, bytes
+	};
 
-	std::condition_variable m_waiter;  //!< condition variable for result receiving thread synchronization
+	// frame submission by concurrent producers
+	std::mutex m_submit_mutex;                               //!< mutex to serialize frame submission
+	std::deque< PendingFrame > m_pending_frames;             //!< frames waiting for space in the frame queue
+	std::atomic_size_t m_pending_frames_count;               //!< size of m_pending_frames: can be checked without lock
+	std::vector< FrameCompletion * > m_expired_completions;  //!< expired pending frames, to be notified
+
+	/// Set last error
+	/// \param[in] message - error message
+	void errorSet( const std::string &message );
+
+	/// Resolve server host name using process-wide resolver cache
+	/// \return server IP address string
+	std::string hostResolve();
+
+	/// Point HTTP client to the server address taken from resolver cache, so it follows address changes
+	void httpAddressRefresh();
+
+	/// Apply client transport options to the socket before it is connected
+	/// \param[in] sock - native socket handle
+	void socketSetup( std::uintptr_t sock );
 
 	/// Check HTTP result for errors
 	/// \param[in] result - HTTP result to check
@@ -177,6 +310,7 @@ private:
 	httpRequest( const std::string &path, const std::string &body = "", const std::string &content_type = "" )
 	{
 		httplib::Result result;
+		httpAddressRefresh();
 		for( int retry = 0; retry < 3; retry++ )
 		{
 			switch( req )
@@ -196,12 +330,52 @@ private:
 		return result;
 	}
 
-	/// Wait until the number of outstanding frames becomes or equal to the given value or until error is detected
+	/// Wait until the number of outstanding and pending frames becomes less or equal to the given value or until error
+	/// is detected
 	/// \param[in] outstanding_frames - number of outstanding frames to wait for
-	/// \param[in] lock - acquired lock to use for waiting
 	/// Throws error on timeout
 	// \return true if no error occurred during the wait
-	bool waitFor( size_t outstanding_frames, std::unique_lock< std::mutex > &lock );
+	bool waitFor( size_t outstanding_frames );
+
+	/// Wait until there is space for the frame in the frame queue: both for frame data and in the ring of
+	/// outstanding frames, or until error is detected
+	/// \param[in] size - frame size, bytes
+	/// \param[in] timeout - max. time to wait
+	/// Throws error on timeout
+	/// \return true if no error occurred during the wait
+	bool spaceWait( size_t size, std::chrono::milliseconds timeout );
+
+	/// Put frame context into the ring of outstanding frames and send frame data to the server.
+	/// Frame submission is serialized, so frames are sent in the order of their contexts in the ring.
+	/// \param[in] data - array of views of frame data: one view per model input
+	/// \param[in] frame - frame context source
+	/// \param[in] pending_data - frame data to be moved into the queue of pending frames instead of waiting for
+	/// space in the frame queue (or nullptr to wait)
+	/// \return true if the frame is sent or pending, false if it is dropped according to frame overflow policy,
+	/// or error was detected
+	bool frameSend(
+		const std::vector< ByteView > &data,
+		const FrameContextSource &frame,
+		std::vector< std::vector< char > > *pending_data = nullptr );
+
+	/// Put frame context into the ring of outstanding frames and send frame data to the server, when the frame fits
+	/// into the frame queue right away. Should be called under submission lock.
+	/// \param[in] data - array of views of frame data: one view per model input
+	/// \param[in] frame - frame context source
+	/// \return true if the frame is sent, false if it does not fit
+	bool frameTrySend( const std::vector< ByteView > &data, const FrameContextSource &frame );
+
+	/// Send as many pending frames as fit into the frame queue, and drop pending frames, which deadline is passed.
+	/// Should be called under submission lock. Completion objects of dropped frames are notified later
+	/// by expiredFramesNotify().
+	void pendingFramesSend();
+
+	/// Notify completion objects of pending frames dropped by pendingFramesSend() after their deadline.
+	/// Should be called without submission lock, since completion objects may send new frames.
+	void expiredFramesNotify();
+
+	/// Drop all pending frames after error and notify their completion objects
+	void pendingFramesDrop();
 
 	/// Close stream opened by openStream()
 	void closeStream();
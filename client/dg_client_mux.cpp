@@ -0,0 +1,561 @@
+///////////////////////////////////////////////////////////////////////////////
+/// \file dg_client_mux.cpp
+/// \brief Connection to AI server, which carries multiple logical streams
+///
+/// Copyright DeGirum Corporation 2023
+///
+/// This file contains implementation of DG::MuxConnection class
+///
+
+#include "dg_client_mux.h"
+#include <algorithm>
+#include <future>
+#include "Utilities/dg_json_helpers.h"
+
+/// profiler group
+DG_TRC_GROUP_DEF( AIClientMux );
+
+namespace DG
+{
+
+/// Multiplexing enable flag
+static std::atomic_bool g_mux_enabled{ false };
+
+//
+// Enable or disable multiplexing of streams for clients created afterwards
+// [in] enable - true to enable multiplexing
+//
+void MuxConnection::enable( bool enable )
+{
+	g_mux_enabled = enable;
+}
+
+//
+// Check if multiplexing of streams is enabled
+//
+bool MuxConnection::enabledGet()
+{
+	return g_mux_enabled;
+}
+
+//
+// Registry of connections per server
+//
+std::map< std::string, std::weak_ptr< MuxConnection > > &MuxConnection::registry()
+{
+	static std::map< std::string, std::weak_ptr< MuxConnection > > connections;
+	return connections;
+}
+
+//
+// Registry mutex
+//
+std::mutex &MuxConnection::registryMutex()
+{
+	static std::mutex mx;
+	return mx;
+}
+
+//
+// Get connection to the server shared by all streams: connect to the server, if not connected yet
+// [in] server_address - server address
+// [in] connection_timeout_ms - connection timeout in milliseconds
+// [in] client_options - client transport options; used only when new connection is established
+// return shared connection object; throws exception when the server does not support multiplexing
+//
+std::shared_ptr< MuxConnection > MuxConnection::get(
+	const ServerAddress &server_address,
+	size_t connection_timeout_ms,
+	const ClientOptions &client_options )
+{
+	std::lock_guard< std::mutex > lk( registryMutex() );
+
+	// drop connections, which are already closed
+	auto &connections = registry();
+	for( auto it = connections.begin(); it != connections.end(); )
+		if( it->second.expired() )
+			it = connections.erase( it );
+		else
+			++it;
+
+	// reuse live connection; failed connection is replaced by new one
+	auto &entry = connections[ std::string( server_address ) ];
+	auto connection = entry.lock();
+	if( connection == nullptr || connection->m_failed )
+	{
+		connection.reset( new MuxConnection( server_address, connection_timeout_ms, client_options ) );
+		entry = connection;
+	}
+	return connection;
+}
+
+//
+// Constructor. Connects to the server and switches connection to multiplexed mode.
+// [in] server_address - server address
+// [in] connection_timeout_ms - connection timeout in milliseconds
+// [in] client_options - client transport options
+//
+MuxConnection::MuxConnection(
+	const ServerAddress &server_address,
+	size_t connection_timeout_ms,
+	const ClientOptions &client_options ) :
+	m_io_engine( main_protocol::IoEngine::sharedGet() ), m_socket( m_io_context ),
+	m_strand( asio::make_strand( m_io_engine != nullptr ? m_io_engine->context() : m_io_context ) ),
+	m_write_strand( asio::make_strand( m_io_engine != nullptr ? m_io_engine->context() : m_io_context ) ),
+	m_server_address( server_address ), m_client_options( client_options ), m_reader_finished( false ),
+	m_failed( false ), m_write_busy( false ), m_next_stream_id( 1 ), m_dispatch_thread( std::thread::id() ),
+	m_rx_buffer_pool( BufferPool::create() )
+{
+	DG_TRC_BLOCK( AIClientMux, constructor, DGTrace::lvlBasic );
+
+	if( m_io_engine != nullptr )
+		m_socket = m_io_engine->connect( m_server_address, connection_timeout_ms / 1000, client_options );
+	else
+		m_socket = main_protocol::socket_connect(
+			m_io_context,
+			m_server_address,
+			connection_timeout_ms / 1000,
+			client_options );
+
+	// switch connection to multiplexed mode: the server confirms it by its protocol version
+	const std::string request = DG::messagePrepare( json( { { "op", main_protocol::commands::MUX } } ) );
+	main_protocol::write( m_socket, request.data(), request.size() );
+
+	std::vector< char > response_buffer;
+	main_protocol::read( m_socket, response_buffer, true );
+	const json response = response_buffer.empty() ? json() : json::parse( response_buffer, nullptr, false );
+	if( !response.is_object() || !response.contains( DG::PROTOCOL_VERSION_TAG ) ||
+		response[ DG::PROTOCOL_VERSION_TAG ].get< int >() < DG::MUX_MIN_PROTOCOL_VERSION )
+		DG_ERROR(
+			DG_FORMAT(
+				"AI server '" << std::string( m_server_address )
+							  << "' does not support multiplexing of streams. Please upgrade AI server instance to "
+								 "newer one or disable multiplexing." ),
+			ErrNotSupportedVersion );
+	DG::JsonHelper::errorCheck( response, "MuxConnection" );
+
+	// start the reader; own I/O context is run by two threads, so writes are not delayed by stream handlers,
+	// which block the reader
+	readInitiate();
+	if( m_io_engine == nullptr )
+	{
+		m_work = std::make_unique< work_guard_t >( asio::make_work_guard( m_io_context ) );
+		m_reader_thread = std::thread( [ this ]() { m_io_context.run(); } );
+		m_writer_thread = std::thread( [ this ]() { m_io_context.run(); } );
+	}
+}
+
+//
+// Destructor. Closes the connection.
+//
+MuxConnection::~MuxConnection()
+{
+	DG_TRC_BLOCK( AIClientMux, destructor, DGTrace::lvlBasic );
+
+	// finish queued writes, like end-of-stream packets of closed streams
+	{
+		std::unique_lock< std::mutex > lk( m_write_mutex );
+		m_write_cv.wait( lk, [ this ] { return !m_write_busy; } );
+	}
+
+	// close the socket in the reader strand to cancel pending read, and wait for the reader to finish
+	auto socket_close = [ this ]() {
+		asio::error_code ec;
+		m_socket.shutdown( asio::ip::tcp::socket::shutdown_both, ec );
+		m_socket.close( ec );
+	};
+
+	if( m_io_engine != nullptr )
+	{
+		bool closed = false;
+		asio::post( m_strand, [ & ]() {
+			socket_close();
+			std::lock_guard< std::mutex > lk( m_streams_mutex );
+			closed = true;
+			m_reader_cv.notify_all();
+		} );
+
+		// this object may be destroyed right after engine thread releases the lock
+		std::unique_lock< std::mutex > lk( m_streams_mutex );
+		m_reader_cv.wait( lk, [ & ] { return closed && m_reader_finished; } );
+	}
+	else
+	{
+		// I/O threads run posted handler and finish, when no more handlers are pending
+		asio::post( m_strand, socket_close );
+		m_work.reset();
+		if( m_reader_thread.joinable() )
+			m_reader_thread.join();
+		if( m_writer_thread.joinable() )
+			m_writer_thread.join();
+		socket_close();
+	}
+}
+
+//
+// Register new logical stream
+// [in] handler - stream result handler
+// return stream ID
+//
+uint32_t MuxConnection::streamOpen( handler_t handler )
+{
+	DG_TRC_BLOCK( AIClientMux, streamOpen, DGTrace::lvlBasic );
+
+	std::lock_guard< std::mutex > lk( m_streams_mutex );
+	if( m_failed )
+		DG_ERROR(
+			DG_FORMAT(
+				"Connection to AI server '" << std::string( m_server_address ) << "' failed: " << m_error.message() ),
+			ErrSystem );
+
+	const uint32_t stream_id = m_next_stream_id++;
+	m_streams[ stream_id ] = std::move( handler );
+	return stream_id;
+}
+
+//
+// Close logical stream: queue end-of-stream packet without waiting for it to be sent, and unregister stream handler.
+// When this method returns, the handler is not running and will not be called anymore.
+// When called from a stream handler, the handler is unregistered when the reader leaves it.
+// [in] stream_id - stream ID returned by streamOpen()
+//
+void MuxConnection::streamClose( uint32_t stream_id )
+{
+	DG_TRC_BLOCK( AIClientMux, streamClose, DGTrace::lvlBasic );
+
+	// queue empty packet to indicate end-of-stream after frames queued before; it is not waited for, since
+	// the stream may be closed from its handler, and write errors are ignored: the connection may be already closed
+	if( !m_failed )
+	{
+		WriteRequest request{ stream_id, { htonl( stream_id ), 0 }, {}, nullptr, false };
+		request.bufs.push_back( asio::buffer( request.headers.data(), main_protocol::MUX_HEADER_SIZE ) );
+		writeEnqueue( std::move( request ) );
+	}
+
+	// the reader holds dispatch lock while running stream handler, which may be the caller:
+	// the handler being run cannot be destroyed, so it is unregistered by the reader
+	if( inDispatch() )
+	{
+		std::lock_guard< std::mutex > lk( m_streams_mutex );
+		m_closed_streams.push_back( stream_id );
+		return;
+	}
+
+	std::lock_guard< std::mutex > dispatch_lock( m_dispatch_mutex );
+	std::lock_guard< std::mutex > lk( m_streams_mutex );
+	m_streams.erase( stream_id );
+}
+
+//
+// Wait until the reader finishes passing the current result to the stream handler, if any.
+// Does not wait when called from a stream handler.
+//
+void MuxConnection::dispatchSync()
+{
+	if( inDispatch() )
+		return;
+	std::lock_guard< std::mutex > dispatch_lock( m_dispatch_mutex );
+}
+
+//
+// Write packet of given stream, synchronously: wait until the packet is written after packets queued before
+// [in] stream_id - stream ID
+// [in] data - data to send
+// [in] size - size of data to send, in bytes
+//
+void MuxConnection::write( uint32_t stream_id, const char *data, size_t size )
+{
+	assert( size < size_t( ( std::numeric_limits< int32_t >::max )() ) );
+	const uint32_t header[ 2 ] = { htonl( stream_id ), htonl( static_cast< uint32_t >( size ) ) };
+	std::vector< asio::const_buffer > bufs = { asio::buffer( header, main_protocol::MUX_HEADER_SIZE ) };
+	if( size > 0 )
+		bufs.push_back( asio::buffer( data, size ) );
+	buffersWrite( stream_id, bufs );
+}
+
+//
+// Write next chunk of a packet of given stream, synchronously. See main_protocol::write_chunk() for details.
+// [in] stream_id - stream ID
+// [in] data - chunk data to send
+// [in] size - size of chunk data, in bytes
+// [in] last - true for the last chunk of the packet
+//
+void MuxConnection::writeChunk( uint32_t stream_id, const char *data, size_t size, bool last )
+{
+	// empty chunk, which is not the last one, would be taken for abort marker
+	if( size == 0 && !last )
+		return;
+
+	size_t bytes_sent = 0;
+	do
+	{
+		// each chunk is queued separately, so chunks of other streams may go in between
+		const size_t chunk_size = std::min( size - bytes_sent, main_protocol::MAX_CHUNK_SIZE );
+		const bool last_chunk = last && bytes_sent + chunk_size == size;
+		const uint32_t header[ 2 ] = { htonl( stream_id ), main_protocol::chunk_header_get( chunk_size, last_chunk ) };
+		buffersWrite(
+			stream_id,
+			{ asio::buffer( header, main_protocol::MUX_HEADER_SIZE ), asio::buffer( data + bytes_sent, chunk_size ) } );
+		bytes_sent += chunk_size;
+	} while( bytes_sent < size );
+}
+
+//
+// Abort the packet of given stream being sent in chunks by writeChunk()
+// [in] stream_id - stream ID
+//
+void MuxConnection::writeChunkAbort( uint32_t stream_id )
+{
+	const uint32_t header[ 2 ] = { htonl( stream_id ), htonl( main_protocol::CHUNK_CONTINUATION_FLAG ) };
+	buffersWrite( stream_id, { asio::buffer( header, main_protocol::MUX_HEADER_SIZE ) } );
+}
+
+//
+// Write gather list of given stream synchronously: queue it and wait until it is written
+// [in] stream_id - stream ID
+// [in] bufs - gather list
+//
+void MuxConnection::buffersWrite( uint32_t stream_id, const std::vector< asio::const_buffer > &bufs )
+{
+	DG_TRC_BLOCK( AIClientMux, write, DGTrace::lvlDetailed );
+
+	if( m_failed )
+		DG_ERROR(
+			DG_FORMAT(
+				"Connection to AI server '" << std::string( m_server_address ) << "' failed: " << m_error.message() ),
+			ErrSystem );
+
+	std::promise< asio::error_code > written;
+	writeEnqueue( WriteRequest{
+		stream_id,
+		{},
+		bufs,
+		[ &written ]( const asio::error_code &ec ) { written.set_value( ec ); },
+		false } );
+
+	const asio::error_code error = written.get_future().get();
+	if( error )
+		DG_ERROR( error.message(), ErrSystem );
+}
+
+//
+// Cancel queued writes of given stream, which are not started yet
+// [in] stream_id - stream ID
+//
+void MuxConnection::writeCancel( uint32_t stream_id )
+{
+	// cancelled requests are kept in the queue, so their handlers are called in order by the writer
+	std::lock_guard< std::mutex > lk( m_write_mutex );
+	for( size_t ri = 1; ri < m_write_queue.size(); ri++ )
+		if( m_write_queue[ ri ].stream_id == stream_id )
+			m_write_queue[ ri ].cancelled = true;
+}
+
+//
+// Queue the write and start the writer in the write strand, if it is idle
+// [in] request - write request
+//
+void MuxConnection::writeEnqueue( WriteRequest &&request )
+{
+	{
+		std::lock_guard< std::mutex > lk( m_write_mutex );
+		m_write_queue.push_back( std::move( request ) );
+		if( m_write_busy )
+			return;
+		m_write_busy = true;
+	}
+	asio::post( m_write_strand, [ this ]() { writeInitiate(); } );
+}
+
+//
+// Initiate asynchronous write of the oldest queued request; cancelled requests are completed without writing.
+// Called in the write strand by the writer owner.
+//
+void MuxConnection::writeInitiate()
+{
+	std::vector< write_handler_t > cancelled;
+	const std::vector< asio::const_buffer > *bufs = nullptr;
+	{
+		std::lock_guard< std::mutex > lk( m_write_mutex );
+		while( !m_write_queue.empty() && m_write_queue.front().cancelled )
+		{
+			cancelled.push_back( std::move( m_write_queue.front().handler ) );
+			m_write_queue.pop_front();
+		}
+
+		// queued requests are not moved by pushing new ones
+		if( !m_write_queue.empty() )
+			bufs = &m_write_queue.front().bufs;
+		else
+		{
+			m_write_busy = false;
+			m_write_cv.notify_all();  // this object may be destroyed right after the lock is released
+		}
+	}
+
+	if( bufs != nullptr )
+	{
+		auto on_written = [ this ]( const asio::error_code &ec, size_t ) { writeDone( ec ); };
+		asio::async_write( m_socket, *bufs, asio::bind_executor( m_write_strand, on_written ) );
+	}
+
+	for( auto &handler : cancelled )
+		if( handler != nullptr )
+			handler( asio::error::operation_aborted );
+}
+
+//
+// Callback for asynchronous write: complete the oldest queued request and write the next one
+// [in] ec - write error code
+//
+void MuxConnection::writeDone( const asio::error_code &ec )
+{
+	write_handler_t handler;
+	{
+		std::lock_guard< std::mutex > lk( m_write_mutex );
+		handler = std::move( m_write_queue.front().handler );
+		m_write_queue.pop_front();
+	}
+
+	writeInitiate();
+	if( handler != nullptr )
+		handler( ec );
+}
+
+//
+// Initiate asynchronous read of next packet header
+//
+void MuxConnection::readInitiate()
+{
+	asio::async_read(
+		m_socket,
+		asio::buffer( m_rx_header, main_protocol::MUX_HEADER_SIZE ),
+		asio::bind_executor( m_strand, [ this ]( const asio::error_code &ec, size_t ) { headerReceive( ec ); } ) );
+}
+
+//
+// Callback for asynchronous read of packet header
+//
+void MuxConnection::headerReceive( const asio::error_code &ec )
+{
+	if( ec )
+		return fail( ec );
+
+	m_rx_buffer = m_rx_buffer_pool->acquire();
+	m_rx_buffer->resize( ntohl( m_rx_header[ 1 ] ) );
+	asio::async_read(
+		m_socket,
+		asio::buffer( *m_rx_buffer ),
+		asio::bind_executor( m_strand, [ this ]( const asio::error_code &ec, size_t ) { packetReceive( ec ); } ) );
+}
+
+//
+// Callback for asynchronous read of packet body: pass the packet to the stream handler
+//
+void MuxConnection::packetReceive( const asio::error_code &ec )
+{
+	DG_TRC_BLOCK( AIClientMux, packetReceive, DGTrace::lvlDetailed );
+
+	if( ec )
+	{
+		m_rx_buffer.reset();
+		return fail( ec );
+	}
+	main_protocol::socket_quick_ack_rearm( m_socket, m_client_options );
+
+	{
+		// streams cannot be closed by other threads while their handlers are running
+		std::lock_guard< std::mutex > dispatch_lock( m_dispatch_mutex );
+		m_dispatch_thread = std::this_thread::get_id();
+
+		// results of closed streams are dropped
+		handler_t *handler = handlerFind( ntohl( m_rx_header[ 0 ] ) );
+		if( handler != nullptr )
+		{
+			try
+			{
+				( *handler )( ec, std::move( m_rx_buffer ) );
+			}
+			catch( ... )
+			{}
+		}
+
+		dispatchFinish();
+	}
+
+	m_rx_buffer.reset();
+	readInitiate();
+}
+
+//
+// Fail the connection: pass error to all stream handlers and finish the reader
+// [in] ec - error code
+//
+void MuxConnection::fail( const asio::error_code &ec )
+{
+	DG_TRC_BLOCK( AIClientMux, fail, DGTrace::lvlBasic );
+
+	{
+		std::lock_guard< std::mutex > dispatch_lock( m_dispatch_mutex );
+		m_dispatch_thread = std::this_thread::get_id();
+
+		std::vector< uint32_t > stream_ids;
+		{
+			std::lock_guard< std::mutex > lk( m_streams_mutex );
+			m_error = ec;
+			m_failed = true;
+			for( auto &stream : m_streams )
+				stream_ids.push_back( stream.first );
+		}
+
+		// handlers may close other streams: those are skipped
+		for( auto stream_id : stream_ids )
+		{
+			handler_t *handler = handlerFind( stream_id );
+			if( handler == nullptr )
+				continue;
+			try
+			{
+				( *handler )( ec, nullptr );
+			}
+			catch( ... )
+			{}
+		}
+
+		dispatchFinish();
+	}
+
+	// this object may be destroyed right after the lock is released
+	std::lock_guard< std::mutex > lk( m_streams_mutex );
+	m_reader_finished = true;
+	m_reader_cv.notify_all();
+}
+
+//
+// Find handler of given stream to be called by the reader under dispatch lock
+// [in] stream_id - stream ID
+// return pointer to stream handler or nullptr, when the stream is closed
+//
+MuxConnection::handler_t *MuxConnection::handlerFind( uint32_t stream_id )
+{
+	std::lock_guard< std::mutex > lk( m_streams_mutex );
+	if( std::find( m_closed_streams.begin(), m_closed_streams.end(), stream_id ) != m_closed_streams.end() )
+		return nullptr;
+	auto it = m_streams.find( stream_id );
+	return it != m_streams.end() ? &it->second : nullptr;
+}
+
+//
+// Finish passing results to stream handlers under dispatch lock: unregister streams closed by the handlers
+//
+void MuxConnection::dispatchFinish()
+{
+	m_dispatch_thread = std::thread::id();
+
+	std::lock_guard< std::mutex > lk( m_streams_mutex );
+	for( auto stream_id : m_closed_streams )
+		m_streams.erase( stream_id );
+	m_closed_streams.clear();
+}
+
+}  // namespace DG
@@ -0,0 +1,293 @@
+///////////////////////////////////////////////////////////////////////////////
+/// \file dg_client_mux.h
+/// \brief Connection to AI server, which carries multiple logical streams
+///
+/// Copyright DeGirum Corporation 2023
+///
+/// This file contains declaration of DG::MuxConnection class:
+/// TCP connection to AI server shared by multiple model streams
+/// of DG client-server proprietary protocol
+///
+
+#ifndef DG_CLIENT_MUX_H_
+#define DG_CLIENT_MUX_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Utilities/dg_buffer_pool.h"
+#include "Utilities/dg_client_structs.h"
+#include "dg_socket.h"
+
+namespace DG
+{
+
+/// TCP connection to AI server, which carries multiple logical model streams.
+///
+/// The connection is established by "mux" command. Once the server confirms that it supports protocol version
+/// MUX_MIN_PROTOCOL_VERSION or newer, every packet in both directions is prefixed by four-byte big-endian stream
+/// ID followed by the usual four-byte big-endian packet size. The first packet of a stream is "stream" command,
+/// and an empty packet closes the stream, so each logical stream follows the same sequence of packets as
+/// the dedicated stream socket does.
+///
+/// All clients, which stream to the same server, share single connection obtained by get(). The connection has
+/// single result reader: it demultiplexes results by stream ID and passes them to stream handlers. Writes of all
+/// streams are queued and performed asynchronously one at a time in the write strand, so packets of different frames
+/// never interleave, and no thread holds a lock while the socket is written: synchronous writes just wait for their
+/// turn in the queue to complete, and asynchronous ones return right away.
+class MuxConnection
+{
+public:
+	/// Stream result handler type. Called from the reader for each result packet of the stream with packet buffer,
+	/// or with error code and empty buffer handle when the connection fails
+	using handler_t = std::function< void( const asio::error_code &, BufferPool::handle_t && ) >;
+
+	/// Write completion handler type. Called from I/O thread with write error code.
+	using write_handler_t = std::function< void( const asio::error_code & ) >;
+
+	/// Enable or disable multiplexing of streams for clients created afterwards
+	/// \param[in] enable - true to enable multiplexing
+	static void enable( bool enable );
+
+	/// Check if multiplexing of streams is enabled
+	static bool enabledGet();
+
+	/// Get connection to the server shared by all streams: connect to the server, if not connected yet
+	/// \param[in] server_address - server address
+	/// \param[in] connection_timeout_ms - connection timeout in milliseconds
+	/// \param[in] client_options - client transport options; used only when new connection is established
+	/// \return shared connection object; throws exception when the server does not support multiplexing
+	static std::shared_ptr< MuxConnection > get(
+		const ServerAddress &server_address,
+		size_t connection_timeout_ms,
+		const ClientOptions &client_options = ClientOptions() );
+
+	MuxConnection( const MuxConnection & ) = delete;
+	MuxConnection &operator=( const MuxConnection & ) = delete;
+
+	/// Destructor. Closes the connection.
+	~MuxConnection();
+
+	/// Register new logical stream
+	/// \param[in] handler - stream result handler
+	/// \return stream ID
+	uint32_t streamOpen( handler_t handler );
+
+	/// Close logical stream: queue end-of-stream packet without waiting for it to be sent, and unregister
+	/// stream handler. When this method returns, the handler is not running and will not be called anymore.
+	/// May be called from a stream handler: then the handler of the closed stream is not called anymore,
+	/// and it is unregistered when the reader leaves the handler.
+	/// \param[in] stream_id - stream ID returned by streamOpen()
+	void streamClose( uint32_t stream_id );
+
+	/// Wait until the reader finishes passing the current result to the stream handler, if any.
+	/// Does not wait when called from a stream handler.
+	void dispatchSync();
+
+	/// Write packet of given stream, synchronously: wait until the packet is written after packets queued before.
+	/// Like other synchronous writes, should not be called from stream handlers.
+	/// \param[in] stream_id - stream ID
+	/// \param[in] data - data to send
+	/// \param[in] size - size of data to send, in bytes
+	void write( uint32_t stream_id, const char *data, size_t size );
+
+	/// Write next chunk of a packet of given stream, synchronously. See main_protocol::write_chunk() for details.
+	/// Chunks of different streams may interleave, so other streams are not blocked while the packet is being sent.
+	/// \param[in] stream_id - stream ID
+	/// \param[in] data - chunk data to send
+	/// \param[in] size - size of chunk data, in bytes
+	/// \param[in] last - true for the last chunk of the packet
+	void writeChunk( uint32_t stream_id, const char *data, size_t size, bool last );
+
+	/// Abort the packet of given stream being sent in chunks by writeChunk()
+	/// \param[in] stream_id - stream ID
+	void writeChunkAbort( uint32_t stream_id );
+
+	/// Write all inputs of multiple frames of given stream, synchronously, using single scatter/gather write.
+	/// \param[in] stream_id - stream ID
+	/// \param[in] frames - pointer to the array of frames; each frame is an array of frame inputs,
+	/// each element of which should provide data() and size() methods
+	/// \param[in] frame_count - number of frames to write
+	template< typename Container >
+	void writeFrames( uint32_t stream_id, const std::vector< Container > *frames, size_t frame_count )
+	{
+		std::vector< uint32_t > headers;
+		std::vector< asio::const_buffer > bufs;
+		framesBuffersPrepare( stream_id, frames, frame_count, headers, bufs );
+		buffersWrite( stream_id, bufs );
+	}
+
+	/// Write all inputs of multiple frames of given stream asynchronously, using single scatter/gather write
+	/// after packets queued before. Frame data should stay valid until the completion handler is called.
+	/// \param[in] stream_id - stream ID
+	/// \param[in] frames - pointer to the array of frames; each frame is an array of frame inputs,
+	/// each element of which should provide data() and size() methods
+	/// \param[in] frame_count - number of frames to write
+	/// \param[in] handler - completion handler; it is called from I/O thread, never from this method
+	template< typename Container >
+	void writeFramesAsync(
+		uint32_t stream_id,
+		const std::vector< Container > *frames,
+		size_t frame_count,
+		write_handler_t handler )
+	{
+		WriteRequest request{ stream_id, {}, {}, std::move( handler ), false };
+		framesBuffersPrepare( stream_id, frames, frame_count, request.headers, request.bufs );
+		writeEnqueue( std::move( request ) );
+	}
+
+	/// Cancel queued writes of given stream, which are not started yet: their completion handlers are called
+	/// with asio::error::operation_aborted. The write in progress is not cancelled, so the stream never gets
+	/// partially written packet.
+	/// \param[in] stream_id - stream ID
+	void writeCancel( uint32_t stream_id );
+
+private:
+	/// Queued write
+	struct WriteRequest
+	{
+		uint32_t stream_id;                      //!< stream ID
+		std::vector< uint32_t > headers;         //!< packet headers owned by the request
+		std::vector< asio::const_buffer > bufs;  //!< gather list
+		write_handler_t handler;                 //!< completion handler
+		bool cancelled;                          //!< the write is cancelled by writeCancel()
+	};
+
+	/// Prepare gather list of all inputs of multiple frames of given stream
+	/// \param[in] stream_id - stream ID
+	/// \param[in] frames - pointer to the array of frames
+	/// \param[in] frame_count - number of frames
+	/// \param[out] headers - packet headers referenced by the gather list
+	/// \param[out] bufs - gather list
+	template< typename Container >
+	static void framesBuffersPrepare(
+		uint32_t stream_id,
+		const std::vector< Container > *frames,
+		size_t frame_count,
+		std::vector< uint32_t > &headers,
+		std::vector< asio::const_buffer > &bufs )
+	{
+		size_t input_count = 0;
+		for( size_t fi = 0; fi < frame_count; fi++ )
+			input_count += frames[ fi ].size();
+
+		headers.resize( 2 * input_count );
+		bufs.reserve( 2 * input_count );
+
+		uint32_t *header = headers.data();
+		for( size_t fi = 0; fi < frame_count; fi++ )
+			for( const auto &input : frames[ fi ] )
+			{
+				const size_t packet_size = input.size() * sizeof( *input.data() );
+				header[ 0 ] = htonl( stream_id );
+				header[ 1 ] = htonl( static_cast< uint32_t >( packet_size ) );
+				bufs.push_back( asio::buffer( header, main_protocol::MUX_HEADER_SIZE ) );
+				if( packet_size > 0 )
+					bufs.push_back( asio::buffer( input.data(), packet_size ) );
+				header += 2;
+			}
+	}
+
+	/// Constructor. Connects to the server and switches connection to multiplexed mode.
+	/// \param[in] server_address - server address
+	/// \param[in] connection_timeout_ms - connection timeout in milliseconds
+	/// \param[in] client_options - client transport options
+	MuxConnection(
+		const ServerAddress &server_address,
+		size_t connection_timeout_ms,
+		const ClientOptions &client_options );
+
+	/// Write gather list of given stream synchronously: queue it and wait until it is written
+	/// \param[in] stream_id - stream ID
+	/// \param[in] bufs - gather list
+	void buffersWrite( uint32_t stream_id, const std::vector< asio::const_buffer > &bufs );
+
+	/// Queue the write and start the writer in the write strand, if it is idle
+	/// \param[in] request - write request
+	void writeEnqueue( WriteRequest &&request );
+
+	/// Initiate asynchronous write of the oldest queued request; cancelled requests are completed without writing.
+	/// Called in the write strand by the writer owner.
+	void writeInitiate();
+
+	/// Callback for asynchronous write: complete the oldest queued request and write the next one
+	/// \param[in] ec - write error code
+	void writeDone( const asio::error_code &ec );
+
+	/// Initiate asynchronous read of next packet header
+	void readInitiate();
+
+	/// Callback for asynchronous read of packet header
+	void headerReceive( const asio::error_code &ec );
+
+	/// Callback for asynchronous read of packet body: pass the packet to the stream handler
+	void packetReceive( const asio::error_code &ec );
+
+	/// Fail the connection: pass error to all stream handlers and finish the reader
+	/// \param[in] ec - error code
+	void fail( const asio::error_code &ec );
+
+	/// Find handler of given stream to be called by the reader under dispatch lock
+	/// \param[in] stream_id - stream ID
+	/// \return pointer to stream handler or nullptr, when the stream is closed
+	handler_t *handlerFind( uint32_t stream_id );
+
+	/// Finish passing results to stream handlers under dispatch lock: unregister streams closed by the handlers
+	void dispatchFinish();
+
+	/// Check if called from stream handler by the reader
+	bool inDispatch() const
+	{
+		return m_dispatch_thread.load() == std::this_thread::get_id();
+	}
+
+	/// Strand type
+	using strand_t = asio::strand< main_protocol::io_context_t::executor_type >;
+
+	/// Work guard type
+	using work_guard_t = asio::executor_work_guard< main_protocol::io_context_t::executor_type >;
+
+	/// Registry of connections per server
+	static std::map< std::string, std::weak_ptr< MuxConnection > > &registry();
+
+	/// Registry mutex
+	static std::mutex &registryMutex();
+
+	main_protocol::io_context_t m_io_context;                //!< own I/O context (when shared I/O engine is not used)
+	std::shared_ptr< main_protocol::IoEngine > m_io_engine;  //!< shared I/O engine (or nullptr to use own context)
+	main_protocol::socket_t m_socket;                        //!< connection socket
+	strand_t m_strand;                                       //!< strand to serialize reader and socket closing
+	strand_t m_write_strand;                                 //!< strand to serialize writes
+	DG::ServerAddress m_server_address;                      //!< server address
+	ClientOptions m_client_options;                          //!< client transport options of the connection
+	std::thread m_reader_thread;                             //!< thread running own I/O context
+	std::thread m_writer_thread;                             //!< thread running own I/O context along with the reader
+	std::unique_ptr< work_guard_t > m_work;                  //!< work guard to keep own I/O context running
+	std::condition_variable m_reader_cv;                     //!< condition variable to wait for the reader finish
+	bool m_reader_finished;                                  //!< the reader is finished
+	std::atomic_bool m_failed;                               //!< connection is failed
+	asio::error_code m_error;                                //!< connection error
+	std::mutex m_write_mutex;                                //!< mutex to protect write queue
+	std::condition_variable m_write_cv;                      //!< condition variable to wait for the writer to finish
+	std::deque< WriteRequest > m_write_queue;                //!< queued writes; the oldest one is being written
+	bool m_write_busy;                                       //!< the writer is active
+	std::mutex m_streams_mutex;                              //!< mutex to protect stream registry and reader state
+	std::map< uint32_t, handler_t > m_streams;               //!< stream handlers per stream ID
+	uint32_t m_next_stream_id;                               //!< next stream ID
+	std::mutex m_dispatch_mutex;                             //!< mutex held while stream handler is running
+	std::atomic< std::thread::id > m_dispatch_thread;        //!< thread running stream handlers (or none)
+	std::vector< uint32_t > m_closed_streams;                //!< streams closed by stream handlers
+	uint32_t m_rx_header[ 2 ];                               //!< header of packet being received
+	std::shared_ptr< BufferPool > m_rx_buffer_pool;          //!< pool of reusable buffers for received results
+	BufferPool::handle_t m_rx_buffer;                        //!< buffer for packet being received
+};
+
+}  // namespace DG
+
+#endif  // DG_CLIENT_MUX_H_
@@ -0,0 +1,135 @@
+///////////////////////////////////////////////////////////////////////////////
+/// \file dg_client_pool.cpp
+/// \brief Registry of idle client connections reused by management commands
+///
+/// Copyright DeGirum Corporation 2023
+///
+/// This file contains implementation of DG::ClientPool class
+///
+
+#include "dg_client_pool.h"
+
+//
+// Get process-wide registry instance
+//
+DG::ClientPool &DG::ClientPool::instance()
+{
+	static ClientPool pool;
+	return pool;
+}
+
+//
+// Configure the registry. Idle clients exceeding new limits are closed.
+// [in] max_idle_per_server - max. number of idle clients kept per server; 0 disables connection reuse
+// [in] idle_timeout_ms - idle timeout in milliseconds: clients idle longer than that are closed
+//
+void DG::ClientPool::configure( size_t max_idle_per_server, size_t idle_timeout_ms )
+{
+	std::vector< Client::ClientPtr > evicted;
+	std::lock_guard< std::mutex > lock( m_mutex );
+	m_max_idle_per_server = max_idle_per_server;
+	m_idle_timeout_ms = idle_timeout_ms;
+
+	for( auto &entry : m_idle )
+		while( entry.second.size() > m_max_idle_per_server )
+		{
+			// drop least recently used clients first
+			evicted.push_back( std::move( entry.second.front().client ) );
+			entry.second.erase( entry.second.begin() );
+		}
+	evict( evicted );
+}
+
+//
+// Close all idle clients
+//
+void DG::ClientPool::clear()
+{
+	decltype( m_idle ) idle;
+	{
+		std::lock_guard< std::mutex > lock( m_mutex );
+		idle.swap( m_idle );
+	}
+	// clients are closed here, outside of the lock
+}
+
+//
+// Get the number of idle clients in the registry
+//
+size_t DG::ClientPool::idleCountGet()
+{
+	std::lock_guard< std::mutex > lock( m_mutex );
+	size_t count = 0;
+	for( const auto &entry : m_idle )
+		count += entry.second.size();
+	return count;
+}
+
+//
+// Check out the client from the registry, or create new one if there are no idle clients for the server
+// [in] key - server key
+// [out] reused - set to true if the client was taken from the registry
+// return client object
+//
+DG::Client::ClientPtr DG::ClientPool::checkout( const std::string &key, bool &reused )
+{
+	std::vector< Client::ClientPtr > evicted;
+	{
+		std::lock_guard< std::mutex > lock( m_mutex );
+		evict( evicted );
+
+		auto it = m_idle.find( key );
+		if( it != m_idle.end() && !it->second.empty() )
+		{
+			// take most recently used client: its connection is least likely to be closed by the server
+			Client::ClientPtr client = std::move( it->second.back().client );
+			it->second.pop_back();
+			reused = true;
+			return client;
+		}
+	}
+
+	// connect outside of the lock
+	reused = false;
+	return Client::create( key );
+}
+
+//
+// Return the client back to the registry
+// [in] key - server key
+// [in] client - client to return
+//
+void DG::ClientPool::checkin( const std::string &key, Client::ClientPtr &&client )
+{
+	std::vector< Client::ClientPtr > evicted;
+	std::lock_guard< std::mutex > lock( m_mutex );
+	auto &idle = m_idle[ key ];
+	if( idle.size() < m_max_idle_per_server )
+		idle.push_back( { std::move( client ), std::chrono::steady_clock::now() } );
+	else
+		evicted.push_back( std::move( client ) );
+	evict( evicted );
+}
+
+//
+// Remove idle clients, which exceed idle timeout. Should be called under m_mutex lock.
+// [out] evicted - evicted clients; they should be destroyed outside of the lock
+//
+void DG::ClientPool::evict( std::vector< Client::ClientPtr > &evicted )
+{
+	const auto expiration = std::chrono::steady_clock::now() - std::chrono::milliseconds( m_idle_timeout_ms );
+	for( auto it = m_idle.begin(); it != m_idle.end(); )
+	{
+		// idle clients are ordered by idle time: the oldest come first
+		auto &idle = it->second;
+		auto last_expired = idle.begin();
+		while( last_expired != idle.end() && last_expired->idle_since <= expiration )
+			evicted.push_back( std::move( ( last_expired++ )->client ) );
+		idle.erase( idle.begin(), last_expired );
+
+		if( idle.empty() )
+			it = m_idle.erase( it );
+		else
+			++it;
+	}
+}
@@ -0,0 +1,148 @@
+///////////////////////////////////////////////////////////////////////////////
+/// \file dg_client_pool.h
+/// \brief Registry of idle client connections reused by management commands
+///
+/// Copyright DeGirum Corporation 2023
+///
+/// This file contains declaration of DG::ClientPool class:
+/// process-wide registry of idle, kept-alive client connections
+/// keyed by server address
+///
+
+#ifndef DG_CLIENT_POOL_H_
+#define DG_CLIENT_POOL_H_
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <type_traits>
+#include "dg_client.h"
+
+namespace DG
+{
+
+/// Process-wide registry of idle client connections.
+/// Management commands (model zoo list, system info, ping, etc.) are executed on clients checked out from
+/// the registry; after successful command the client is checked back in, so the next command to the same
+/// server reuses its connection instead of resolving server address and connecting again.
+/// Clients, which stay idle longer than idle timeout, are evicted.
+class ClientPool
+{
+public:
+	/// Default max. number of idle clients kept per server
+	static constexpr size_t DEFAULT_MAX_IDLE_PER_SERVER = 4;
+
+	/// Default idle timeout, ms: clients idle longer than that are closed
+	static constexpr size_t DEFAULT_IDLE_TIMEOUT_MS = 30000;
+
+	/// Get process-wide registry instance
+	static ClientPool &instance();
+
+	ClientPool( const ClientPool & ) = delete;
+	ClientPool &operator=( const ClientPool & ) = delete;
+
+	/// Configure the registry. Idle clients exceeding new limits are closed.
+	/// \param[in] max_idle_per_server - max. number of idle clients kept per server; 0 disables connection reuse
+	/// \param[in] idle_timeout_ms - idle timeout in milliseconds: clients idle longer than that are closed
+	void configure( size_t max_idle_per_server, size_t idle_timeout_ms );
+
+	/// Close all idle clients
+	void clear();
+
+	/// Get the number of idle clients in the registry
+	size_t idleCountGet();
+
+	/// Execute command on a client checked out from the registry.
+	/// When the command succeeds, or the server reports run-time error (ErrServerError code), the client is returned
+	/// to the registry. On any other error, including transport errors, the connection state is unknown, so the client
+	/// is discarded. Idle connection may be closed by the server meanwhile, so the idempotent command, which failed
+	/// on reused connection, is retried; the command, which failed on new connection, is not retried. The failure
+	/// may happen after the server has executed the command, so other commands are never retried: they are executed
+	/// on reused connection only after it is checked by ping.
+	/// \param[in] server - server address in a format "[http://]host:port"
+	/// \param[in] command - functional, which accepts Client reference and executes command on it
+	/// \param[in] idempotent - true for read-only queries, which are safe to execute more than once
+	/// \return the value returned by the command
+	template< typename F >
+	std::invoke_result_t< F, Client & > execute( const std::string &server, F &&command, bool idempotent = false )
+	{
+		const auto addr = ServerAddress::fromHostname( server );
+		const std::string key = addr;
+
+		for( ;; )
+		{
+			bool reused = false;
+			Client::ClientPtr client = checkout( key, reused );
+
+			// stale connection is discarded before the command, which cannot be retried, is sent
+			if( reused && !idempotent && !client->ping( 0, true ) )
+				continue;
+
+			try
+			{
+				if constexpr( std::is_void_v< std::invoke_result_t< F, Client & > > )
+				{
+					command( *client );
+					checkin( key, std::move( client ) );
+					return;
+				}
+				else
+				{
+					auto result = command( *client );
+					checkin( key, std::move( client ) );
+					return result;
+				}
+			}
+			catch( DGException &e )
+			{
+				// server-reported error: the response is received, so connection is still in a good state
+				if( e.error_code() == ErrServerError )
+					checkin( key, std::move( client ) );
+				else if( reused && idempotent )
+					continue;
+				throw;
+			}
+			catch( ... )
+			{
+				if( reused && idempotent )
+					continue;
+				throw;
+			}
+		}
+	}
+
+private:
+	/// Constructor
+	ClientPool() = default;
+
+	/// Idle client entry
+	struct IdleClient
+	{
+		Client::ClientPtr client;                          //!< idle client
+		std::chrono::steady_clock::time_point idle_since;  //!< time when the client became idle
+	};
+
+	/// Check out the client from the registry, or create new one if there are no idle clients for the server
+	/// \param[in] key - server key
+	/// \param[out] reused - set to true if the client was taken from the registry
+	/// \return client object
+	Client::ClientPtr checkout( const std::string &key, bool &reused );
+
+	/// Return the client back to the registry
+	/// \param[in] key - server key
+	/// \param[in] client - client to return
+	void checkin( const std::string &key, Client::ClientPtr &&client );
+
+	/// Remove idle clients, which exceed idle timeout. Should be called under m_mutex lock.
+	/// \param[out] evicted - evicted clients; they should be destroyed outside of the lock
+	void evict( std::vector< Client::ClientPtr > &evicted );
+
+	std::mutex m_mutex;                                          //!< mutex to protect the registry
+	std::map< std::string, std::vector< IdleClient > > m_idle;   //!< idle clients per server key
+	size_t m_max_idle_per_server = DEFAULT_MAX_IDLE_PER_SERVER;  //!< max. number of idle clients per server
+	size_t m_idle_timeout_ms = DEFAULT_IDLE_TIMEOUT_MS;          //!< idle timeout, ms
+};
+
+}  // namespace DG
+
+#endif  // DG_CLIENT_POOL_H_
@@ -0,0 +1,287 @@
+///////////////////////////////////////////////////////////////////////////////
+/// \file dg_client_shm.cpp
+/// \brief Shared memory channel to pass frames and results to AI server running on the same host
+///
+/// Copyright DeGirum Corporation 2023
+///
+/// This file contains implementation of DG::SharedMemoryChannel class
+///
+
+#include "dg_client_shm.h"
+#include "Utilities/dg_json_helpers.h"
+
+#include <cerrno>
+#include <new>
+
+#if !defined( _WIN32 )
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace DG
+{
+
+//
+// Round value up to the ring block alignment
+//
+static uint64_t alignUp( uint64_t value )
+{
+	return ( value + SharedMemoryChannel::ALIGNMENT - 1 ) / SharedMemoryChannel::ALIGNMENT *
+		   SharedMemoryChannel::ALIGNMENT;
+}
+
+//
+// Get ring position of the block, which follows given position: aligned and not wrapping over the ring end
+// [in] position - ring position after the previous block
+// [in] size - block size, bytes
+// [in] capacity - ring capacity, bytes
+//
+static uint64_t blockPlace( uint64_t position, uint64_t size, uint64_t capacity )
+{
+	position = alignUp( position );
+	if( position % capacity + size > capacity )
+		position += capacity - position % capacity;
+	return position;
+}
+
+//
+// Create anonymous memory file of given size
+// [in] size - file size, bytes
+// return file descriptor
+//
+#if !defined( _WIN32 )
+static int anonymousFileCreate( size_t size )
+{
+#if defined( __linux__ )
+	const int fd = ::memfd_create( "dg_shm_stream", MFD_CLOEXEC );
+	if( fd < 0 )
+		DG_ERROR( DG_FORMAT( "Error creating shared memory file: " << std::strerror( errno ) ), ErrSystem );
+#else
+	// no memfd_create(): shared memory object is unlinked right away, so only its descriptor keeps it alive;
+	// name is unique within the host: process ID and per-process counter
+	static std::atomic< unsigned > counter{ 0 };
+	int fd = -1;
+	for( int attempt = 0; fd < 0; attempt++ )
+	{
+		const std::string name = "/dg_shm_" + std::to_string( ::getpid() ) + "_" + std::to_string( counter++ );
+		fd = ::shm_open( name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600 );
+		if( fd >= 0 )
+			::shm_unlink( name.c_str() );
+		else if( errno != EEXIST || attempt >= 100 )
+			DG_ERROR( DG_FORMAT( "Error creating shared memory object: " << std::strerror( errno ) ), ErrSystem );
+	}
+#endif
+
+	if( ::ftruncate( fd, off_t( size ) ) != 0 )
+	{
+		const int error = errno;
+		::close( fd );
+		DG_ERROR(
+			DG_FORMAT( "Error allocating " << size << " bytes of shared memory: " << std::strerror( error ) ),
+			ErrSystem );
+	}
+	return fd;
+}
+#endif
+
+//
+// Constructor. Creates and maps anonymous shared memory segment.
+// [in] input_capacity - input ring capacity in bytes; 0 for default
+// [in] result_capacity - result ring capacity in bytes; 0 for default
+//
+SharedMemoryChannel::SharedMemoryChannel( size_t input_capacity, size_t result_capacity ) :
+	m_fd( -1 ), m_size( 0 ), m_base( nullptr ), m_header( nullptr ), m_input_head( 0 ), m_input_tail( 0 ),
+	m_next_frame_id( 0 )
+{
+#if defined( _WIN32 )
+	DG_ERROR( "Shared memory transport is not supported on this platform", ErrNotSupported );
+#else
+	input_capacity = alignUp( input_capacity > 0 ? input_capacity : DEFAULT_INPUT_CAPACITY );
+	result_capacity = alignUp( result_capacity > 0 ? result_capacity : DEFAULT_RESULT_CAPACITY );
+	const size_t input_offset = alignUp( sizeof( SegmentHeader ) );
+	const size_t result_offset = input_offset + input_capacity;
+	m_size = result_offset + result_capacity;
+
+	m_fd = anonymousFileCreate( m_size );
+	void *base = ::mmap( nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0 );
+	if( base == MAP_FAILED )
+	{
+		const int error = errno;
+		::close( m_fd );
+		DG_ERROR(
+			DG_FORMAT( "Error mapping " << m_size << " bytes of shared memory: " << std::strerror( error ) ),
+			ErrSystem );
+	}
+
+	m_base = static_cast< char * >( base );
+	m_header = new( m_base ) SegmentHeader();
+	m_header->magic = SEGMENT_MAGIC;
+	m_header->version = LAYOUT_VERSION;
+	m_header->input_offset = input_offset;
+	m_header->input_capacity = input_capacity;
+	m_header->result_offset = result_offset;
+	m_header->result_capacity = result_capacity;
+	m_header->result_consumed = 0;
+#endif
+}
+
+//
+// Destructor. Unmaps shared memory segment and closes its file descriptor.
+// The server keeps its own mapping until it closes the stream.
+//
+SharedMemoryChannel::~SharedMemoryChannel()
+{
+#if !defined( _WIN32 )
+	if( m_base != nullptr )
+	{
+		::munmap( m_base, m_size );
+		::close( m_fd );
+	}
+#endif
+}
+
+//
+// Get segment description to be passed to the server in "stream" command
+//
+json SharedMemoryChannel::configGet() const
+{
+	return json( { { "size", m_size }, { "version", LAYOUT_VERSION } } );
+}
+
+//
+// Reserve input ring space for all inputs of the next frame, waiting for space, and fill their descriptors
+// [in] sizes - sizes of frame inputs, bytes
+// [out] descriptors - pointer to the array of descriptors to fill, one per frame input
+// [in] timeout_ms - max. time to wait for space, ms; 0 to reserve the space only when it is available right away
+// [in] abort - predicate, which returns true when waiting should be abandoned
+// return false if waiting is abandoned or there is no space right away, and the space is not reserved;
+// throws exception on timeout
+//
+bool SharedMemoryChannel::frameReserve(
+	const std::vector< size_t > &sizes,
+	Descriptor *descriptors,
+	size_t timeout_ms,
+	const std::function< bool() > &abort )
+{
+	const uint64_t capacity = m_header->input_capacity;
+
+	std::unique_lock< std::mutex > lock( m_mutex );
+
+	// block placement depends only on the head position, so the whole frame is placed once
+	uint64_t end = m_input_head;
+	for( size_t i = 0; i < sizes.size(); i++ )
+	{
+		if( sizes[ i ] > capacity )
+			DG_ERROR(
+				DG_FORMAT(
+					"Frame input of " << sizes[ i ] << " bytes does not fit into shared memory buffer of " << capacity
+									  << " bytes. Please increase ClientOptions::shared_memory_input_size" ),
+				ErrBadParameter );
+		const uint64_t position = blockPlace( end, sizes[ i ], capacity );
+		descriptors[ i ] = Descriptor{ DESCRIPTOR_MAGIC, 0, m_next_frame_id, position, sizes[ i ] };
+		end = position + sizes[ i ];
+	}
+
+	if( end - m_input_head > capacity )
+		DG_ERROR(
+			DG_FORMAT(
+				"Frame inputs of " << end - m_input_head << " bytes do not fit into shared memory buffer of "
+								   << capacity << " bytes. Please increase ClientOptions::shared_memory_input_size" ),
+			ErrBadParameter );
+
+	// wait until outstanding frames release enough space
+	if( timeout_ms > 0 &&
+		!m_space.wait_for( lock, std::chrono::milliseconds( timeout_ms ), [ & ] {
+			return end - m_input_tail <= capacity || abort();
+		} ) )
+		DG_ERROR(
+			DG_FORMAT(
+				"Timeout " << timeout_ms << " ms waiting for space in shared memory buffer of " << capacity
+						   << " bytes" ),
+			ErrTimeout );
+
+	if( end - m_input_tail > capacity )
+		return false;
+
+	m_input_head = end;
+	m_frames.push_back( Frame{ m_next_frame_id++, end } );
+	return true;
+}
+
+//
+// Cancel the latest reservation made by frameReserve() or framePut(), which frame is not sent,
+// and return its space to the input ring
+//
+void SharedMemoryChannel::frameUnreserve()
+{
+	std::lock_guard< std::mutex > lock( m_mutex );
+	if( m_frames.empty() )
+		return;
+
+	m_frames.pop_back();
+	m_next_frame_id--;
+	m_input_head = m_frames.empty() ? m_input_tail : m_frames.back().end;
+	m_space.notify_all();
+}
+
+//
+// Validate result packet and release inputs of the oldest outstanding frame
+// [in] packet - result packet data
+// [in] size - result packet size, bytes
+// [out] descriptor - result descriptor
+// return true if the packet is descriptor, false if it is serialized result
+//
+bool SharedMemoryChannel::resultAccept( const uint8_t *packet, size_t size, Descriptor &descriptor )
+{
+	std::lock_guard< std::mutex > lock( m_mutex );
+	if( m_frames.empty() )
+		DG_ERROR( "Unexpected result received from AI server over shared memory transport", ErrOperationFailed );
+
+	const Frame frame = m_frames.front();
+	m_frames.pop_front();
+	m_input_tail = frame.end;
+	m_space.notify_all();
+
+	uint32_t magic = 0;
+	if( size >= sizeof( magic ) )
+		std::memcpy( &magic, packet, sizeof( magic ) );
+	if( magic != DESCRIPTOR_MAGIC )
+		return false;
+
+	const uint64_t capacity = m_header->result_capacity;
+	if( size == sizeof( descriptor ) )
+		std::memcpy( &descriptor, packet, sizeof( descriptor ) );
+	if( size != sizeof( descriptor ) || descriptor.size > capacity ||
+		descriptor.position % capacity + descriptor.size > capacity )
+		DG_ERROR( "Malformed result descriptor received from AI server over shared memory transport", ErrSystem );
+	if( descriptor.frame_id != frame.id )
+		DG_ERROR(
+			DG_FORMAT(
+				"Result of frame " << descriptor.frame_id << " is received from AI server over shared memory transport"
+								   << " while result of frame " << frame.id << " is expected" ),
+			ErrOperationFailed );
+	return true;
+}
+
+//
+// Drop all outstanding frames: their results will never be processed
+//
+void SharedMemoryChannel::reset()
+{
+	std::lock_guard< std::mutex > lock( m_mutex );
+	m_frames.clear();
+	m_input_tail = m_input_head;
+	m_space.notify_all();
+}
+
+//
+// Wake up producers waiting for space to re-check abort predicate
+//
+void SharedMemoryChannel::wake()
+{
+	std::lock_guard< std::mutex > lock( m_mutex );
+	m_space.notify_all();
+}
+
+}  // namespace DG
@@ -0,0 +1,241 @@
+///////////////////////////////////////////////////////////////////////////////
+/// \file dg_client_shm.h
+/// \brief Shared memory channel to pass frames and results to AI server running on the same host
+///
+/// Copyright DeGirum Corporation 2023
+///
+/// This file contains declaration of DG::SharedMemoryChannel class:
+/// shared memory segment mapped by both client and AI server, which keeps
+/// frame inputs and inference results of a model stream
+///
+
+#ifndef DG_CLIENT_SHM_H_
+#define DG_CLIENT_SHM_H_
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "Utilities/dg_client_structs.h"
+
+namespace DG
+{
+
+/// Shared memory segment, which keeps frame inputs and inference results of a model stream.
+///
+/// The segment is anonymous memory file created by the client: it has no name, so it is accessible only by
+/// the processes, which got its file descriptor, and it is freed when the last of them closes it, even when
+/// the client crashes. Its size and layout version are sent in "shm" field of "stream" command, and its file
+/// descriptor is passed to the server right after the command over the stream socket (see
+/// main_protocol::descriptor_send()).
+/// It starts with SegmentHeader followed by the input ring and the result ring. Frame inputs are written into
+/// the input ring, either directly by the producer in the space reserved by frameReserve(), or copied there by
+/// framePut(), and only their descriptors travel over the stream socket: one Descriptor packet per input.
+/// The server puts results into the result ring and sends Descriptor packet per result the same way; a result
+/// packet, which does not start with DESCRIPTOR_MAGIC, is the serialized result itself (used for early errors).
+///
+/// Both rings are addressed by ever-increasing 64-bit positions; the offset in the ring is position modulo ring
+/// capacity. Each block starts at ALIGNMENT boundary and never wraps: when it does not fit till the end of the ring,
+/// it starts at the beginning of the ring. Space of frame inputs is reused after the result of the frame is received,
+/// so the server should not access frame inputs after it sends the frame result. The server reuses result space
+/// up to result_consumed position, which the client advances after processing each result.
+class SharedMemoryChannel
+{
+public:
+	/// Segment header magic: "DGSM"
+	static constexpr uint32_t SEGMENT_MAGIC = 0x4D534744;
+
+	/// Descriptor packet magic: "DGSD"; its first byte cannot start serialized result object
+	static constexpr uint32_t DESCRIPTOR_MAGIC = 0x44534744;
+
+	/// Segment layout version
+	static constexpr uint32_t LAYOUT_VERSION = 1;
+
+	/// Alignment of ring blocks, bytes
+	static constexpr size_t ALIGNMENT = 64;
+
+	/// Default input ring capacity, bytes
+	static constexpr size_t DEFAULT_INPUT_CAPACITY = size_t( 64 ) << 20;
+
+	/// Default result ring capacity, bytes
+	static constexpr size_t DEFAULT_RESULT_CAPACITY = size_t( 4 ) << 20;
+
+	/// Header at the beginning of the segment. All fields are in host byte order.
+	struct SegmentHeader
+	{
+		uint32_t magic;                           //!< SEGMENT_MAGIC
+		uint32_t version;                         //!< LAYOUT_VERSION
+		uint64_t input_offset;                    //!< offset of the input ring from the segment start, bytes
+		uint64_t input_capacity;                  //!< input ring capacity, bytes
+		uint64_t result_offset;                   //!< offset of the result ring from the segment start, bytes
+		uint64_t result_capacity;                 //!< result ring capacity, bytes
+		std::atomic< uint64_t > result_consumed;  //!< result ring position up to which results are consumed
+	};
+
+	/// Descriptor of a block in the ring: the body of the packet sent over the stream socket in host byte order
+	struct Descriptor
+	{
+		uint32_t magic;     //!< DESCRIPTOR_MAGIC
+		uint32_t reserved;  //!< reserved, zero
+		uint64_t frame_id;  //!< sequential number of the frame in the stream
+		uint64_t position;  //!< ring position of the block
+		uint64_t size;      //!< block size, bytes
+	};
+
+	/// Constructor. Creates and maps anonymous shared memory segment.
+	/// \param[in] input_capacity - input ring capacity in bytes; 0 for default
+	/// \param[in] result_capacity - result ring capacity in bytes; 0 for default
+	SharedMemoryChannel( size_t input_capacity, size_t result_capacity );
+
+	SharedMemoryChannel( const SharedMemoryChannel & ) = delete;
+	SharedMemoryChannel &operator=( const SharedMemoryChannel & ) = delete;
+
+	/// Destructor. Unmaps shared memory segment and closes its file descriptor.
+	~SharedMemoryChannel();
+
+	/// Get segment description to be passed to the server in "stream" command
+	json configGet() const;
+
+	/// Get file descriptor of the segment to be passed to the server after "stream" command
+	int descriptorGet() const
+	{
+		return m_fd;
+	}
+
+	/// Reserve input ring space for all inputs of the next frame, waiting for space, and fill their descriptors.
+	/// The space is not reused until the frame result is received, so it can be filled without lock. Frames are
+	/// expected to be sent in the order of their reservation.
+	/// \param[in] sizes - sizes of frame inputs, bytes
+	/// \param[out] descriptors - pointer to the array of descriptors to fill, one per frame input
+	/// \param[in] timeout_ms - max. time to wait for space, ms; 0 to reserve the space only when it is available
+	/// right away
+	/// \param[in] abort - predicate, which returns true when waiting should be abandoned; checked on wake()
+	/// \return false if waiting is abandoned or there is no space right away, and the space is not reserved;
+	/// throws exception on timeout
+	bool frameReserve(
+		const std::vector< size_t > &sizes,
+		Descriptor *descriptors,
+		size_t timeout_ms,
+		const std::function< bool() > &abort );
+
+	/// Cancel the latest reservation made by frameReserve() or framePut(), which frame is not sent,
+	/// and return its space to the input ring
+	void frameUnreserve();
+
+	/// Get writable memory of the frame input reserved by frameReserve()
+	/// \param[in] descriptor - descriptor of the frame input
+	void *inputDataGet( const Descriptor &descriptor ) const
+	{
+		return inputAt( descriptor.position );
+	}
+
+	/// Copy all inputs of the frame into the input ring, waiting for space, and fill their descriptors
+	/// \param[in] frame - array of frame inputs, each element of which should provide data() and size() methods
+	/// \param[out] descriptors - pointer to the array of descriptors, one per frame input
+	/// \param[in] timeout_ms - max. time to wait for space, ms; 0 to put the frame only when the space is
+	/// available right away
+	/// \param[in] abort - predicate, which returns true when waiting should be abandoned; checked on wake()
+	/// \return false if waiting is abandoned or there is no space right away, and the frame is not put;
+	/// throws exception on timeout
+	template< typename Container >
+	bool framePut(
+		const std::vector< Container > &frame,
+		Descriptor *descriptors,
+		size_t timeout_ms,
+		const std::function< bool() > &abort )
+	{
+		std::vector< size_t > sizes( frame.size() );
+		for( size_t i = 0; i < frame.size(); i++ )
+			sizes[ i ] = frame[ i ].size() * sizeof( *frame[ i ].data() );
+
+		if( !frameReserve( sizes, descriptors, timeout_ms, abort ) )
+			return false;
+
+		// reserved space is not reused until the frame result is received: copy without lock
+		for( size_t i = 0; i < frame.size(); i++ )
+			if( sizes[ i ] > 0 )
+				std::memcpy( inputAt( descriptors[ i ].position ), frame[ i ].data(), sizes[ i ] );
+		return true;
+	}
+
+	/// Process received result packet: release inputs of the oldest outstanding frame, pass result data
+	/// to the parser, and release result space after that
+	/// \param[in] packet - result packet data: descriptor or serialized result
+	/// \param[in] size - result packet size, bytes
+	/// \param[in] parser - callable accepting result data pointer and size
+	/// \return parser return value; throws exception on malformed descriptor
+	template< typename Parser >
+	auto resultProcess( const uint8_t *packet, size_t size, Parser &&parser ) -> decltype( parser( packet, size ) )
+	{
+		Descriptor descriptor{};
+		if( !resultAccept( packet, size, descriptor ) )
+			return parser( packet, size );
+
+		struct ReleaseGuard
+		{
+			SegmentHeader *header;
+			uint64_t end;
+			~ReleaseGuard()
+			{
+				header->result_consumed.store( end, std::memory_order_release );
+			}
+		} guard{ m_header, descriptor.position + descriptor.size };
+
+		return parser( resultAt( descriptor.position ), size_t( descriptor.size ) );
+	}
+
+	/// Drop all outstanding frames: their results will never be processed
+	void reset();
+
+	/// Wake up producers waiting for space to re-check abort predicate
+	void wake();
+
+private:
+	/// Validate result packet and release inputs of the oldest outstanding frame
+	/// \param[in] packet - result packet data
+	/// \param[in] size - result packet size, bytes
+	/// \param[out] descriptor - result descriptor
+	/// \return true if the packet is descriptor, false if it is serialized result
+	bool resultAccept( const uint8_t *packet, size_t size, Descriptor &descriptor );
+
+	/// Get pointer to input ring memory at given position
+	char *inputAt( uint64_t position ) const
+	{
+		return m_base + m_header->input_offset + position % m_header->input_capacity;
+	}
+
+	/// Get pointer to result ring memory at given position
+	const uint8_t *resultAt( uint64_t position ) const
+	{
+		const char *ptr = m_base + m_header->result_offset + position % m_header->result_capacity;
+		return reinterpret_cast< const uint8_t * >( ptr );
+	}
+
+	/// Outstanding frame
+	struct Frame
+	{
+		uint64_t id;   //!< frame ID
+		uint64_t end;  //!< input ring position after the last input of the frame
+	};
+
+	int m_fd;                         //!< segment file descriptor
+	size_t m_size;                    //!< segment size, bytes
+	char *m_base;                     //!< segment mapping address
+	SegmentHeader *m_header;          //!< segment header
+	std::mutex m_mutex;               //!< mutex to protect ring state
+	std::condition_variable m_space;  //!< condition variable to wait for input ring space
+	uint64_t m_input_head;            //!< input ring position of the next block
+	uint64_t m_input_tail;            //!< input ring position of the oldest outstanding block
+	uint64_t m_next_frame_id;         //!< ID of the next frame
+	std::deque< Frame > m_frames;     //!< outstanding frames in order of sending
+};
+
+}  // namespace DG
+
+#endif  // DG_CLIENT_SHM_H_
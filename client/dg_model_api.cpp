@@ -12,9 +12,12 @@
 #include "dg_model_api.h"
 #include <asio.hpp>
 #include <future>
+#include "Utilities/dg_socket.h"
 #include "Utilities/dg_string_utilities.h"
 #include "Utilities/dg_version.h"
 #include "dg_client.h"
+#include "dg_client_mux.h"
+#include "dg_client_pool.h"
 
 //
 // Get version of the library
@@ -37,7 +40,13 @@ std::string DG::versionGet()
 //
 void DG::modelzooListGet( const std::string &server, std::vector< DG::ModelInfo > &modelzoo_list )
 {
-	DG::Client::create( server )->modelzooListGet( modelzoo_list );
+	DG::ClientPool::instance().execute(
+		server,
+		[ & ]( Client &client ) {
+			modelzoo_list.clear();  // command may be retried on new connection
+			client.modelzooListGet( modelzoo_list );
+		},
+		true );
 }
 
 //
@@ -47,7 +56,10 @@ void DG::modelzooListGet( const std::string &server, std::vector< DG::ModelInfo
 //
 DG::json DG::systemInfo( const std::string &server )
 {
-	return DG::Client::create( server )->systemInfo();
+	return DG::ClientPool::instance().execute(
+		server,
+		[]( Client &client ) { return client.systemInfo(); },
+		true );
 }
 
 //
@@ -57,7 +69,7 @@ DG::json DG::systemInfo( const std::string &server )
 //
 DG::json DG::devCtrl( const std::string &server, const json &req )
 {
-	return DG::Client::create( server )->devCtrl( req );
+	return DG::ClientPool::instance().execute( server, [ & ]( Client &client ) { return client.devCtrl( req ); } );
 }
 
 //
@@ -69,7 +81,7 @@ DG::json DG::devCtrl( const std::string &server, const json &req )
 //
 DG::json DG::traceManage( const std::string &server, const json &req )
 {
-	return DG::Client::create( server )->traceManage( req );
+	return DG::ClientPool::instance().execute( server, [ & ]( Client &client ) { return client.traceManage( req ); } );
 }
 
 //
@@ -81,7 +93,9 @@ DG::json DG::traceManage( const std::string &server, const json &req )
 //
 DG::json DG::modelZooManage( const std::string &server, const json &req )
 {
-	return DG::Client::create( server )->modelZooManage( req );
+	return DG::ClientPool::instance().execute( server, [ & ]( Client &client ) {
+		return client.modelZooManage( req );
+	} );
 }
 
 //
@@ -152,7 +166,10 @@ std::string DG::errorCheck( const json &json_response )
 // return JSON object containing model label dictionary
 DG::json DG::labelDictionary( const std::string &server, const std::string &model_name )
 {
-	return DG::Client::create( server )->labelDictionary( model_name );
+	return DG::ClientPool::instance().execute(
+		server,
+		[ & ]( Client &client ) { return client.labelDictionary( model_name ); },
+		true );
 }
 
 //
@@ -165,7 +182,11 @@ bool DG::serverPing( const std::string &server )
 {
 	try
 	{
-		return DG::Client::create( server )->ping();
+		// ping errors are thrown to let the registry retry stale connection
+		return DG::ClientPool::instance().execute(
+			server,
+			[]( Client &client ) { return client.ping( 0, false ); },
+			true );
 	}
 	catch( ... )
 	{
@@ -352,6 +373,44 @@ std::vector< std::tuple< std::string, DG::DetectionStatus > > DG::detectHostname
 	return detectServers( source );
 }
 
+//
+// Configure the process-wide shared input/output thread pool used by AI server clients.
+// [in] thread_count is the number of threads in the shared pool. Zero disables the shared pool.
+//
+void DG::sharedIoThreadPoolConfigure( size_t thread_count )
+{
+	DG::main_protocol::IoEngine::sharedConfigure( thread_count );
+}
+
+//
+// Configure the process-wide registry of idle server connections used by server management functions.
+// [in] max_idle_per_server is the max. number of idle connections kept per server. Zero disables connection reuse.
+// [in] idle_timeout_ms is the idle timeout in milliseconds: connections idle longer than that are closed.
+//
+void DG::connectionReuseConfigure( size_t max_idle_per_server, size_t idle_timeout_ms )
+{
+	DG::ClientPool::instance().configure( max_idle_per_server, idle_timeout_ms );
+}
+
+//
+// Configure the process-wide cache of server host name resolutions.
+// [in] ttl_ms is the time in milliseconds to cache successful resolutions. Zero disables caching.
+// [in] negative_ttl_ms is the time in milliseconds to cache failed resolutions. Zero disables caching.
+//
+void DG::resolverCacheConfigure( size_t ttl_ms, size_t negative_ttl_ms )
+{
+	DG::main_protocol::Resolver::instance().configure( ttl_ms, negative_ttl_ms );
+}
+
+//
+// Enable or disable multiplexing of model streams over a single connection per server.
+// [in] enable is true to enable multiplexing, false to disable it.
+//
+void DG::streamMultiplexingConfigure( bool enable )
+{
+	DG::MuxConnection::enable( enable );
+}
+
 //
 // Constructor.
 // In case of server connection errors throws std::exception.
@@ -361,14 +420,16 @@ std::vector< std::tuple< std::string, DG::DetectionStatus > > DG::detectHostname
 // [in] model_params is runtime parameters, which define model runtime behavior (optional)
 // [in] connection_timeout_ms is the AI server connection timeout in milliseconds (optional)
 // [in] inference_timeout_ms is the AI server inference timeout in milliseconds (optional)
+// [in] client_options is the collection of socket-level transport options (optional)
 //
 DG::AIModel::AIModel(
 	const std::string &server,
 	const std::string &model_name,
 	const ModelParamsReadAccess &model_params,
 	size_t connection_timeout_ms,
-	size_t inference_timeout_ms ) :
-	m_client( DG::Client::create( server, connection_timeout_ms, inference_timeout_ms ) )
+	size_t inference_timeout_ms,
+	const ClientOptions &client_options ) :
+	m_client( DG::Client::create( server, connection_timeout_ms, inference_timeout_ms, client_options ) )
 {
 	m_client->openStream( model_name, 0, model_params.jsonGet() );
 }
@@ -385,7 +446,18 @@ DG::AIModel::~AIModel()
 // [in] data is a vector of input data for each model input where each data element is a vector of bytes.
 // [out] json_response is the result of the inference
 //
-void DG::AIModel::predict( std::vector< std::vector< char > > &data, json &json_response )
+void DG::AIModel::predict( const std::vector< std::vector< char > > &data, json &json_response )
+{
+	m_client->predict( data, json_response );
+}
+
+//
+// Run the inference on provided array of byte views.
+// In case of errors throws std::exception.
+// [in] data is a vector of byte views, one view for each model input.
+// [out] json_response is the result of the inference
+//
+void DG::AIModel::predict( const std::vector< ByteView > &data, json &json_response )
 {
 	m_client->predict( data, json_response );
 }
@@ -401,6 +473,7 @@ void DG::AIModel::predict( std::vector< std::vector< char > > &data, json &json_
 // [in] frame_queue_depth is the depth of internal frame queue (optional)
 // [in] connection_timeout_ms is the AI server connection timeout in milliseconds (optional)
 // [in] inference_timeout_ms is the AI server inference timeout in milliseconds (optional)
+// [in] client_options is the collection of socket-level transport options (optional)
 //
 DG::AIModelAsync::AIModelAsync(
 	const std::string &server,
@@ -409,11 +482,16 @@ DG::AIModelAsync::AIModelAsync(
 	const ModelParamsReadAccess &model_params,
 	size_t frame_queue_depth,
 	size_t connection_timeout_ms,
-	size_t inference_timeout_ms ) :
-	m_client( DG::Client::create( server, connection_timeout_ms, inference_timeout_ms ) )
+	size_t inference_timeout_ms,
+	const ClientOptions &client_options ) :
+	m_client( DG::Client::create( server, connection_timeout_ms, inference_timeout_ms, client_options ) )
 {
 	m_client->openStream( model_name, frame_queue_depth, model_params.jsonGet() );
 	m_client->resultObserve( callback );
+
+	// the number of frames posted by tryPredict() is limited by the upper bound of the frame queue depth,
+	// which is known only after the stream is opened: zero frame_queue_depth selects the default one
+	m_polled_results.reset( frameQueueDepthStatusGet().max_depth );
 }
 
 //
@@ -441,10 +519,298 @@ void DG::AIModelAsync::setCallback( callback_t callback )
 // This is non-blocking call.
 // [in] data is a vector of input data for each model input where each data element is a vector of bytes.
 // [in] frame_info is optional frame information string to be passed to the callback along the frame result
+// [in] deadline_ms is optional frame deadline in milliseconds; 0 for no deadline
+//
+void DG::AIModelAsync::predict(
+	const std::vector< std::vector< char > > &data,
+	const std::string &frame_info,
+	size_t deadline_ms )
+{
+	m_client->dataSend( data, frame_info, deadline_ms );
+}
+
+//
+// Start the inference on given data vector taking the ownership of the frame data.
+// In case of errors throws std::exception.
+// This is non-blocking call.
+// [in] data is a vector of input data for each model input; it is moved into the client.
+// [in] frame_info is optional frame information string to be passed to the callback along the frame result
+// [in] deadline_ms is optional frame deadline in milliseconds; 0 for no deadline
+//
+void DG::AIModelAsync::predict(
+	std::vector< std::vector< char > > &&data,
+	const std::string &frame_info,
+	size_t deadline_ms )
+{
+	m_client->dataSend( std::move( data ), frame_info, deadline_ms );
+}
+
+//
+// Start the inference on given byte data vector taking the ownership of the frame data, and deliver the frame result
+// to given completion object instead of the client callback.
+// In case of errors throws std::exception.
+// This is non-blocking call.
+// [in] data is a vector of input data for each model input where each data element is a vector of bytes.
+// [in] completion is the completion object to be notified when the frame result is ready or the frame is dropped
+// [in] deadline_ms is optional frame deadline in milliseconds; 0 for no deadline
+//
+void DG::AIModelAsync::predict(
+	std::vector< std::vector< char > > &&data,
+	FrameCompletion &completion,
+	size_t deadline_ms )
+{
+	m_client->dataSend( std::move( data ), completion, deadline_ms );
+}
+
+//
+// Frame completion, which fulfills the promise of the frame result and deletes itself
+//
+class FramePromise: public DG::FrameCompletion
+{
+public:
+	// Get the future of the frame result
+	std::future< DG::json > futureGet()
+	{
+		return m_promise.get_future();
+	}
+
+	// Fulfill the promise with the frame result
+	// [in] result - frame inference result
+	void resultReady( DG::json &&result ) override
+	{
+		m_promise.set_value( std::move( result ) );
+		delete this;
+	}
+
+	// Fulfill the promise with the exception describing why the frame is dropped
+	// [in] reason - description of the reason why the frame is dropped
+	void frameDropped( const std::string &reason ) override
+	{
+		m_promise.set_exception( std::make_exception_ptr( DGException( reason, DG::ErrOperationFailed ) ) );
+		delete this;
+	}
+
+private:
+	std::promise< DG::json > m_promise;  //!< promise of the frame result
+};
+
+//
+// Start the inference on given byte data vector taking the ownership of the frame data, and get the future
+// of the frame result.
+// In case of errors throws std::exception.
+// This is non-blocking call, which is safe to make from multiple threads.
+// [in] data is a vector of input data for each model input where each data element is a vector of bytes.
+// [in] deadline_ms is optional frame deadline in milliseconds; 0 for no deadline
+// return the future of the inference result
+//
+std::future< DG::json > DG::AIModelAsync::predictAsync( std::vector< std::vector< char > > &&data, size_t deadline_ms )
+{
+	// the completion object lives until it is notified, which happens only when the frame is accepted
+	std::unique_ptr< FramePromise > completion( new FramePromise() );
+	auto ret = completion->futureGet();
+	m_client->dataSend( std::move( data ), *completion, deadline_ms );
+	completion.release();
+	return ret;
+}
+
+//
+// Start the inference on given byte data vector and get the future of the frame result.
+// In case of errors throws std::exception.
+// This is non-blocking call, which is safe to make from multiple threads.
+// [in] data is a vector of input data for each model input where each data element is a vector of bytes.
+// [in] deadline_ms is optional frame deadline in milliseconds; 0 for no deadline
+// return the future of the inference result
+//
+std::future< DG::json >
+DG::AIModelAsync::predictAsync( const std::vector< std::vector< char > > &data, size_t deadline_ms )
+{
+	return predictAsync( std::vector< std::vector< char > >( data ), deadline_ms );
+}
+
+//
+// Frame completion, which puts the frame result into the ring of polled results and deletes itself.
+// The space in the ring is reserved when the frame is posted, so putting the result never fails.
+//
+class DG::AIModelAsync::PollCompletion: public DG::FrameCompletion
+{
+public:
+	// Constructor
+	// [in] model - model object, which ring of polled results receives the frame result
+	// [in] frame_info - frame information string to be returned along the frame result
+	PollCompletion( AIModelAsync &model, const std::string &frame_info ) : m_model( model ), m_frame_info( frame_info )
+	{}
+
+	// Put the frame result into the ring of polled results
+	// [in] result - frame inference result
+	void resultReady( DG::json &&result ) override
+	{
+		m_model.m_polled_results.tryPush( PolledResult{ std::move( m_frame_info ), std::move( result ), {} } );
+		delete this;
+	}
+
+	// Put the reason why the frame is dropped into the ring of polled results
+	// [in] reason - description of the reason why the frame is dropped
+	void frameDropped( const std::string &reason ) override
+	{
+		m_model.m_polled_results.tryPush( PolledResult{ std::move( m_frame_info ), {}, reason } );
+		delete this;
+	}
+
+private:
+	AIModelAsync &m_model;     //!< model object, which ring of polled results receives the frame result
+	std::string m_frame_info;  //!< frame information string
+};
+
+//
+// Try to start the inference on given byte data vector without waiting. The frame result is retrieved
+// by pollResults().
+// In case of errors throws std::exception.
+// [in] data is a vector of input data for each model input; it is moved only when the frame is accepted
+// [in] frame_info is optional frame information string to be returned by pollResults() along the frame result
+// [in] deadline_ms is optional frame deadline in milliseconds; 0 for no deadline
+// return true if the frame is accepted, false if the frame queue is full
+//
+bool DG::AIModelAsync::tryPredict(
+	std::vector< std::vector< char > > &&data,
+	const std::string &frame_info,
+	size_t deadline_ms )
+{
+	// reserve the space for the frame result in the ring of polled results
+	if( m_polled_reserved.fetch_add( 1 ) >= m_polled_results.capacity() )
+	{
+		m_polled_reserved--;
+		return false;
+	}
+
+	// the completion object lives until it is notified, which happens only when the frame is accepted
+	std::unique_ptr< PollCompletion > completion( new PollCompletion( *this, frame_info ) );
+	bool accepted = false;
+	try
+	{
+		accepted = m_client->dataTrySend( std::move( data ), *completion, deadline_ms );
+	}
+	catch( ... )
+	{
+		m_polled_reserved--;
+		throw;
+	}
+
+	if( !accepted )
+	{
+		m_polled_reserved--;
+		return false;
+	}
+	completion.release();
+	return true;
+}
+
+//
+// Retrieve results of frames posted by tryPredict(), which are ready by now, without waiting
+// [out] results is the vector to append retrieved results to
+// [in] max_count is the maximum number of results to retrieve
+// return the number of retrieved results
+//
+size_t DG::AIModelAsync::pollResults( std::vector< PolledResult > &results, size_t max_count )
+{
+	size_t count = 0;
+	for( PolledResult *result; count < max_count && ( result = m_polled_results.front() ) != nullptr; count++ )
+	{
+		results.push_back( std::move( *result ) );
+		m_polled_results.pop();
+		m_polled_reserved--;
+	}
+	return count;
+}
+
+//
+// Start the inference on given array of byte views.
+// In case of errors throws std::exception.
+// This is non-blocking call.
+// [in] data is a vector of byte views, one view for each model input.
+// [in] frame_info is optional frame information string to be passed to the callback along the frame result
+// [in] deadline_ms is optional frame deadline in milliseconds; 0 for no deadline
+//
+void DG::AIModelAsync::predict( const std::vector< ByteView > &data, const std::string &frame_info, size_t deadline_ms )
+{
+	m_client->dataSend( data, frame_info, deadline_ms );
+}
+
+//
+// Start the inference on a frame, which data is sent to the AI server in chunks as it becomes available.
+// In case of errors throws std::exception.
+// [in] frame_info is optional frame information string to be passed to the callback along the frame result
+// [in] deadline_ms is optional frame deadline in milliseconds since the writer is opened; 0 for no deadline
+// return the frame writer object
+//
+std::unique_ptr< DG::FrameWriter > DG::AIModelAsync::predictChunked( const std::string &frame_info, size_t deadline_ms )
+{
+	return m_client->frameWriterOpen( frame_info, deadline_ms );
+}
+
+//
+// Start the inference on a frame, which data is filled in place by the caller.
+// In case of errors throws std::exception.
+// [in] input_sizes is the vector of sizes of frame inputs in bytes, one size for each model input
+// [in] frame_info is optional frame information string to be passed to the callback along the frame result
+// [in] deadline_ms is optional frame deadline in milliseconds since the slot is reserved; 0 for no deadline
+// return the frame slot object
+//
+std::unique_ptr< DG::FrameSlot > DG::AIModelAsync::predictSlot(
+	const std::vector< size_t > &input_sizes,
+	const std::string &frame_info,
+	size_t deadline_ms )
+{
+	return m_client->frameSlotReserve( input_sizes, frame_info, deadline_ms );
+}
+
+//
+// Start the inference on given batch of frames.
+// In case of errors throws std::exception.
+// [in] frames is a vector of frames, where each frame is a vector of input data for each model input.
+// [in] frame_infos is an optional vector of frame information strings, one string per frame.
+// [in] deadline_ms is optional deadline of each frame in milliseconds; 0 for no deadline
+//
+void DG::AIModelAsync::predictBatch(
+	const std::vector< std::vector< std::vector< char > > > &frames,
+	const std::vector< std::string > &frame_infos,
+	size_t deadline_ms )
+{
+	std::vector< std::vector< ByteView > > views;
+	views.reserve( frames.size() );
+	for( const auto &frame : frames )
+		views.push_back( byteViewsGet( frame ) );
+	m_client->dataSendBatch( views, frame_infos, deadline_ms );
+}
+
 //
-void DG::AIModelAsync::predict( std::vector< std::vector< char > > &data, const std::string &frame_info )
+// Start the inference on given batch of frames taking the ownership of the frames data.
+// In case of errors throws std::exception.
+// [in] frames is a vector of frames, where each frame is a vector of input data for each model input;
+// it is moved into the client.
+// [in] frame_infos is an optional vector of frame information strings, one string per frame.
+// [in] deadline_ms is optional deadline of each frame in milliseconds; 0 for no deadline
+//
+void DG::AIModelAsync::predictBatch(
+	std::vector< std::vector< std::vector< char > > > &&frames,
+	const std::vector< std::string > &frame_infos,
+	size_t deadline_ms )
+{
+	m_client->dataSendBatch( std::move( frames ), frame_infos, deadline_ms );
+}
+
+//
+// Start the inference on given batch of frames, where each frame is an array of byte views.
+// In case of errors throws std::exception.
+// [in] frames is a vector of frames, where each frame is a vector of byte views, one view for each model input.
+// [in] frame_infos is an optional vector of frame information strings, one string per frame.
+// [in] deadline_ms is optional deadline of each frame in milliseconds; 0 for no deadline
+//
+void DG::AIModelAsync::predictBatch(
+	const std::vector< std::vector< ByteView > > &frames,
+	const std::vector< std::string > &frame_infos,
+	size_t deadline_ms )
 {
-	m_client->dataSend( data, frame_info );
+	m_client->dataSendBatch( frames, frame_infos, deadline_ms );
 }
 
 //
@@ -467,6 +833,99 @@ int DG::AIModelAsync::outstandingResultsCountGet() const
 	return m_client->outstandingResultsCountGet();
 }
 
+//
+// Enable or disable adaptive frame queue depth.
+// [in] min_depth is the lower bound of the frame queue depth
+// [in] max_depth is the upper bound of the frame queue depth; when it is not greater than min_depth,
+// adaptive mode is disabled
+//
+void DG::AIModelAsync::frameQueueDepthRangeSet( size_t min_depth, size_t max_depth )
+{
+	// results of frames posted by tryPredict() would be lost when the ring of polled results is reallocated
+	if( m_polled_reserved > 0 )
+		DG_ERROR(
+			"frameQueueDepthRangeSet: frame queue depth cannot be changed while results of frames posted by "
+			"tryPredict() are not polled",
+			ErrIncorrectAPIUse );
+
+	m_client->frameQueueDepthRangeSet( min_depth, max_depth );
+
+	// the number of frames posted by tryPredict() is limited by the upper bound of the frame queue depth
+	const size_t polled_capacity = frameQueueDepthStatusGet().max_depth;
+	if( polled_capacity != m_polled_results.capacity() )
+		m_polled_results.reset( polled_capacity );
+}
+
+//
+// Get the frame queue depth status
+//
+DG::FrameQueueDepthStatus DG::AIModelAsync::frameQueueDepthStatusGet() const
+{
+	return m_client->frameQueueDepthStatusGet();
+}
+
+//
+// Get the number of frames in flight for predictRange(): by default the whole frame queue is filled,
+// or its upper bound in adaptive mode
+// [in] frames_in_flight is the requested number of frames in flight; 0 to use the default
+// return the number of frames in flight
+//
+size_t DG::AIModelAsync::framesInFlightGet( size_t frames_in_flight ) const
+{
+	if( frames_in_flight != 0 )
+		return frames_in_flight;
+	const FrameQueueDepthStatus status = frameQueueDepthStatusGet();
+	return status.adaptive ? status.max_depth : status.depth;
+}
+
+//
+// Set the limit of the total size of the data of outstanding frames
+// [in] max_bytes is the limit in bytes; 0 to disable the limit
+//
+void DG::AIModelAsync::frameQueueBytesLimitSet( size_t max_bytes )
+{
+	m_client->frameQueueBytesLimitSet( max_bytes );
+}
+
+//
+// Set the policy of handling new frames when the frame queue is full
+// [in] policy is the frame overflow policy
+//
+void DG::AIModelAsync::frameOverflowPolicySet( FrameOverflowPolicy policy )
+{
+	m_client->frameOverflowPolicySet( policy );
+}
+
+//
+// Get the number of frames dropped according to the frame overflow policy
+//
+size_t DG::AIModelAsync::droppedFramesCountGet() const
+{
+	return m_client->droppedFramesCountGet();
+}
+
+
+//
+// Get the number of frames dropped or discarded due to passed deadlines
+//
+size_t DG::AIModelAsync::expiredFramesCountGet() const
+{
+	return m_client->expiredFramesCountGet();
+}
+
+//
+// Set which threads call the user callback
+// [in] mode is the callback execution mode
+// [in] thread_count is the number of threads for CallbackExecution::Pool mode; 0 for the number of CPU cores
+// [in] ordered is the flag to call the user callback in the order of frames in CallbackExecution::Pool mode
+// [in] postprocess is the optional post-processing callback, which is called for each result before the user callback
+//
+void DG::AIModelAsync::callbackExecutionSet(
+	CallbackExecution mode, size_t thread_count, bool ordered, postprocess_t postprocess )
+{
+	m_client->callbackExecutionSet( mode, thread_count, ordered, postprocess );
+}
+
 //
 // If ever during consecutive calls to predict() methods server reported run-time error, then
 // this method will return error message string, otherwise it returns empty string.
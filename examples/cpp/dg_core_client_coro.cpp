@@ -0,0 +1,151 @@
+//////////////////////////////////////////////////////////////////////
+/// \file dg_core_client_coro.cpp
+/// \brief DG Core client command line utility with C++20 coroutines
+///
+/// Copyright 2023 DeGirum Corporation
+///
+/// This file contains implementation of AI client command line utility,
+/// which uses the awaitable inference API: each input frame is processed
+/// by its own coroutine, which awaits the inference result by
+/// `co_await model.infer( ... )`. All coroutines are started at once,
+/// so their frames are pipelined over the single connection to AI server.
+/// Requires C++20 coroutine support.
+///
+/// Usage: dg_core_client_coro --ip {server address} --model {model name} {frame file 1} .. {frame file N}
+///
+
+#include <future>
+#include <iostream>
+#include <mutex>
+#include "DglibInterface/dg_model_api.h"
+#include "Utilities/dg_cmdline_parser.h"
+#include "Utilities/dg_file_utilities.h"
+
+#ifndef DG_HAS_COROUTINES
+	#error "This example requires C++20 coroutine support"
+#endif
+
+// Command line arguments
+#define CMD_IPADDR		"ip"		//!< server IP address
+#define CMD_MODEL		"model"		//!< name of ML model to run
+
+/// Coroutine, which starts right away and lets the caller wait for its completion by the future
+struct Task
+{
+	/// Coroutine promise
+	struct promise_type
+	{
+		std::promise< void > done;  //!< completion of the coroutine
+
+		Task get_return_object()
+		{
+			return Task{ done.get_future() };
+		}
+
+		std::suspend_never initial_suspend() noexcept
+		{
+			return {};
+		}
+
+		std::suspend_never final_suspend() noexcept
+		{
+			return {};
+		}
+
+		void return_void()
+		{
+			done.set_value();
+		}
+
+		void unhandled_exception()
+		{
+			done.set_exception( std::current_exception() );
+		}
+	};
+
+	std::future< void > completion;  //!< future, which is ready when the coroutine is finished
+};
+
+/// Run the inference on the given file and print its result
+/// \param[in] model - model to run the inference
+/// \param[in] file - path of the input file; should stay alive until the coroutine is finished
+/// \param[in] out_mutex - mutex to serialize printing of results
+static Task fileInfer( DG::AIModelAsync &model, const std::string &file, std::mutex &out_mutex )
+{
+	std::vector< std::vector< char > > frame = { DG::FileHelper::file2vector< char >( file ) };
+
+	// the coroutine is resumed in the thread, which receives inference results
+	const DG::json result = co_await model.infer( std::move( frame ) );
+
+	std::lock_guard< std::mutex > lock( out_mutex );
+	std::cout << file << "\n\n" << result.dump() << "\n";
+}
+
+/// Main entry point
+int main( int argc, char **argv )
+{
+	// parse command line
+	DG::InputParser cmd_args( argc, argv );
+
+	//
+	// handle --help command
+	//
+	if( cmd_args.cmdOptionExists( "help" ) || cmd_args.cmdOptionExists( "h" ) )
+	{
+		std::cout <<
+			"\nPerform inference tasks on remote DG Core server using C++20 coroutines\n\n"
+			"Parameters:\n"
+			"  -" CMD_IPADDR " <IP address:port> - IP address of the server to work with (default 127.0.0.1)\n"
+			"  -" CMD_MODEL " <model name> - name of ML model from model zoo to run\n"
+			"  <files> - space-separated list of files to run inference on\n\n";
+		return 0;
+	}
+
+	try
+	{
+		// extract command line arguments
+		const std::string server_ip = cmd_args.getCmdOption( CMD_IPADDR, "127.0.0.1" );
+		const std::string model_name = cmd_args.getCmdOption( CMD_MODEL, "" );
+		const std::vector< std::string > files = cmd_args.getNonOptions();
+
+		// validate parameters
+		if( model_name == "" )
+			throw std::runtime_error( "Model name is not specified" );
+
+		if( files.size() == 0 )
+			throw std::runtime_error( "No input files specified" );
+
+		// find model in the model zoo by model name substring
+		auto model_id = DG::modelFind( server_ip, { model_name } );
+		if( model_id.name.empty() )
+			throw std::runtime_error( "Model '" + model_name + "' is not found in model zoo" );
+
+		std::cout <<
+			"\n\nRunning inference\n"
+			"  Server: " << server_ip << "\n"
+			"  Model: " << model_id.name << "\n";
+
+		// create AI model instance: no callback is needed, since each coroutine gets its own result
+		DG::AIModelAsync model( server_ip, model_id.name, nullptr );
+
+		// start one coroutine per file, then wait until all of them are finished
+		std::mutex out_mutex;
+		std::vector< Task > tasks;
+		for( const auto &file : files )
+			tasks.push_back( fileInfer( model, file, out_mutex ) );
+		for( auto &task : tasks )
+			task.completion.get();
+	}
+	catch( std::exception &e )
+	{
+		std::cout << e.what() << "\n";
+		return -1;
+	}
+	catch( ... )
+	{
+		std::cout << "Unhandled exception\n";
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,191 @@
+//////////////////////////////////////////////////////////////////////
+/// \file dg_core_client_slot.cpp
+/// \brief DG Core client command line utility with in-place frame filling
+///
+/// Copyright 2023 DeGirum Corporation
+///
+/// This file contains implementation of AI client command line utility, which
+/// runs the AI inference using the asynchronous API, filling frame data in place.
+/// For AI servers connected over shared memory transport (server address
+/// "shm://{socket path}") the frame data is read from files directly into the
+/// shared memory segment, so it is never copied.
+///
+/// The utility performs the following tasks:
+///
+/// 1. Run the AI inference of the given model on given list of input frames, reading each file
+///    into the space reserved by AIModelAsync::predictSlot()
+///    Usage: dg_core_client_slot --ip {server address} --model {model name} --out {result file} {frame file 1} .. {frame file N}
+/// 2. Optionally, post the files repeated given number of times as single batch by AIModelAsync::predictBatch().
+///    With small shared memory input buffer the batch does not fit into it, so the batch frames are sent while
+///    results of its first frames are received.
+///    Usage: dg_core_client_slot --ip shm://{socket path} --model echo --shm_input_size 65536 --batch 100 {files}
+///    It can be run against stand-in AI server peer: dg_shm_peer --path {socket path}
+///
+/// The utility exits with error code, if any result is missing or any error is detected during inference.
+///
+
+#include <atomic>
+#include <iostream>
+#include <fstream>
+#include "DglibInterface/dg_model_api.h"
+#include "client/dg_client.h"
+#include "Utilities/dg_cmdline_parser.h"
+#include "Utilities/dg_file_utilities.h"
+
+// Command line arguments
+#define CMD_IPADDR		"ip"				//!< server IP address
+#define CMD_MODEL		"model"				//!< name of ML model to run
+#define CMD_OUT			"out"				//!< name of output file
+#define CMD_BATCH		"batch"				//!< number of times to repeat files in the batch
+#define CMD_SHM_INPUT	"shm_input_size"	//!< size of shared memory buffer for inputs
+
+/// Main entry point
+int main( int argc, char **argv )
+{
+	// parse command line
+	DG::InputParser cmd_args( argc, argv );
+
+	//
+	// handle --help command
+	//
+	if( cmd_args.cmdOptionExists( "help" ) || cmd_args.cmdOptionExists( "h" ) )
+	{
+		std::cout <<
+			"\nPerform inference tasks on DG Core server filling frame data in place\n\n"
+			"Parameters:\n"
+			"  -" CMD_IPADDR " <server address> - address of the server to work with (default 127.0.0.1)\n"
+			"  -" CMD_MODEL " <model name> - name of ML model from model zoo to run\n"
+			"  -" CMD_OUT " <output file> - name of output file to save results (default - print to console)\n"
+			"  -" CMD_BATCH " <count> - post files repeated given number of times as single batch (default 0)\n"
+			"  -" CMD_SHM_INPUT " <bytes> - size of shared memory buffer for inputs (default 64 MB)\n"
+			"  <files> - space-separated list of files to run inference on\n\n";
+		return 0;
+	}
+
+	try
+	{
+		// extract command line arguments
+		const std::string server_ip = cmd_args.getCmdOption( CMD_IPADDR, "127.0.0.1" );
+		const std::string model_name = cmd_args.getCmdOption( CMD_MODEL, "" );
+		const std::string out_file = cmd_args.getCmdOption( CMD_OUT, "" );
+		const size_t batch_repeat = std::stoul( cmd_args.getCmdOption( CMD_BATCH, "0" ) );
+		const std::vector< std::string > files = cmd_args.getNonOptions();
+
+		DG::ClientOptions client_options;
+		client_options.shared_memory_input_size = std::stoul( cmd_args.getCmdOption( CMD_SHM_INPUT, "0" ) );
+
+		// validate parameters
+		if( model_name == "" )
+			throw std::runtime_error( "Model name is not specified" );
+
+		if( files.size() == 0 )
+			throw std::runtime_error( "No input files specified" );
+
+		// find model in the model zoo by model name substring
+		auto model_id = DG::modelFind( server_ip, { model_name } );
+		if( model_id.name.empty() )
+			throw std::runtime_error( "Model '" + model_name + "' is not found in model zoo" );
+
+		//
+		// define user callback, which will handle inference results;
+		// batch frames are only counted
+		//
+		std::atomic< size_t > result_count{ 0 };
+		auto callback = [ out_file, files, &result_count ](
+							const DG::json &inference_result,
+							const std::string &frame_info ) {
+			result_count++;
+			if( frame_info.empty() )
+				return;
+
+			int response_index = std::stoi( frame_info );
+			std::string response_string = inference_result.dump();
+
+			if( out_file == "" )
+				std::cout << files[ response_index ] << "\n\n" << response_string << "\n";
+			else
+				std::ofstream( out_file, std::ios_base::out | ( response_index == 0 ? std::ios_base::trunc : std::ios_base::app ) )
+					.write( response_string.c_str(), response_string.size() );
+		};
+
+		//
+		// handle 'run inference' command
+		//
+		std::cout <<
+			"\n\nRunning inference\n"
+			"  Server: " << server_ip << "\n"
+			"  Model: " << model_id.name << "\n";
+
+		// create AI model instance: use async. client
+		DG::AIModelAsync model(
+			server_ip,
+			model_id.name,
+			callback,
+			DG::ModelParamsReadAccess( {} ),
+			DG::DEFAULT_FRAME_QUEUE_DEPTH,
+			DG::DEFAULT_CONNECTION_TIMEOUT_MS,
+			DG::DEFAULT_INFERENCE_TIMEOUT_MS,
+			client_options );
+
+		// iterate over all input files
+		for( size_t fi = 0; fi < files.size(); fi++ )
+		{
+			std::cout << "File: " << files[ fi ] << "...\n";
+
+			std::ifstream fin( files[ fi ], std::ios_base::in | std::ios_base::binary | std::ios_base::ate );
+			if( fin.fail() )
+				throw std::runtime_error( "Error reading file " + files[ fi ] );
+			const size_t file_size = size_t( fin.tellg() );
+			fin.seekg( 0, fin.beg );
+
+			// send frame for inference: the file is read directly into the space reserved for the frame,
+			// which is located in shared memory for servers connected over shared memory transport;
+			// for demo purpose the file index is sent as the frame info
+			auto slot = model.predictSlot( { file_size }, std::to_string( fi ) );
+			if( !fin.read( static_cast< char * >( slot->inputDataGet( 0 ) ), file_size ) )
+				throw std::runtime_error( "Error reading file " + files[ fi ] );
+			slot->commit();
+		}
+
+		// post the files repeated given number of times as single batch; frames refer to file data loaded once
+		size_t batch_size = 0;
+		if( batch_repeat > 0 )
+		{
+			std::vector< std::vector< char > > file_data;
+			for( const auto &file : files )
+				file_data.push_back( DG::FileHelper::file2vector< char >( file ) );
+
+			std::vector< std::vector< DG::ByteView > > batch;
+			for( size_t ri = 0; ri < batch_repeat; ri++ )
+				for( const auto &data : file_data )
+					batch.push_back( { DG::ByteView( data ) } );
+
+			batch_size = batch.size();
+			std::cout << "Batch of " << batch_size << " frames...\n";
+			model.predictBatch( batch );
+		}
+
+		// wait for completion and check that all results are received
+		model.waitCompletion();
+
+		if( !model.lastError().empty() )
+			throw std::runtime_error( "Error detected during inference:\n" + model.lastError() );
+
+		const size_t expected_count = files.size() + batch_size;
+		std::cout << result_count << " of " << expected_count << " results received\n";
+		if( result_count != expected_count )
+			return -1;
+	}
+	catch( std::exception &e )
+	{
+		std::cout << e.what() << "\n";
+		return -1;
+	}
+	catch( ... )
+	{
+		std::cout << "Unhandled exception\n";
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,309 @@
+//////////////////////////////////////////////////////////////////////
+/// \file dg_shm_peer.cpp
+/// \brief Stand-in AI server peer for shared memory transport
+///
+/// Copyright 2023 DeGirum Corporation
+///
+/// This file contains implementation of stand-in AI server peer, which serves
+/// clients connected by "shm://{socket path}" server address. It allows exercising
+/// shared memory transport of AI client (DG::SharedMemoryChannel) without real AI server.
+///
+/// The peer listens on Unix domain socket and serves each connection in separate thread:
+///
+/// 1. Service commands (ping, model zoo list, system info, label dictionary, shutdown) are answered
+///    with protocol version 7; model zoo contains single model named "echo".
+/// 2. For "stream" command the peer receives file descriptor of shared memory segment passed right after
+///    the command, maps the segment described by "shm" field of the command, reads frame input descriptors from the stream socket, and for each frame writes result into
+///    the result ring of the segment, waiting until the client consumes enough space, and sends
+///    result descriptor back. The result echoes input descriptors along with checksums of input data.
+///
+/// Usage: dg_shm_peer --path {socket path} [--inputs {number of inputs per frame}]
+/// Then run client, for example: dg_core_client_slot --ip shm://{socket path} --model echo {files}
+///
+
+#include <cerrno>
+#include <iostream>
+#include <thread>
+#include "client/dg_client_shm.h"
+#include "Utilities/dg_cmdline_parser.h"
+#include "Utilities/dg_json_helpers.h"
+#include "Utilities/dg_socket.h"
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Command line arguments
+#define CMD_PATH		"path"		//!< Unix domain socket path
+#define CMD_INPUTS		"inputs"	//!< number of inputs per frame
+
+using SharedMemoryChannel = DG::SharedMemoryChannel;
+
+/// Name of the model served by the peer
+static const char *MODEL_NAME = "echo";
+
+/// Shutdown request flag
+static std::atomic_bool g_shutdown{ false };
+
+/// Mapped shared memory segment of the stream
+class SegmentMapping
+{
+public:
+	/// Constructor. Maps shared memory segment described by "shm" field of "stream" command.
+	/// \param[in] config - segment description: size and layout version
+	/// \param[in] fd - segment file descriptor received from the client; closed by the constructor
+	SegmentMapping( const DG::json &config, int fd ) : m_size( 0 ), m_base( nullptr )
+	{
+		void *base = MAP_FAILED;
+		try
+		{
+			if( config.at( "version" ).get< uint32_t >() != SharedMemoryChannel::LAYOUT_VERSION )
+				throw std::runtime_error( "Unsupported shared memory layout version" );
+			m_size = config.at( "size" ).get< size_t >();
+			base = ::mmap( nullptr, m_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0 );
+			if( base == MAP_FAILED )
+				throw std::runtime_error( std::string( "Cannot map shared memory segment: " ) + std::strerror( errno ) );
+		}
+		catch( ... )
+		{
+			::close( fd );
+			throw;
+		}
+		// the mapping keeps the segment alive
+		::close( fd );
+		m_base = static_cast< char * >( base );
+
+		if( header()->magic != SharedMemoryChannel::SEGMENT_MAGIC )
+		{
+			::munmap( m_base, m_size );
+			throw std::runtime_error( "Shared memory segment is not a stream segment" );
+		}
+	}
+
+	SegmentMapping( const SegmentMapping & ) = delete;
+	SegmentMapping &operator=( const SegmentMapping & ) = delete;
+
+	/// Destructor. Unmaps the segment; the segment is freed when the client unmaps it as well.
+	~SegmentMapping()
+	{
+		::munmap( m_base, m_size );
+	}
+
+	/// Get segment header
+	SharedMemoryChannel::SegmentHeader *header() const
+	{
+		return reinterpret_cast< SharedMemoryChannel::SegmentHeader * >( m_base );
+	}
+
+	/// Get pointer to the block of the input ring described by given descriptor
+	/// \param[in] descriptor - input descriptor received from the client
+	const uint8_t *inputAt( const SharedMemoryChannel::Descriptor &descriptor ) const
+	{
+		const auto h = header();
+		if( descriptor.size > h->input_capacity ||
+			descriptor.position % h->input_capacity + descriptor.size > h->input_capacity )
+			throw std::runtime_error( "Malformed input descriptor" );
+		return reinterpret_cast< const uint8_t * >(
+			m_base + h->input_offset + descriptor.position % h->input_capacity );
+	}
+
+	/// Put result into the result ring, waiting until the client consumes enough space
+	/// \param[in] result - serialized result
+	/// \param[in] position - ring position after the previous result; advanced past this result
+	/// \return ring position of the result
+	uint64_t resultPut( const std::vector< uint8_t > &result, uint64_t &position ) const
+	{
+		const auto h = header();
+		const uint64_t capacity = h->result_capacity;
+		if( result.size() > capacity )
+			throw std::runtime_error( "Result does not fit into shared memory result ring" );
+
+		// the same placement as for inputs: aligned and not wrapping over the ring end
+		uint64_t start = ( position + SharedMemoryChannel::ALIGNMENT - 1 ) / SharedMemoryChannel::ALIGNMENT *
+						 SharedMemoryChannel::ALIGNMENT;
+		if( start % capacity + result.size() > capacity )
+			start += capacity - start % capacity;
+		while( start + result.size() - h->result_consumed.load( std::memory_order_acquire ) > capacity )
+			std::this_thread::sleep_for( std::chrono::microseconds( 100 ) );
+
+		std::memcpy( m_base + h->result_offset + start % capacity, result.data(), result.size() );
+		position = start + result.size();
+		return start;
+	}
+
+private:
+	size_t m_size;  //!< segment size, bytes
+	char *m_base;   //!< segment mapping address
+};
+
+/// Send serialized result object as result packet
+/// \param[in] socket - stream socket
+/// \param[in] result - result object
+static void resultSend( DG::main_protocol::socket_t &socket, const DG::json &result )
+{
+	const std::string packet = DG::JsonHelper::jsonSerializeStr( result );
+	DG::main_protocol::write( socket, packet.data(), packet.size() );
+}
+
+/// Serve "stream" command: echo descriptors of frame inputs through the result ring until the stream ends
+/// \param[in] socket - stream socket
+/// \param[in] request - "stream" command
+/// \param[in] input_count - number of inputs per frame
+static void streamServe( DG::main_protocol::socket_t &socket, const DG::json &request, size_t input_count )
+{
+	std::unique_ptr< SegmentMapping > segment;
+	std::string error;
+	try
+	{
+		if( !request.contains( "shm" ) )
+			throw std::runtime_error( "Stream is not opened with shared memory transport" );
+		const int fd = DG::main_protocol::descriptor_receive( socket );
+		segment = std::make_unique< SegmentMapping >( request[ "shm" ], fd );
+	}
+	catch( std::exception &e )
+	{
+		error = e.what();
+	}
+
+	uint64_t result_position = 0;
+	std::vector< char > packet;
+	for( ;; )
+	{
+		DG::json inputs = DG::json::array();
+		uint64_t frame_id = 0;
+		for( size_t i = 0; i < input_count; i++ )
+		{
+			// empty packet in place of the first input ends the stream; inputs of failed stream are just counted
+			if( DG::main_protocol::read( socket, packet, true ) == 0 && i == 0 )
+				return;
+			if( segment == nullptr )
+				continue;
+
+			SharedMemoryChannel::Descriptor descriptor{};
+			if( packet.size() == sizeof( descriptor ) )
+				std::memcpy( &descriptor, packet.data(), sizeof( descriptor ) );
+			if( descriptor.magic != SharedMemoryChannel::DESCRIPTOR_MAGIC )
+				throw std::runtime_error( "Malformed input descriptor" );
+			frame_id = descriptor.frame_id;
+
+			// inputs are not accessed after the result is sent: the client reuses their space then
+			const uint8_t *data = segment->inputAt( descriptor );
+			uint32_t checksum = 0;
+			for( uint64_t b = 0; b < descriptor.size; b++ )
+				checksum += data[ b ];
+			inputs.push_back(
+				{ { "position", descriptor.position }, { "size", descriptor.size }, { "checksum", checksum } } );
+		}
+
+		// early errors are reported by serialized result itself
+		if( segment == nullptr )
+		{
+			resultSend( socket, { { "success", false }, { "msg", error } } );
+			continue;
+		}
+
+		const auto result = DG::JsonHelper::jsonSerialize( { { "frame_id", frame_id }, { "inputs", inputs } } );
+		const uint64_t position = segment->resultPut( result, result_position );
+		const SharedMemoryChannel::Descriptor descriptor{
+			SharedMemoryChannel::DESCRIPTOR_MAGIC,
+			0,
+			frame_id,
+			position,
+			result.size() };
+		DG::main_protocol::write( socket, reinterpret_cast< const char * >( &descriptor ), sizeof( descriptor ) );
+	}
+}
+
+/// Serve client connection: service commands or single stream
+/// \param[in] socket - connected socket
+/// \param[in] input_count - number of inputs per frame
+static void connectionServe( DG::main_protocol::socket_t socket, size_t input_count )
+{
+	try
+	{
+		std::vector< char > packet;
+		while( DG::main_protocol::read( socket, packet, true ) > 0 )
+		{
+			const DG::json request = DG::json::parse( packet );
+			const std::string op = request.value( "op", "" );
+			if( op == DG::main_protocol::commands::STREAM )
+				return streamServe( socket, request, input_count );
+
+			DG::json response = { { op, DG::json::object() } };
+			if( op == DG::main_protocol::commands::SLEEP )
+				std::this_thread::sleep_for(
+					std::chrono::duration< double, std::milli >( request.value( "sleep_time_ms", 0.0 ) ) );
+			else if( op == DG::main_protocol::commands::MODEL_ZOO )
+				response[ op ] = { { { "name", MODEL_NAME }, { "ModelParams", "{}" } } };
+			else if( op == DG::main_protocol::commands::SHUTDOWN )
+				g_shutdown = true;
+			else if( op != DG::main_protocol::commands::SYSTEM_INFO && op != DG::main_protocol::commands::LABEL_DICT )
+				response = { { "success", false }, { "msg", "Command '" + op + "' is not supported by the peer" } };
+
+			const std::string reply = DG::messagePrepare( response );
+			DG::main_protocol::write( socket, reply.data(), reply.size() );
+		}
+	}
+	catch( std::exception &e )
+	{
+		std::cout << "Connection error: " << e.what() << std::endl;
+	}
+}
+
+/// Main entry point
+int main( int argc, char **argv )
+{
+	// parse command line
+	DG::InputParser cmd_args( argc, argv );
+
+	//
+	// handle --help command
+	//
+	if( cmd_args.cmdOptionExists( "help" ) || cmd_args.cmdOptionExists( "h" ) )
+	{
+		std::cout <<
+			"\nStand-in AI server peer for shared memory transport\n\n"
+			"Parameters:\n"
+			"  -" CMD_PATH " <socket path> - path of Unix domain socket to listen on (default /tmp/dg_shm_peer.sock)\n"
+			"  -" CMD_INPUTS " <count> - number of inputs per frame (default 1)\n\n";
+		return 0;
+	}
+
+	try
+	{
+		// extract command line arguments
+		const std::string path = cmd_args.getCmdOption( CMD_PATH, "/tmp/dg_shm_peer.sock" );
+		const size_t input_count = std::stoul( cmd_args.getCmdOption( CMD_INPUTS, "1" ) );
+		if( input_count == 0 )
+			throw std::runtime_error( "Number of inputs per frame should be positive" );
+
+		asio::io_context io_context;
+		::unlink( path.c_str() );
+		asio::basic_socket_acceptor< asio::generic::stream_protocol > acceptor(
+			io_context,
+			asio::generic::stream_protocol::endpoint( asio::local::stream_protocol::endpoint( path ) ) );
+
+		std::cout << "Listening on shm://" << path << std::endl;
+
+		for( ;; )
+		{
+			DG::main_protocol::socket_t socket( io_context );
+			acceptor.accept( socket );
+
+			// client sends empty packet over new connection after shutdown command to push the peer out of this loop
+			if( g_shutdown )
+			{
+				connectionServe( std::move( socket ), input_count );
+				break;
+			}
+			std::thread( connectionServe, std::move( socket ), input_count ).detach();
+		}
+		::unlink( path.c_str() );
+	}
+	catch( std::exception &e )
+	{
+		std::cout << e.what() << "\n";
+		return -1;
+	}
+
+	return 0;
+}
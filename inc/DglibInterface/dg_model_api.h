@@ -21,14 +21,26 @@
 #ifndef DG_AI_MODEL_API_H
 #define DG_AI_MODEL_API_H
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
+#include <deque>
 #include <functional>
+#include <future>
+#include <iterator>
 #include <map>
 #include <memory>
 #include <set>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include "Utilities/dg_client_structs.h"
+#include "Utilities/dg_frame_ring.h"
+
+#if defined( __cpp_impl_coroutine ) && __has_include( <coroutine> )
+	#include <coroutine>
+	#define DG_HAS_COROUTINES  //!< awaitable inference API is available
+#endif
 
 #ifdef FRAMEWORK_PATH
 	#define DG_CLIENT_BUILD  // to use only client-side model parameters in dg_model_parameters.h
@@ -167,6 +179,42 @@ std::vector< std::tuple< std::string, DG::DetectionStatus > > detectHostnameServ
 	const int range_end,
 	const int numeral_width = 3 );
 
+/// Configure the process-wide shared input/output thread pool used by AI server clients.
+/// By default each AIModelAsync instance, which works with AI server using the proprietary TCP protocol, runs its own
+/// result receiving thread, so the number of threads grows with the number of inference streams.
+/// When the shared pool is enabled, all AIModel and AIModelAsync instances created after this call perform
+/// socket input/output using the fixed pool of threads, and client callbacks are invoked from these threads.
+/// Instances created before this call are not affected.
+/// \param[in] thread_count is the number of threads in the shared pool. Zero disables the shared pool.
+void sharedIoThreadPoolConfigure( size_t thread_count );
+
+/// Configure the process-wide registry of idle server connections used by server management functions.
+/// Functions like modelzooListGet(), systemInfo(), labelDictionary(), serverPing(), and modelFind() keep their
+/// server connections open after the call completes, so the next call to the same server reuses the connection
+/// instead of connecting again. Connections, which stay idle longer than the idle timeout, are closed.
+/// By default up to 4 idle connections are kept per server for 30 seconds.
+/// \param[in] max_idle_per_server is the maximum number of idle connections kept per server. Zero disables
+/// connection reuse.
+/// \param[in] idle_timeout_ms is the idle timeout in milliseconds.
+void connectionReuseConfigure( size_t max_idle_per_server, size_t idle_timeout_ms );
+
+/// Configure the process-wide cache of server host name resolutions.
+/// Server host names are resolved once and cached, so connecting to the same server again does not query the
+/// system resolver. Failed resolutions are cached as well, for a shorter time. Host name resolution time counts
+/// toward the connection timeout. By default successful resolutions are cached for 60 seconds, and failed ones
+/// for 1 second. Cached resolutions are dropped by this call.
+/// \param[in] ttl_ms is the time in milliseconds to cache successful resolutions. Zero disables caching.
+/// \param[in] negative_ttl_ms is the time in milliseconds to cache failed resolutions. Zero disables caching.
+void resolverCacheConfigure( size_t ttl_ms, size_t negative_ttl_ms );
+
+/// Enable or disable multiplexing of model streams over a single connection per server.
+/// When enabled, all models created afterwards, which use the proprietary TCP protocol, share one connection
+/// to each AI server instead of opening a connection per model. Each frame carries the stream ID, and
+/// results are passed to the model which sent the frame. The AI server should support protocol version 5
+/// or newer, otherwise model creation fails. Multiplexing is disabled by default.
+/// \param[in] enable is true to enable multiplexing, false to disable it.
+void streamMultiplexingConfigure( bool enable );
+
 class Client;  // forward declaration
 
 /// \brief AIModel is DeGirum AI client API class for simple non-pipelined sequential inference.
@@ -189,6 +237,9 @@ public:
 	/// In case of server connection errors throws std::exception.
 	/// \param[in] server is a string specifying server domain name/IP address and port.
 	/// Format: "domain_name:port" or "xxx.xxx.xxx.xxx:port". If port is omitted, the default port is 8778.
+	/// AI server running on the same host can be accessed over Unix domain socket: "unix://" prefix followed by
+	/// the socket file path, for example "unix:///run/aiserver.sock". With "shm://" prefix instead, frames and results
+	/// are passed in shared memory, and only their descriptors are sent over the socket.
 	/// \param[in] model_name specifies the AI model to be used for inference.
 	/// To obtain valid model name, either modelFind() or modelzooListGet() functions should be used.
 	/// \param[in] model_params is runtime parameter collection, which defines the model runtime behavior.
@@ -199,12 +250,15 @@ public:
 	/// This is optional parameter: by default it is set to 10 sec.
 	/// \param[in] inference_timeout_ms is the AI server inference timeout in milliseconds.
 	/// This is optional parameter: by default it is set to 180 sec.
+	/// \param[in] client_options is the collection of socket-level transport options, such as socket buffer sizes,
+	/// applied to all connections to the AI server. This is optional parameter: by default system defaults are used.
 	explicit AIModel(
 		const std::string &server,
 		const std::string &model_name,
 		const ModelParamsReadAccess &model_params = ModelParamsReadAccess( {} ),
 		size_t connection_timeout_ms = DEFAULT_CONNECTION_TIMEOUT_MS,
-		size_t inference_timeout_ms = DEFAULT_INFERENCE_TIMEOUT_MS );
+		size_t inference_timeout_ms = DEFAULT_INFERENCE_TIMEOUT_MS,
+		const ClientOptions &client_options = ClientOptions() );
 
 	// Deleted copy constructor and copy assignment operator
 	AIModel( const AIModel & ) = delete;
@@ -220,7 +274,16 @@ public:
 	/// \param[in] data is a vector of input data for each model input where each data element is a vector of bytes.
 	/// \param[out] json_response is the result of the inference. The response format depends on the model
 	/// post-processor type.
-	void predict( std::vector< std::vector< char > > &data, json &json_response );
+	void predict( const std::vector< std::vector< char > > &data, json &json_response );
+
+	/// Run the AI inference on provided array of byte views. Each byte view references the data of one model input
+	/// without copying it. The referenced memory must remain valid until this method returns.
+	/// In case of errors throws std::exception.
+	/// This is blocking method, i.e. it returns execution only when the inference of an input frame is complete.
+	/// \param[in] data is a vector of byte views, one view for each model input.
+	/// \param[out] json_response is the result of the inference. The response format depends on the model
+	/// post-processor type.
+	void predict( const std::vector< ByteView > &data, json &json_response );
 
 private:
 	std::shared_ptr< Client > m_client;  //!< client protocol handler
@@ -244,6 +307,10 @@ private:
 /// from the AI server, the client callback is invoked to dispatch the inference result. Such result handling via
 /// callback mechanism is performed in a thread, separate from the main execution thread. It means that the client
 /// callback function is called in asynchronous manner, thus the name of the class.
+///
+/// The predict() methods can be called from multiple threads concurrently without external locking: frames of all
+/// threads are pipelined over the single connection to the AI server, and each result is passed to the client
+/// callback along with the frame info string of its own frame.
 class AIModelAsync
 {
 public:
@@ -253,11 +320,18 @@ public:
 	/// Corresponding frame info string (provided to predict() call) is passed as the frame_info argument.
 	using callback_t = std::function< void( const json &inference_result, const std::string &frame_info ) >;
 
+	/// Result post-processing callback type. The callback may modify the inference result, passed as the
+	/// inference_result argument, before it is passed to the user callback.
+	using postprocess_t = std::function< void( json &inference_result, const std::string &frame_info ) >;
+
 	/// Constructor. Performs connection to AI server, selection of AI model, installing client callback,
 	/// and optionally setting model run-time parameters.
 	/// In case of server connection errors throws std::exception.
 	/// \param[in] server is a string specifying server domain name/IP address and port.
 	/// Format: "domain_name:port" or "xxx.xxx.xxx.xxx:port". If port is omitted, the default port is 8778.
+	/// AI server running on the same host can be accessed over Unix domain socket: "unix://" prefix followed by
+	/// the socket file path, for example "unix:///run/aiserver.sock". With "shm://" prefix instead, frames and results
+	/// are passed in shared memory, and only their descriptors are sent over the socket.
 	/// \param[in] model_name specifies the AI model to be used for inference.
 	/// To obtain valid model name, either modelFind() or modelzooListGet() functions should be used.
 	/// \param[in] callback is user callback functional, which will be called asynchronously from the main
@@ -269,12 +343,15 @@ public:
 	/// \param[in] frame_queue_depth is the depth of the internal frame queue.  If predict() methods are invoked
 	/// too often and the number of non-processed (aka "outstanding") frames exceeds this parameter, the
 	/// consecutive call to any predict() method will be blocked until the number of outstanding frames in the
-	/// queue becomes smaller than the queue depth thus allowing to post one more frame.
+	/// queue becomes smaller than the queue depth thus allowing to post one more frame, unless frames are dropped
+	/// according to the frame overflow policy set by frameOverflowPolicySet().
 	/// This is optional parameter: by default it is set to 8 frames.
 	/// \param[in] connection_timeout_ms is the AI server connection timeout in milliseconds.
 	/// This is optional parameter: by default it is set to 10 sec.
 	/// \param[in] inference_timeout_ms is the AI server inference timeout in milliseconds.
 	/// This is optional parameter: by default it is set to 180 sec.
+	/// \param[in] client_options is the collection of socket-level transport options, such as socket buffer sizes,
+	/// applied to all connections to the AI server. This is optional parameter: by default system defaults are used.
 	explicit AIModelAsync(
 		const std::string &server,
 		const std::string &model_name,
@@ -282,7 +359,8 @@ public:
 		const ModelParamsReadAccess &model_params = ModelParamsReadAccess( {} ),
 		size_t frame_queue_depth = DEFAULT_FRAME_QUEUE_DEPTH,
 		size_t connection_timeout_ms = DEFAULT_CONNECTION_TIMEOUT_MS,
-		size_t inference_timeout_ms = DEFAULT_INFERENCE_TIMEOUT_MS );
+		size_t inference_timeout_ms = DEFAULT_INFERENCE_TIMEOUT_MS,
+		const ClientOptions &client_options = ClientOptions() );
 
 	// Deleted copy constructor and copy assignment operator
 	AIModelAsync( const AIModelAsync & ) = delete;
@@ -307,7 +385,495 @@ public:
 	/// bytes. \param[in] frame_info is optional frame information string to be passed to the client callback along with
 	/// the frame result. You can pass arbitrary information as frame info. This simplifies matching results to frames
 	/// in the client callback.
-	void predict( std::vector< std::vector< char > > &data, const std::string &frame_info = "" );
+	/// \param[in] deadline_ms is optional frame deadline: the time in milliseconds since the call, after which
+	/// the frame result is useless, for example, for real-time control loops. The frame, which is still waiting
+	/// to be sent to the AI server when its deadline is passed, is dropped, and its result received after
+	/// the deadline is discarded. The callback is not called for such frames unless the AI server reports an error
+	/// for them; their number is reported by expiredFramesCountGet(). Zero value means no deadline; this is
+	/// the default. The same parameter of other predict methods has the same meaning.
+	void predict(
+		const std::vector< std::vector< char > > &data,
+		const std::string &frame_info = "",
+		size_t deadline_ms = 0 );
+
+	/// Start the inference on given byte data vector taking the ownership of the frame data.
+	/// The frame data is moved into the client, so no copy of it is made. For AI servers using TCP socket protocol
+	/// the frame is queued and sent to the server asynchronously, so the call does not wait for the network,
+	/// but only for free space in the frame queue.
+	/// In case of errors throws std::exception.
+	/// This is non-blocking call meaning that it returns execution immediately after posting the frame data to the AI
+	/// server.
+	/// \param[in] data is a vector of input data for each model input where each data element is a vector of
+	/// bytes.
+	/// \param[in] frame_info is optional frame information string to be passed to the client callback along with
+	/// the frame result.
+	/// \param[in] deadline_ms is optional frame deadline in milliseconds. See predict() for details.
+	void predict(
+		std::vector< std::vector< char > > &&data,
+		const std::string &frame_info = "",
+		size_t deadline_ms = 0 );
+
+	/// Start the inference on given byte data vector taking the ownership of the frame data, and deliver
+	/// the frame result to given completion object instead of the client callback. The client callback is not
+	/// required for such frames, and frame info strings are not needed to match results to frames.
+	/// The completion object is notified exactly once: either with the frame result, or when the frame is dropped,
+	/// for example, according to the frame overflow policy or due to AI server error. It is notified from the thread,
+	/// which receives inference results, so it should not block; it may start the inference of the next frame.
+	/// This method never waits for space in the frame queue: when the queue is full, the frame waits for space
+	/// after the method returns, unless it is dropped according to the frame overflow policy.
+	/// This method can be called from multiple threads concurrently, including completion objects of other frames.
+	/// In case of errors throws std::exception; then the completion object is not notified.
+	/// \param[in] data is a vector of input data for each model input where each data element is a vector of
+	/// bytes.
+	/// \param[in] completion is the completion object; it should stay alive until it is notified.
+	/// \param[in] deadline_ms is optional frame deadline in milliseconds. See predict() for details.
+	void predict( std::vector< std::vector< char > > &&data, FrameCompletion &completion, size_t deadline_ms = 0 );
+
+	/// Start the inference on given byte data vector taking the ownership of the frame data, and get the future
+	/// of the frame result. The client callback is not required for such frames, and frame info strings are not
+	/// needed to match results to frames: each caller gets its own result.
+	/// This method can be called from multiple threads concurrently: frames of all callers are pipelined over
+	/// the single connection to AI server, with up to the frame queue depth frames outstanding.
+	/// This method never waits for space in the frame queue: when the queue is full, the frame waits for space
+	/// after the method returns, unless it is dropped according to the frame overflow policy.
+	/// In case of errors throws std::exception. When the frame is dropped without result, the future
+	/// throws std::exception with the reason of the drop.
+	/// \param[in] data is a vector of input data for each model input where each data element is a vector of
+	/// bytes.
+	/// \param[in] deadline_ms is optional frame deadline in milliseconds. See predict() for details.
+	/// \return the future of the inference result; results with AI server errors are returned as is, like to
+	/// the callback
+	std::future< json > predictAsync( std::vector< std::vector< char > > &&data, size_t deadline_ms = 0 );
+
+	/// Start the inference on given byte data vector and get the future of the frame result.
+	/// The frame data is copied. See predictAsync( std::vector< std::vector< char > > && ) for details.
+	/// \param[in] data is a vector of input data for each model input where each data element is a vector of
+	/// bytes.
+	/// \param[in] deadline_ms is optional frame deadline in milliseconds. See predict() for details.
+	/// \return the future of the inference result
+	std::future< json > predictAsync( const std::vector< std::vector< char > > &data, size_t deadline_ms = 0 );
+
+	/// Inference result of the frame of the input sequence, produced by PredictRange
+	struct IndexedResult
+	{
+		size_t input_index = 0;  //!< index of the frame in the input sequence, starting from 0
+		json result;             //!< inference result; results with AI server errors are returned as is
+	};
+
+	/// Lazy single-pass range of inference results of the sequence of frames, returned by predictRange().
+	/// Frames are taken from the input sequence only as needed to keep the given number of frames in flight,
+	/// so the input may be generated on the fly, and results are produced in the order of frames when the range
+	/// is iterated. The model object should stay alive while the range is iterated; so should the input sequence,
+	/// unless it is owned by the range.
+	/// \tparam InputIt is the type of input iterator, which dereferences to a frame: a vector of input data for
+	/// each model input, where each data element is a vector of bytes.
+	template< typename InputIt >
+	class PredictRange
+	{
+	public:
+		/// Input iterator over inference results; it refers to the range, so all copies advance together
+		class iterator
+		{
+		public:
+			using iterator_category = std::input_iterator_tag;  //!< iterator category
+			using value_type = IndexedResult;                   //!< iterator value type
+			using difference_type = std::ptrdiff_t;             //!< iterator difference type
+			using pointer = const IndexedResult *;              //!< iterator pointer type
+			using reference = const IndexedResult &;            //!< iterator reference type
+
+			/// Constructor
+			/// \param[in] range is the range to iterate, or nullptr for the end iterator
+			explicit iterator( PredictRange *range = nullptr ) : m_range( range )
+			{}
+
+			/// Get the current result
+			reference operator*() const
+			{
+				return m_range->m_current;
+			}
+
+			/// Get the pointer to the current result
+			pointer operator->() const
+			{
+				return &m_range->m_current;
+			}
+
+			/// Advance to the next result, waiting for it. Throws std::exception when the frame cannot be posted
+			/// or is dropped without result.
+			iterator &operator++()
+			{
+				m_range->advance();
+				return *this;
+			}
+
+			/// Advance to the next result; see prefix increment
+			void operator++( int )
+			{
+				++*this;
+			}
+
+			/// Compare iterators: all iterators of finished range are equal to the end iterator
+			bool operator==( const iterator &other ) const
+			{
+				return finished() == other.finished();
+			}
+
+			/// Compare iterators
+			bool operator!=( const iterator &other ) const
+			{
+				return !( *this == other );
+			}
+
+		private:
+			/// Check if the iterator is at the end of the range
+			bool finished() const
+			{
+				return m_range == nullptr || m_range->m_finished;
+			}
+
+			PredictRange *m_range;  //!< iterated range; nullptr for the end iterator
+		};
+
+		/// Constructor
+		/// \param[in] model is the model object, which runs the inference
+		/// \param[in] first is the beginning of the input sequence
+		/// \param[in] last is the end of the input sequence
+		/// \param[in] frames_in_flight is the max. number of frames in flight, including the awaited one
+		/// \param[in] input is the input sequence to be owned by the range (or nullptr when it is owned by the caller)
+		PredictRange(
+			AIModelAsync &model,
+			InputIt first,
+			InputIt last,
+			size_t frames_in_flight,
+			std::shared_ptr< void > input = nullptr ) :
+			m_model( model ),
+			m_input( std::move( input ) ), m_next( first ), m_last( last ),
+			m_frames_in_flight( std::max( frames_in_flight, size_t{ 1 } ) )
+		{}
+
+		/// Start the inference and wait for the first result. The range can be iterated only once.
+		/// \return the iterator at the first result
+		iterator begin()
+		{
+			if( !m_started )
+			{
+				m_started = true;
+				advance();
+			}
+			return iterator( this );
+		}
+
+		/// Get the end iterator
+		iterator end()
+		{
+			return iterator();
+		}
+
+	private:
+		/// Post frames from the input sequence until the given number of frames is in flight
+		void post()
+		{
+			while( m_results.size() < m_frames_in_flight && m_next != m_last )
+			{
+				m_results.push_back( m_model.predictAsync( *m_next ) );
+				++m_next;
+			}
+		}
+
+		/// Take the result of the oldest frame in flight, posting next frames before waiting for the result;
+		/// the awaited frame is still in flight, so no frames are posted after it is taken out
+		void advance()
+		{
+			post();
+			if( m_results.empty() )
+			{
+				m_finished = true;
+				return;
+			}
+
+			// the frame is taken out before waiting, so the range can be continued after the frame drop exception
+			std::future< json > result = std::move( m_results.front() );
+			m_results.pop_front();
+			m_current.input_index = m_next_index++;
+			m_current.result = result.get();
+		}
+
+		AIModelAsync &m_model;                        //!< model object, which runs the inference
+		std::shared_ptr< void > m_input;              //!< input sequence owned by the range (or nullptr)
+		InputIt m_next;                               //!< next frame of the input sequence to post
+		InputIt m_last;                               //!< end of the input sequence
+		size_t m_frames_in_flight;                    //!< max. number of frames in flight, including the awaited one
+		std::deque< std::future< json > > m_results;  //!< futures of results of frames in flight, in order
+		IndexedResult m_current;                      //!< current result
+		size_t m_next_index = 0;                      //!< input index of the oldest frame in flight
+		bool m_started = false;                       //!< iteration is started
+		bool m_finished = false;                      //!< all results are produced
+	};
+
+	/// Run the pipelined inference over the sequence of frames given by the pair of iterators, and get the lazy
+	/// range of results: `for( const auto &r : model.predictRange( frames.begin(), frames.end() ) )`, where
+	/// `r.input_index` is the index of the frame in the sequence, and `r.result` is its inference result.
+	/// No client callback, frame info strings, or buffering of the whole input are involved: frames are posted
+	/// as the range is iterated, keeping the given number of frames in flight, and results are produced in
+	/// the order of frames. Frames are posted by predictAsync(), so see it for other details.
+	/// Iteration throws std::exception when the frame cannot be posted or is dropped without result.
+	/// \tparam InputIt is the type of input iterator, which dereferences to a frame: a vector of input data for
+	/// each model input, where each data element is a vector of bytes. Frames returned by value are moved into
+	/// the model object; frames returned by reference are copied.
+	/// \param[in] first is the beginning of the input sequence.
+	/// \param[in] last is the end of the input sequence.
+	/// \param[in] frames_in_flight is the max. number of frames in flight, including the frame, which result
+	/// is awaited. Zero value means the frame queue depth, or its upper bound in adaptive mode; this is the default.
+	/// \return the range of results.
+	template< typename InputIt >
+	PredictRange< InputIt > predictRange( InputIt first, InputIt last, size_t frames_in_flight = 0 )
+	{
+		return PredictRange< InputIt >( *this, first, last, framesInFlightGet( frames_in_flight ) );
+	}
+
+	/// Run the pipelined inference over the container or range of frames, and get the lazy range of results.
+	/// See predictRange() overload accepting iterators for details.
+	/// \param[in] frames is the container or range of frames. When it is an lvalue, it should stay alive while
+	/// results are iterated; a temporary container is moved into the range of results.
+	/// \param[in] frames_in_flight is the max. number of frames in flight, including the frame, which result
+	/// is awaited. Zero value means the frame queue depth, or its upper bound in adaptive mode; this is the default.
+	/// \return the range of results.
+	template< typename Range >
+	auto predictRange( Range &&frames, size_t frames_in_flight = 0 )
+		-> PredictRange< decltype( std::begin( frames ) ) >
+	{
+		if constexpr( std::is_lvalue_reference_v< Range > )
+			return predictRange( std::begin( frames ), std::end( frames ), frames_in_flight );
+		else
+		{
+			auto input = std::make_shared< std::remove_reference_t< Range > >( std::move( frames ) );
+			return PredictRange< decltype( std::begin( frames ) ) >(
+				*this,
+				std::begin( *input ),
+				std::end( *input ),
+				framesInFlightGet( frames_in_flight ),
+				input );
+		}
+	}
+
+	/// Result of the frame posted by tryPredict() and retrieved by pollResults()
+	struct PolledResult
+	{
+		std::string frame_info;   //!< frame information string passed to tryPredict()
+		json result;              //!< inference result; results with AI server errors are returned as is
+		std::string drop_reason;  //!< the reason why the frame is dropped without result; empty if there is result
+	};
+
+	/// Try to start the inference on given byte data vector without waiting, for applications, which run their own
+	/// event loop and can neither block nor receive callbacks in foreign threads. The frame is accepted only when
+	/// it fits into the frame queue right away, regardless of the frame overflow policy: otherwise the method
+	/// returns false, and the frame data is left intact, so the frame can be retried later, or dropped by
+	/// the caller. Frame results are not passed to the client callback: they are collected in the internal
+	/// ring of results and retrieved by pollResults(). The number of accepted frames, which results are not
+	/// yet retrieved, is limited by the frame queue depth, or its upper bound in adaptive mode, so results should
+	/// be polled regularly.
+	/// In case of errors throws std::exception.
+	/// \param[in] data is a vector of input data for each model input where each data element is a vector of
+	/// bytes. It is moved into the model object only when the frame is accepted.
+	/// \param[in] frame_info is optional frame information string to be returned by pollResults() along with
+	/// the frame result.
+	/// \param[in] deadline_ms is optional frame deadline in milliseconds. See predict() for details.
+	/// \return true if the frame is accepted, false if the frame queue is full.
+	bool tryPredict(
+		std::vector< std::vector< char > > &&data,
+		const std::string &frame_info = "",
+		size_t deadline_ms = 0 );
+
+	/// Retrieve results of frames posted by tryPredict(), which are ready by now, without waiting.
+	/// Results are appended to given vector, so its storage can be reused between calls. Results of dropped frames
+	/// are retrieved as well, with the reason of the drop. Should not be called from multiple threads concurrently.
+	/// \param[out] results is the vector to append retrieved results to.
+	/// \param[in] max_count is the maximum number of results to retrieve.
+	/// \return the number of retrieved results.
+	size_t pollResults( std::vector< PolledResult > &results, size_t max_count = SIZE_MAX );
+
+#ifdef DG_HAS_COROUTINES
+	/// Awaitable inference of a single frame returned by infer(). It is the completion object of the frame:
+	/// the awaiting coroutine is resumed right from the completion, in the thread, which receives inference results.
+	class InferAwaitable: private FrameCompletion
+	{
+	public:
+		/// Constructor
+		/// \param[in] model is the model object, which runs the inference
+		/// \param[in] data is a vector of input data for each model input; it is moved into the awaitable
+		/// \param[in] deadline_ms is frame deadline in milliseconds since the inference is started; 0 for none
+		InferAwaitable( AIModelAsync &model, std::vector< std::vector< char > > &&data, size_t deadline_ms ) :
+			m_model( model ), m_data( std::move( data ) ), m_deadline_ms( deadline_ms )
+		{}
+
+		/// The result is never ready before the inference is started
+		bool await_ready() const noexcept
+		{
+			return false;
+		}
+
+		/// Start the inference and suspend the coroutine, unless the frame is already completed
+		/// \param[in] handle is the handle of the awaiting coroutine
+		/// \return true to suspend the coroutine
+		bool await_suspend( std::coroutine_handle<> handle )
+		{
+			m_handle = handle;
+			m_model.predict( std::move( m_data ), *this, m_deadline_ms );
+
+			// whoever comes second, this call or the completion, resumes the coroutine
+			return !m_completed.exchange( true, std::memory_order_acq_rel );
+		}
+
+		/// Get the inference result. Throws std::exception when the frame is dropped.
+		/// \return the inference result; results with AI server errors are returned as is, like to the callback
+		json await_resume()
+		{
+			if( m_dropped )
+				DG_ERROR( m_reason, ErrOperationFailed );
+			return std::move( m_result );
+		}
+
+	private:
+		/// Keep the frame result and resume the coroutine
+		void resultReady( json &&result ) override
+		{
+			m_result = std::move( result );
+			complete();
+		}
+
+		/// Keep the reason of the frame drop and resume the coroutine
+		void frameDropped( const std::string &reason ) override
+		{
+			m_reason = reason;
+			m_dropped = true;
+			complete();
+		}
+
+		/// Resume the coroutine, if it is already suspended
+		void complete()
+		{
+			if( m_completed.exchange( true, std::memory_order_acq_rel ) )
+				m_handle.resume();
+		}
+
+		AIModelAsync &m_model;                      //!< model object, which runs the inference
+		std::vector< std::vector< char > > m_data;  //!< frame data until the inference is started
+		size_t m_deadline_ms;                       //!< frame deadline in milliseconds (or 0 for none)
+		std::coroutine_handle<> m_handle;           //!< awaiting coroutine
+		std::atomic_bool m_completed{ false };      //!< set by the first of suspension and completion
+		json m_result;                              //!< inference result
+		std::string m_reason;                       //!< the reason why the frame is dropped
+		bool m_dropped = false;                     //!< the frame is dropped without result
+	};
+
+	/// Start the inference on given byte data vector taking the ownership of the frame data, and await its result:
+	/// `json result = co_await model.infer( std::move( frame ) );`. No client callback, frame info strings,
+	/// or intermediate queues are involved: the awaiting coroutine is resumed from the completion of the frame,
+	/// in the thread, which receives inference results, so it should offload long processing elsewhere.
+	/// Many coroutines may await their frames concurrently: up to the frame queue depth frames are outstanding,
+	/// and the frames of other awaits wait for space in order without blocking the calling thread, unless frames
+	/// are dropped according to the frame overflow policy.
+	/// Throws std::exception when the frame cannot be posted or is dropped without result.
+	/// Available when compiled with C++20 coroutine support.
+	/// \param[in] data is a vector of input data for each model input where each data element is a vector of
+	/// bytes.
+	/// \param[in] deadline_ms is optional frame deadline in milliseconds. See predict() for details.
+	/// \return the awaitable, which produces the inference result
+	InferAwaitable infer( std::vector< std::vector< char > > &&data, size_t deadline_ms = 0 )
+	{
+		return InferAwaitable( *this, std::move( data ), deadline_ms );
+	}
+#endif
+
+	/// Start the inference on given array of byte views. Each byte view references the data of one model input
+	/// without copying it. The referenced memory must remain valid until this method returns.
+	/// In case of errors throws std::exception.
+	/// This is non-blocking call meaning that it returns execution immediately after posting the frame data to the AI
+	/// server.
+	/// \param[in] data is a vector of byte views, one view for each model input.
+	/// \param[in] frame_info is optional frame information string to be passed to the client callback along with
+	/// the frame result.
+	/// \param[in] deadline_ms is optional frame deadline in milliseconds. See predict() for details.
+	void predict( const std::vector< ByteView > &data, const std::string &frame_info = "", size_t deadline_ms = 0 );
+
+	/// Start the inference on given batch of frames. This is equivalent to calling predict() for each frame
+	/// of the batch, but it has lower per-frame overhead: the frame queue space is reserved for as many frames
+	/// as possible at once, and the frames are sent to the AI server using as few system calls as possible.
+	/// It is useful for offline processing of recorded video or image folders, especially for small models.
+	/// In case of errors throws std::exception.
+	/// This call returns when all frames of the batch are posted to the AI server; it blocks while the frame
+	/// queue is full.
+	/// \param[in] frames is a vector of frames, where each frame is a vector of input data for each model input,
+	/// and each data element is a vector of bytes.
+	/// \param[in] frame_infos is an optional vector of frame information strings, one string per frame, to be
+	/// passed to the client callback along with the frame results. When it is empty, empty strings are passed.
+	/// \param[in] deadline_ms is optional deadline of each frame in milliseconds. See predict() for details.
+	void predictBatch(
+		const std::vector< std::vector< std::vector< char > > > &frames,
+		const std::vector< std::string > &frame_infos = {},
+		size_t deadline_ms = 0 );
+
+	/// Start the inference on given batch of frames taking the ownership of the frames data.
+	/// The frames data is moved into the client, so no copy of it is made.
+	/// See predictBatch() overload accepting constant reference to frames for details.
+	/// \param[in] frames is a vector of frames, where each frame is a vector of input data for each model input,
+	/// and each data element is a vector of bytes.
+	/// \param[in] frame_infos is an optional vector of frame information strings, one string per frame, to be
+	/// passed to the client callback along with the frame results. When it is empty, empty strings are passed.
+	/// \param[in] deadline_ms is optional deadline of each frame in milliseconds. See predict() for details.
+	void predictBatch(
+		std::vector< std::vector< std::vector< char > > > &&frames,
+		const std::vector< std::string > &frame_infos = {},
+		size_t deadline_ms = 0 );
+
+	/// Start the inference on given batch of frames, where each frame is an array of byte views.
+	/// The referenced memory must remain valid until this method returns.
+	/// See predictBatch() overload accepting constant reference to frames for details.
+	/// \param[in] frames is a vector of frames, where each frame is a vector of byte views, one view for each model
+	/// input.
+	/// \param[in] frame_infos is an optional vector of frame information strings, one string per frame, to be
+	/// passed to the client callback along with the frame results. When it is empty, empty strings are passed.
+	/// \param[in] deadline_ms is optional deadline of each frame in milliseconds. See predict() for details.
+	void predictBatch(
+		const std::vector< std::vector< ByteView > > &frames,
+		const std::vector< std::string > &frame_infos = {},
+		size_t deadline_ms = 0 );
+
+	/// Start the inference on a frame, which data is sent to the AI server in chunks as it becomes available.
+	/// It is intended for very large frame inputs, which are produced gradually, for example, read from a file
+	/// or decoded: the frame is never assembled in memory, and sending its first chunks overlaps with producing
+	/// the next ones. The frame is posted to the frame queue when the writer is opened, so this call blocks while
+	/// the frame queue is full. Use FrameWriter::write() to send the chunks of each model input in order, and then
+	/// call FrameWriter::finish(). Frames posted by other threads wait until the writer is finished or destroyed,
+	/// and the thread, which opened the writer, cannot post other frames until then. The writer should be destroyed
+	/// before this object.
+	/// This method is supported only for AI servers using TCP socket protocol, which support chunked frames.
+	/// In case of errors throws std::exception.
+	/// \param[in] frame_info is optional frame information string to be passed to the client callback along with
+	/// the frame result.
+	/// \param[in] deadline_ms is optional frame deadline in milliseconds since the writer is opened. See predict()
+	/// for details.
+	/// \return the frame writer object.
+	std::unique_ptr< FrameWriter > predictChunked( const std::string &frame_info = "", size_t deadline_ms = 0 );
+
+	/// Start the inference on a frame, which data is filled in place by the caller. The space for frame inputs is
+	/// reserved by this call: use FrameSlot::inputDataGet() to fill each model input, and then call
+	/// FrameSlot::commit() to post the frame. For AI servers connected over shared memory transport the space is
+	/// located in the shared memory segment, so frame data is never copied; the frame is posted to the frame queue
+	/// when the slot is reserved, so this call blocks while the frame queue is full, and frames posted by other
+	/// threads wait until the slot is committed or destroyed. For other servers the frame is posted on commit.
+	/// The slot should be destroyed before this object.
+	/// In case of errors throws std::exception.
+	/// \param[in] input_sizes is the vector of sizes of frame inputs in bytes, one size for each model input.
+	/// \param[in] frame_info is optional frame information string to be passed to the client callback along with
+	/// the frame result.
+	/// \param[in] deadline_ms is optional frame deadline in milliseconds since the slot is reserved. See predict()
+	/// for details.
+	/// \return the frame slot object.
+	std::unique_ptr< FrameSlot > predictSlot(
+		const std::vector< size_t > &input_sizes,
+		const std::string &frame_info = "",
+		size_t deadline_ms = 0 );
 
 	/// Wait for completion of all outstanding inferences.
 	/// This is blocking call: it returns when all outstanding frames are processed by AI server and all results
@@ -318,6 +884,70 @@ public:
 	/// Get the number of outstanding inference results posted so far.
 	int outstandingResultsCountGet() const;
 
+	/// Enable or disable adaptive frame queue depth.
+	/// In adaptive mode the frame queue depth, which limits the number of outstanding frames, is adjusted
+	/// between the given bounds: the client measures the throughput and the frame round-trip time, grows the depth
+	/// while the AI server pipeline is not saturated, and shrinks it when extra frames only wait in queues,
+	/// adding latency. The depth starts from the frame queue depth given in the constructor, so start with
+	/// small value to find the optimal depth faster.
+	/// This method should be called when there are no outstanding frames, e.g. before the first predict() call
+	/// or after waitCompletion() call, and when all results of frames posted by tryPredict() are polled.
+	/// \param[in] min_depth is the lower bound of the frame queue depth.
+	/// \param[in] max_depth is the upper bound of the frame queue depth. When it is not greater than min_depth,
+	/// adaptive mode is disabled, and the frame queue depth given in the constructor is used.
+	void frameQueueDepthRangeSet( size_t min_depth, size_t max_depth );
+
+	/// Get the frame queue depth status: the current depth and, in adaptive mode, the measured throughput,
+	/// the frame round-trip time, and the explanation of the last depth adjustment.
+	FrameQueueDepthStatus frameQueueDepthStatusGet() const;
+
+	/// Set the limit of the total size of the data of outstanding frames. The limit is enforced along with the frame
+	/// queue depth, so both the number of outstanding frames and the memory they occupy are bounded, when frames
+	/// of very different sizes are sent over the same model object. A frame is posted when both the depth and
+	/// the size limit allow it; a frame, which is larger than the limit, is posted when no other frames are
+	/// outstanding. The size of frames sent by predictChunked() is not known in advance, so they are not accounted.
+	/// This method should be called when there are no outstanding frames.
+	/// \param[in] max_bytes is the limit of the total size of the data of outstanding frames in bytes.
+	/// Zero value disables the limit; this is the default.
+	void frameQueueBytesLimitSet( size_t max_bytes );
+
+	/// Set the policy of handling new frames when the frame queue is full because AI server does not keep up
+	/// with the frame rate. By default predict() methods wait until the frame queue has space for the new frame.
+	/// For live video streams it is often better to drop frames than to accumulate latency: either the new frame
+	/// or the oldest frame, which is not yet sent to AI server, can be dropped. The callback is not called for
+	/// dropped frames; their number is reported by droppedFramesCountGet().
+	/// \param[in] policy is the frame overflow policy.
+	void frameOverflowPolicySet( FrameOverflowPolicy policy );
+
+	/// Get the number of frames dropped according to the frame overflow policy since the model object is created.
+	size_t droppedFramesCountGet() const;
+
+	/// Get the number of frames dropped or discarded due to passed deadlines since the model object is created.
+	/// Frame deadlines are passed to predict() methods.
+	size_t expiredFramesCountGet() const;
+
+	/// Set which threads call the user callback. By default the callback is called from the thread, which receives
+	/// inference results, so slow callbacks, like drawing or database inserts, delay reception of next results.
+	/// With CallbackExecution::Thread mode callbacks are called from the dedicated thread in the order of frames;
+	/// with CallbackExecution::Pool mode they are called concurrently from the pool of threads, and results may
+	/// be delivered out of order: use frame info strings to match them to frames.
+	/// Heavy post-processing may scale across CPU cores with in-order delivery: pass the post-processing callback,
+	/// which is called concurrently from the pool and may modify results, and request ordered delivery: then
+	/// post-processed results are kept in the reorder buffer, and the user callback is called for them one at a time
+	/// in the order of frames.
+	/// In all these modes waitCompletion() also waits until all callbacks return. The number of results waiting
+	/// for callbacks is limited by the maximum frame queue depth: when callbacks fall behind, reception of next
+	/// results waits for them, as in the default mode.
+	/// Should be called when no frames are outstanding.
+	/// \param[in] mode is the callback execution mode
+	/// \param[in] thread_count is the number of threads for CallbackExecution::Pool mode. Zero value means
+	/// the number of CPU cores.
+	/// \param[in] ordered is the flag to call the user callback in the order of frames in CallbackExecution::Pool mode
+	/// \param[in] postprocess is the optional post-processing callback, which is called for each result before
+	/// the user callback
+	void callbackExecutionSet(
+		CallbackExecution mode, size_t thread_count = 0, bool ordered = false, postprocess_t postprocess = nullptr );
+
 	/// If ever during consecutive calls to predict() methods AI server reported a run-time error, then
 	/// this method will return the error message string, otherwise it returns an empty string.
 	/// Note: in case of server runtime error, all frames posted after that error was detected,
@@ -325,7 +955,16 @@ public:
 	std::string lastError() const;
 
 private:
-	std::shared_ptr< Client > m_client;  //!< client protocol handler
+	class PollCompletion;
+
+	/// Get the number of frames in flight for predictRange()
+	/// \param[in] frames_in_flight is the requested number of frames in flight; 0 to use the default
+	/// \return the number of frames in flight
+	size_t framesInFlightGet( size_t frames_in_flight ) const;
+
+	FrameRing< PolledResult > m_polled_results;    //!< results of frames posted by tryPredict()
+	std::atomic< size_t > m_polled_reserved{ 0 };  //!< number of accepted frames, which results are not yet polled
+	std::shared_ptr< Client > m_client;            //!< client protocol handler
 };
 }  // namespace DG
 
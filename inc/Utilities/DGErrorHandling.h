@@ -45,6 +45,7 @@
 	_( ErrFirmwareLoad, 0x0000001C, "Firmware load failed" )                                  \
 	_( ErrIncorrectAPIUse, 0x0000001D, "Incorrect API usage" )                                \
 	_( ErrUsbLib, 0x0000001E, "USBLIB error" )                                                \
+	_( ErrServerError, 0x0000001F, "Error reported by server" )                               \
                                                                                               \
 	_( ErrContinue, 0x00001000, "<continued>" )                                               \
 	_( ErrAssert, 0x00001001, "Execution failed" )                                            \
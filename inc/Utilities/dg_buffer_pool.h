@@ -0,0 +1,145 @@
+//////////////////////////////////////////////////////////////////////
+/// \file  dg_buffer_pool.h
+/// \brief DG pool of reusable byte buffers
+///
+/// Copyright 2023 DeGirum Corporation
+///
+/// This file contains declaration of the allocator, which does not
+/// zero-initialize elements on container growth, and of the pool of
+/// reusable byte buffers based on it.
+///
+
+#ifndef DG_BUFFER_POOL_H_
+#define DG_BUFFER_POOL_H_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+namespace DG
+{
+/// Allocator adaptor, which default-initializes elements when they are constructed without arguments.
+/// For trivial types it means no initialization at all, so resize() of containers using this allocator
+/// does not zero-fill the memory, which is going to be overwritten anyway.
+template< typename T, typename A = std::allocator< T > >
+class DefaultInitAllocator: public A
+{
+	using traits = std::allocator_traits< A >;
+
+public:
+	/// Rebind to other element type
+	template< typename U >
+	struct rebind
+	{
+		using other = DefaultInitAllocator< U, typename traits::template rebind_alloc< U > >;
+	};
+
+	using A::A;
+
+	/// Construct element without arguments: default-initialize it
+	template< typename U >
+	void construct( U *ptr ) noexcept( std::is_nothrow_default_constructible< U >::value )
+	{
+		::new( static_cast< void * >( ptr ) ) U;
+	}
+
+	/// Construct element with arguments: delegate to base allocator
+	template< typename U, typename... Args >
+	void construct( U *ptr, Args &&...args )
+	{
+		traits::construct( static_cast< A & >( *this ), ptr, std::forward< Args >( args )... );
+	}
+};
+
+/// Thread-safe pool of reusable byte buffers.
+/// Buffers are acquired from the pool as handles, which automatically return buffers back to the pool
+/// on destruction. Returned buffers keep their capacity, so in steady state no heap allocations are made.
+/// The pool is always managed by shared pointer, so it can be shared between multiple clients, and
+/// outstanding buffer handles keep it alive.
+class BufferPool: public std::enable_shared_from_this< BufferPool >
+{
+public:
+	/// Buffer type: byte vector which grows without zero-filling
+	using buffer_t = std::vector< uint8_t, DefaultInitAllocator< uint8_t > >;
+
+	/// Buffer handle deleter: returns buffer back to the pool
+	struct Releaser
+	{
+		std::shared_ptr< BufferPool > m_pool;  //!< pool to return buffer to
+
+		/// Return buffer to the pool
+		void operator()( buffer_t *buffer ) const
+		{
+			if( m_pool != nullptr )
+				m_pool->release( buffer );
+			else
+				delete buffer;
+		}
+	};
+
+	/// Buffer handle type
+	using handle_t = std::unique_ptr< buffer_t, Releaser >;
+
+	/// Create buffer pool
+	/// \param[in] max_idle - max. number of idle buffers kept in the pool; extra buffers are freed on release
+	/// \return shared pointer to created pool
+	static std::shared_ptr< BufferPool > create( size_t max_idle = 4 )
+	{
+		return std::shared_ptr< BufferPool >( new BufferPool( max_idle ) );
+	}
+
+	/// Acquire buffer from the pool. If there are no idle buffers, new buffer is allocated.
+	/// Buffer is returned to the pool when the handle is destroyed.
+	/// \return buffer handle; the buffer is empty, but may have non-zero capacity
+	handle_t acquire()
+	{
+		buffer_t *buffer = nullptr;
+		{
+			std::lock_guard< std::mutex > lk( m_mx );
+			if( !m_idle.empty() )
+			{
+				buffer = m_idle.back().release();
+				m_idle.pop_back();
+			}
+		}
+		if( buffer == nullptr )
+			buffer = new buffer_t();
+		buffer->clear();
+		return handle_t( buffer, Releaser{ shared_from_this() } );
+	}
+
+	/// Get the number of idle buffers in the pool
+	size_t idleCountGet()
+	{
+		std::lock_guard< std::mutex > lk( m_mx );
+		return m_idle.size();
+	}
+
+private:
+	/// Constructor
+	/// \param[in] max_idle - max. number of idle buffers kept in the pool
+	explicit BufferPool( size_t max_idle ) : m_max_idle( max_idle )
+	{
+		m_idle.reserve( max_idle );
+	}
+
+	/// Return buffer back to the pool
+	/// \param[in] buffer - buffer to return
+	void release( buffer_t *buffer )
+	{
+		std::unique_ptr< buffer_t > owner( buffer );
+		std::lock_guard< std::mutex > lk( m_mx );
+		if( m_idle.size() < m_max_idle )
+			m_idle.push_back( std::move( owner ) );
+	}
+
+	std::mutex m_mx;                                    //!< mutex to protect idle buffer list
+	std::vector< std::unique_ptr< buffer_t > > m_idle;  //!< idle buffers
+	const size_t m_max_idle;                            //!< max. number of idle buffers
+};
+
+}  // namespace DG
+
+#endif  // DG_BUFFER_POOL_H_
@@ -0,0 +1,231 @@
+//////////////////////////////////////////////////////////////////////
+/// \file  dg_callback_executor.h
+/// \brief DG executor of user callbacks of asynchronous inference
+///
+/// Copyright 2023 DeGirum Corporation
+///
+/// This file contains declaration of the executor, which runs user
+/// callbacks of asynchronous inference either inline or in its own
+/// threads, so slow callbacks do not stall result reception.
+///
+
+#ifndef DG_CALLBACK_EXECUTOR_H_
+#define DG_CALLBACK_EXECUTOR_H_
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Utilities/dg_client_structs.h"
+
+namespace DG
+{
+/// Executor of user callbacks. Tasks are posted by the thread, which receives inference results, in the order
+/// of frames. In inline mode they are executed right in the posting thread. Otherwise they are queued and executed
+/// by executor threads: in the order of posting when there is single thread, or concurrently when there are many.
+/// Each task consists of two stages: the work stage, which may run concurrently, and the optional delivery stage,
+/// which follows the work stage. Posted tasks are numbered in the order of posting; in ordered mode delivery
+/// stages of completed tasks are kept in the reorder buffer and executed one at a time in the order of posting.
+/// The number of posted and not yet completed tasks may be limited: then post() waits until some task is completed.
+class CallbackExecutor
+{
+public:
+	/// Task type
+	using task_t = std::function< void() >;
+
+	CallbackExecutor() = default;
+	CallbackExecutor( const CallbackExecutor & ) = delete;
+	CallbackExecutor &operator=( const CallbackExecutor & ) = delete;
+
+	/// Destructor. Completes all posted tasks and joins executor threads.
+	~CallbackExecutor()
+	{
+		configure( CallbackExecution::Inline, 0 );
+	}
+
+	/// Set execution mode. Tasks posted before are completed, and threads of previous mode are joined.
+	/// Should not be called concurrently with post().
+	/// \param[in] mode - execution mode
+	/// \param[in] thread_count - number of threads for CallbackExecution::Pool mode; 0 for the number of CPU cores
+	/// \param[in] ordered - when true, delivery stages are executed in the order of posting in CallbackExecution::Pool
+	/// mode; in other modes tasks are executed in the order of posting anyway
+	void configure( CallbackExecution mode, size_t thread_count, bool ordered = false )
+	{
+		{
+			std::lock_guard< std::mutex > lock( m_mutex );
+			m_stop = true;
+		}
+		m_task_cv.notify_all();
+		for( auto &t : m_threads )
+			t.join();
+		m_threads.clear();
+		m_stop = false;
+		m_ordered = ordered && mode == CallbackExecution::Pool;
+		m_next_seq = m_next_delivery = 0;
+
+		if( mode == CallbackExecution::Thread )
+			thread_count = 1;
+		else if( mode == CallbackExecution::Inline )
+			thread_count = 0;
+		else if( thread_count == 0 )
+			thread_count = std::max( std::thread::hardware_concurrency(), 1u );
+
+		m_threads.reserve( thread_count );
+		for( size_t ti = 0; ti < thread_count; ti++ )
+			m_threads.emplace_back( [ this ]() { workerThread(); } );
+	}
+
+	/// Set the limit of the number of posted and not yet completed tasks. When the limit is reached, post() waits
+	/// until some task is completed, so the posting thread is held back by slow tasks like in inline mode.
+	/// \param[in] capacity - task limit; 0 for no limit
+	void capacitySet( size_t capacity )
+	{
+		{
+			std::lock_guard< std::mutex > lock( m_mutex );
+			m_capacity = capacity;
+		}
+		m_space_cv.notify_all();
+	}
+
+	/// Check if tasks are executed right in the posting thread
+	bool isInline() const
+	{
+		return m_threads.empty();
+	}
+
+	/// Execute the task according to execution mode. Exceptions thrown by tasks are ignored;
+	/// the delivery stage is skipped when the work stage throws. When the task limit is reached, waits
+	/// until some task is completed.
+	/// \param[in] work - work stage of the task
+	/// \param[in] delivery - optional delivery stage of the task
+	void post( task_t &&work, task_t &&delivery = nullptr )
+	{
+		if( isInline() )
+		{
+			if( run( work ) )
+				run( delivery );
+			return;
+		}
+
+		{
+			std::unique_lock< std::mutex > lock( m_mutex );
+			m_space_cv.wait( lock, [ this ]() { return m_capacity == 0 || m_unfinished < m_capacity; } );
+			m_tasks.push_back( { m_next_seq++, std::move( work ), std::move( delivery ) } );
+			m_unfinished++;
+		}
+		m_task_cv.notify_one();
+	}
+
+	/// Wait until all posted tasks are completed. Should not be called from tasks.
+	void drain()
+	{
+		std::unique_lock< std::mutex > lock( m_mutex );
+		m_idle_cv.wait( lock, [ this ]() { return m_unfinished == 0; } );
+	}
+
+private:
+	/// Queued task
+	struct Task
+	{
+		size_t seq;       //!< sequence number of the task in the order of posting
+		task_t work;      //!< work stage
+		task_t delivery;  //!< delivery stage
+	};
+
+	/// Execute the task stage, if any, ignoring exceptions
+	/// \param[in] stage - task stage to execute
+	/// \return false if the stage has thrown an exception
+	static bool run( const task_t &stage )
+	{
+		try
+		{
+			if( stage )
+				stage();
+			return true;
+		}
+		catch( ... )
+		{}
+		return false;
+	}
+
+	/// Account completed task and wake waiters; should be called under the mutex
+	void taskFinished()
+	{
+		if( --m_unfinished == 0 )
+			m_idle_cv.notify_all();
+		m_space_cv.notify_one();
+	}
+
+	/// Executor thread: runs queued tasks until stop is requested and the queue is empty
+	void workerThread()
+	{
+		std::unique_lock< std::mutex > lock( m_mutex );
+		for( ;; )
+		{
+			m_task_cv.wait( lock, [ this ]() { return m_stop || !m_tasks.empty(); } );
+			if( m_tasks.empty() )
+				return;
+
+			Task task = std::move( m_tasks.front() );
+			m_tasks.pop_front();
+			lock.unlock();
+			const bool ok = run( task.work );
+			task.work = nullptr;  // release task captures before the task is reported as completed
+			if( !ok )
+				task.delivery = nullptr;
+
+			if( !m_ordered )
+			{
+				run( task.delivery );
+				task.delivery = nullptr;
+				lock.lock();
+				taskFinished();
+				continue;
+			}
+
+			// put the delivery stage to the reorder buffer; the thread, which is already delivering,
+			// will execute it in turn, otherwise this thread executes all consecutive delivery stages
+			lock.lock();
+			m_reorder.emplace( task.seq, std::move( task.delivery ) );
+			if( m_delivering )
+				continue;
+
+			m_delivering = true;
+			while( !m_reorder.empty() && m_reorder.begin()->first == m_next_delivery )
+			{
+				task_t delivery = std::move( m_reorder.begin()->second );
+				m_reorder.erase( m_reorder.begin() );
+				m_next_delivery++;
+				lock.unlock();
+				run( delivery );
+				delivery = nullptr;
+				lock.lock();
+				taskFinished();
+			}
+			m_delivering = false;
+		}
+	}
+
+	std::vector< std::thread > m_threads;  //!< executor threads (empty in inline mode)
+	bool m_ordered = false;                //!< execute delivery stages in the order of posting
+	std::deque< Task > m_tasks;            //!< queue of posted tasks
+	std::map< size_t, task_t > m_reorder;  //!< reorder buffer: delivery stages of completed tasks by sequence numbers
+	size_t m_next_seq = 0;                 //!< sequence number of the next posted task
+	size_t m_next_delivery = 0;            //!< sequence number of the next task to be delivered
+	bool m_delivering = false;             //!< some executor thread executes delivery stages from the reorder buffer
+	size_t m_unfinished = 0;               //!< number of posted tasks, which are not yet completed
+	size_t m_capacity = 0;                 //!< limit of the number of not yet completed tasks; 0 for no limit
+	bool m_stop = false;                   //!< stop request for executor threads
+	std::mutex m_mutex;                    //!< mutex to protect the above
+	std::condition_variable m_task_cv;     //!< condition variable to wake executor threads
+	std::condition_variable m_idle_cv;     //!< condition variable to wake drain() waiters
+	std::condition_variable m_space_cv;    //!< condition variable to wake post() waiting for task limit
+};
+
+}  // namespace DG
+
+#endif  // DG_CALLBACK_EXECUTOR_H_
@@ -26,6 +26,7 @@
 
 #include <stdlib.h>
 #include <string>
+#include <type_traits>
 #include <vector>
 #include "Utilities/dg_model_parameters.h"
 
@@ -38,7 +39,16 @@ constexpr const char *PROTOCOL_VERSION_TAG = "VERSION";
 const int MIN_COMPATIBLE_PROTOCOL_VERSION = 4;
 
 /// current client-server protocol version
-const int CURRENT_PROTOCOL_VERSION = 4;
+const int CURRENT_PROTOCOL_VERSION = 7;
+
+/// minimum client-server protocol version, which supports multiplexing of streams over single connection
+const int MUX_MIN_PROTOCOL_VERSION = 5;
+
+/// minimum client-server protocol version, which supports sending frame inputs in chunks
+const int CHUNKED_MIN_PROTOCOL_VERSION = 6;
+
+/// minimum client-server protocol version, which supports passing frames and results in shared memory
+const int SHM_MIN_PROTOCOL_VERSION = 7;
 
 /// Default TCP port of AI server
 const int DEFAULT_PORT = 8778;
@@ -55,13 +65,17 @@ const int DEFAULT_FRAME_QUEUE_DEPTH = 8;
 /// Server protocol type
 enum class ServerType
 {
-	Unknown,  //!< Not set
-	ASIO,     //!< proprietary TCP socket server protocol
-	HTTP,     //!< HTTP server protocol
+	Unknown,        //!< Not set
+	ASIO,           //!< proprietary TCP socket server protocol
+	HTTP,           //!< HTTP server protocol
+	UNIX_SOCKET,    //!< proprietary server protocol over Unix domain socket: for AI server running on the same host
+	SHARED_MEMORY,  //!< the same as UNIX_SOCKET, but frames and results are passed in shared memory
 };
 
 /// ServerAddress is the server address structure.
 /// It keeps AI server TCP/IP address, port, and server protocol type.
+/// For AI servers accessed over Unix domain socket, including shared memory transport, it keeps the socket file path
+/// instead of the address.
 struct ServerAddress
 {
 	/// Constructor
@@ -74,9 +88,19 @@ struct ServerAddress
 
 	/// Construct server address from hostname
 	/// \param[in] hostname - server domain name or IP address with optional port suffix and protocol prefix (http:// or
-	/// asio://) \return server address object
+	/// asio://), or Unix domain socket file path with unix:// prefix, like unix:///run/aiserver.sock, or with shm://
+	/// prefix to pass frames and results in shared memory, like shm:///run/aiserver.sock
+	/// \return server address object
 	static ServerAddress fromHostname( const std::string &hostname )
 	{
+		// Unix domain socket path may contain colons: take it as is
+		const std::vector< std::pair< std::string, ServerType > > local_prefixes =
+			{ { "unix://", ServerType::UNIX_SOCKET }, { "shm://", ServerType::SHARED_MEMORY } };
+
+		for( const auto &prefix : local_prefixes )
+			if( hostname.compare( 0, prefix.first.length(), prefix.first ) == 0 )
+				return ServerAddress( hostname.substr( prefix.first.length() ), 0, prefix.second );
+
 		std::string pure_hostname = hostname;
 
 		// deduce server protocol type
@@ -112,17 +136,214 @@ struct ServerAddress
 		return !ip.empty();
 	}
 
+	/// Check if the server is accessed over Unix domain socket
+	/// \return true if server address keeps Unix domain socket file path
+	bool is_local() const
+	{
+		return server_type == ServerType::UNIX_SOCKET || server_type == ServerType::SHARED_MEMORY;
+	}
+
 	/// Convert server address to string
 	operator std::string() const
 	{
+		if( is_local() )
+			return ( server_type == ServerType::SHARED_MEMORY ? "shm://" : "unix://" ) + ip;
 		return ( server_type == ServerType::HTTP ? "http://" : "" ) + ip + ":" + std::to_string( port );
 	}
 
-	std::string ip;                                //!< server domain name or IP address string
+	std::string ip;                                //!< server domain name, IP address string, or socket file path
 	int port = DEFAULT_PORT;                       //!< server TCP port number
 	ServerType server_type = ServerType::Unknown;  //!< server protocol type
 };
 
+/// ClientOptions is the client transport options structure.
+/// It keeps socket-level settings, which are applied to all sockets the client opens to AI server: command and
+/// stream sockets of the proprietary protocol, as well as HTTP and WebSocket connections of HTTP protocol.
+/// It also keeps the sizes of the shared memory buffers, which are used by the shared memory transport.
+/// Zero values select defaults. Options, which are not supported by the platform, are ignored.
+/// Linux clears TCP_QUICKACK after the next delayed acknowledgement, so the proprietary protocol client sets it again
+/// after each receive.
+struct ClientOptions
+{
+	bool tcp_no_delay = true;     //!< disable Nagle algorithm (TCP_NODELAY)
+	bool tcp_quick_ack = false;   //!< acknowledge received data immediately (TCP_QUICKACK, Linux only)
+	int send_buffer_size = 0;     //!< socket send buffer size in bytes (SO_SNDBUF)
+	int receive_buffer_size = 0;  //!< socket receive buffer size in bytes (SO_RCVBUF)
+	int busy_poll_us = 0;         //!< time to busy poll for incoming data in microseconds (SO_BUSY_POLL, Linux only)
+
+	size_t shared_memory_input_size = 0;   //!< size of shared memory buffer for inputs of outstanding frames in bytes
+	size_t shared_memory_result_size = 0;  //!< size of the shared memory buffer for inference results in bytes
+};
+
+/// FrameQueueDepthStatus is the frame queue depth status structure.
+/// It keeps the current frame queue depth, which limits the number of outstanding frames, along with
+/// the measurements, which the adaptive depth controller used to select it, and the reason of its last decision.
+/// It also keeps the total size of the data of outstanding frames and its limit, when the limit is set.
+struct FrameQueueDepthStatus
+{
+	bool adaptive = false;       //!< frame queue depth is adaptive
+	size_t depth = 0;            //!< current frame queue depth
+	size_t min_depth = 0;        //!< lower bound of adaptive frame queue depth
+	size_t max_depth = 0;        //!< upper bound of adaptive frame queue depth
+	double throughput_fps = 0;   //!< throughput measured over the last round, frames per second
+	double latency_ms = 0;       //!< mean frame round-trip time over the last round, milliseconds
+	double base_latency_ms = 0;  //!< minimum frame round-trip time observed recently, milliseconds
+	double backlog_frames = 0;   //!< estimated number of frames queued in excess of what the pipeline needs
+	std::string reason;          //!< explanation of the last controller decision
+	size_t bytes = 0;            //!< total size of the data of outstanding frames in bytes
+	size_t bytes_limit = 0;      //!< limit of the total size of the data of outstanding frames in bytes, if set
+};
+
+/// FrameOverflowPolicy defines what happens with a new frame sent for asynchronous inference, when the frame queue
+/// is full because AI server does not keep up with the frame rate. Dropping frames keeps the latency of live video
+/// streams low at the cost of skipped frames. Dropped frames produce no results: the callback is not called for them.
+enum class FrameOverflowPolicy
+{
+	Block,             //!< wait until the frame queue has space for the new frame; this is the default policy
+	DropNewest,        //!< drop the new frame immediately
+	DropOldestUnsent,  //!< drop the oldest frame, which is queued but not yet sent to AI server, and queue the new
+					   //!< frame instead; drop the new frame if all queued frames are already sent
+};
+
+/// CallbackExecution defines which threads call the user callback of asynchronous inference. By default the callback
+/// is called from the thread, which receives inference results, so slow callbacks delay reception of next results.
+enum class CallbackExecution
+{
+	Inline,  //!< call the callback from the thread, which receives inference results; this is the default mode
+	Thread,  //!< call the callback from the dedicated thread, one result at a time, in the order of frames
+	Pool,    //!< call the callback from the pool of threads concurrently: results may be delivered out of order,
+			 //!< unless ordered delivery is requested
+};
+
+/// ByteView is a non-owning read-only view of a contiguous block of bytes, which keeps the data of one model input.
+/// It allows passing frame data to the inference API without copying it into intermediate containers.
+/// The memory referenced by the view must remain valid until the function, which accepts the view, returns.
+class ByteView
+{
+public:
+	/// Default constructor: creates empty view
+	ByteView() = default;
+
+	/// Constructor from raw memory block
+	/// \param[in] data - pointer to the beginning of the memory block
+	/// \param[in] size - size of the memory block in bytes
+	ByteView( const void *data, size_t size ) : m_data( static_cast< const char * >( data ) ), m_size( size )
+	{}
+
+	/// Constructor from vector of trivially copyable elements. Vectors of other elements, like strings or nested
+	/// vectors, do not keep their data in a contiguous block, so they are not convertible to the view.
+	/// \param[in] v - vector, which data will be referenced by the view
+	template< typename T, typename = std::enable_if_t< std::is_trivially_copyable< T >::value > >
+	ByteView( const std::vector< T > &v ) :
+		m_data( reinterpret_cast< const char * >( v.data() ) ), m_size( v.size() * sizeof( T ) )
+	{}
+
+	/// Constructor from string
+	/// \param[in] s - string, which data will be referenced by the view
+	ByteView( const std::string &s ) : m_data( s.data() ), m_size( s.size() )
+	{}
+
+	/// Get pointer to the viewed memory block
+	const char *data() const
+	{
+		return m_data;
+	}
+
+	/// Get size of the viewed memory block in bytes
+	size_t size() const
+	{
+		return m_size;
+	}
+
+private:
+	const char *m_data = nullptr;  //!< pointer to the viewed memory block
+	size_t m_size = 0;             //!< size of the viewed memory block in bytes
+};
+
+/// Create the array of byte views referencing all inputs of the given frame.
+/// \param[in] frame is a vector of input data for each model input where each data element is a vector of bytes.
+/// \return vector of byte views: one view per model input
+template< typename T >
+std::vector< ByteView > byteViewsGet( const std::vector< std::vector< T > > &frame )
+{
+	return std::vector< ByteView >( frame.begin(), frame.end() );
+}
+
+/// FrameWriter is the interface of the writer, which sends the data of a single frame to AI server in chunks
+/// as the data becomes available. It allows sending very large frame inputs, which are produced gradually, for
+/// example, read from a file or decoded, without assembling them in memory: each chunk is sent before write()
+/// returns, so its memory can be reused for the next chunk right away. The total size of an input is not limited.
+/// Inputs are sent one after another in the order of model inputs: the last chunk of each input should be
+/// marked by the last argument of write(). The frame is complete when the last chunk of the last input is sent;
+/// then finish() should be called. When the writer is destroyed before the frame is finished, the frame is aborted:
+/// AI server drops it and reports an error for it, which ends the inference session.
+class FrameWriter
+{
+public:
+	/// Destructor. Aborts the frame, if it is not finished.
+	virtual ~FrameWriter()
+	{}
+
+	/// Send the next chunk of the current frame input.
+	/// \param[in] data - pointer to the chunk data
+	/// \param[in] size - size of the chunk data in bytes
+	/// \param[in] last - true when this is the last chunk of the current input; the next chunk then begins
+	/// the next input. The last chunk may be empty.
+	virtual void write( const void *data, size_t size, bool last = false ) = 0;
+
+	/// Finish the frame. It should be called after the last chunk of the last input is sent.
+	/// When the last chunk of the current input was not marked as last, the input is finished by an empty chunk.
+	/// No more chunks can be sent after that.
+	virtual void finish() = 0;
+};
+
+/// FrameSlot is the space reserved for the data of a single frame to be sent to AI server: the producer fills frame
+/// inputs in place and then commits the frame. With shared memory transport the space is located in the shared
+/// memory segment of the stream, so the frame data is never copied; otherwise it is a heap buffer, which is moved
+/// into the client on commit. When the slot is destroyed before it is committed, the frame is aborted: with shared
+/// memory transport its space cannot be reclaimed without a result, so the inference session ends with an error.
+class FrameSlot
+{
+public:
+	/// Destructor. Aborts the frame, if it is not committed.
+	virtual ~FrameSlot()
+	{}
+
+	/// Get the number of frame inputs
+	virtual size_t inputCountGet() const = 0;
+
+	/// Get the pointer to the data of the given frame input to be filled by the producer
+	/// \param[in] index - frame input index
+	/// \return pointer to the input data of the size requested when the slot was reserved
+	virtual void *inputDataGet( size_t index ) = 0;
+
+	/// Send the frame. The data of frame inputs should not be accessed after that.
+	virtual void commit() = 0;
+};
+
+/// Completion object of a single frame sent for asynchronous inference.
+/// It is used instead of the observation callback for frames sent by the dataSend() overload accepting it:
+/// exactly one of its methods is called for each such frame, either with the frame result, or when the frame
+/// is dropped without a result. Methods are called from the thread, which receives results, or from the thread
+/// sending frames. They may send new frames, but should not block: results of other frames are not received
+/// until they return. The object should stay alive until one of its methods is called.
+class FrameCompletion
+{
+public:
+	/// Destructor
+	virtual ~FrameCompletion()
+	{}
+
+	/// Called when the frame result is received. Results with server-side errors are passed here as well.
+	/// \param[in] result - frame inference result; it may be moved out
+	virtual void resultReady( json &&result ) = 0;
+
+	/// Called when the frame is dropped without result: according to frame overflow policy, when its deadline
+	/// is passed, or when the inference session is aborted due to error.
+	/// \param[in] reason - description of the reason why the frame is dropped
+	virtual void frameDropped( const std::string &reason ) = 0;
+};
+
 /// ModelInfo is the model identification structure. It keeps AI model key attributes.
 typedef struct ModelInfo
 {
@@ -0,0 +1,249 @@
+//////////////////////////////////////////////////////////////////////
+/// \file  dg_frame_ring.h
+/// \brief DG bounded ring of in-flight frame contexts
+///
+/// Copyright 2023 DeGirum Corporation
+///
+/// This file contains declaration of the bounded thread-safe
+/// multi-producer single-consumer ring, which is used to track
+/// frames posted for inference but not yet processed.
+///
+
+#ifndef DG_FRAME_RING_H_
+#define DG_FRAME_RING_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace DG
+{
+/// Bounded ring with multiple producers and single consumer. Elements are kept in the deque protected by the mutex:
+/// producers are serialized by the submission lock of the client anyway, so the mutex is never contended by
+/// producers, and is held only for the duration of push or pop. Pointers to elements stay valid until the elements
+/// are removed, so the consumer may access the oldest element without the lock while producers push new ones.
+/// Blocking is used only when somebody waits for a condition (e.g. free space in a full ring):
+/// waiters are counted, and the consumer wakes them up on pop only when there are any.
+/// The number of elements may be further limited below the capacity, so the ring allocated for the maximum
+/// number of elements can be used with varying limit.
+template< typename T >
+class FrameRing
+{
+public:
+	/// Constructor
+	/// \param[in] capacity - ring capacity
+	explicit FrameRing( size_t capacity = 0 )
+	{
+		reset( capacity );
+	}
+
+	FrameRing( const FrameRing & ) = delete;
+	FrameRing &operator=( const FrameRing & ) = delete;
+
+	/// Set new capacity dropping all elements. The limit is set equal to capacity.
+	/// Not thread-safe.
+	/// \param[in] capacity - new ring capacity
+	void reset( size_t capacity )
+	{
+		std::lock_guard< std::mutex > lock( m_mutex );
+		m_elements.clear();
+		m_capacity = capacity;
+		m_limit.store( capacity );
+	}
+
+	/// Drop all elements. Should be called only when no producers and no consumer are active.
+	void clear()
+	{
+		{
+			std::lock_guard< std::mutex > lock( m_mutex );
+			m_elements.clear();
+		}
+		notifyAll( false );
+	}
+
+	/// Get ring capacity
+	size_t capacity() const
+	{
+		return m_capacity;
+	}
+
+	/// Set the limit of the number of elements in the ring. Safe to call any time: when the limit is lowered below
+	/// the current number of elements, producers wait until the consumer brings it below the limit.
+	/// \param[in] limit - new limit; it is clamped to [1, capacity] range
+	void limitSet( size_t limit )
+	{
+		m_limit.store( std::min( std::max( limit, size_t{ 1 } ), m_capacity ) );
+		notifyAll( false );  // limit may be raised: let waiting producers retry
+	}
+
+	/// Get the limit of the number of elements in the ring
+	size_t limitGet() const
+	{
+		return m_limit.load();
+	}
+
+	/// Get the number of elements in the ring; the value may be outdated when producers or consumer are active
+	size_t size() const
+	{
+		std::lock_guard< std::mutex > lock( m_mutex );
+		return m_elements.size();
+	}
+
+	/// Check if the ring is empty; the value may be outdated when producers or consumer are active
+	bool empty() const
+	{
+		return size() == 0;
+	}
+
+	/// Try to push the element into the ring. Safe to call from multiple producer threads.
+	/// \param[in] value - value to push; it is forwarded only when the element is pushed
+	/// \return true if the element is pushed, false if the ring is full or the limit is reached
+	template< typename U >
+	bool tryPush( U &&value )
+	{
+		std::lock_guard< std::mutex > lock( m_mutex );
+		if( m_elements.size() >= std::min( m_capacity, m_limit.load() ) )
+			return false;
+		m_elements.emplace_back();
+		m_elements.back() = std::forward< U >( value );
+		return true;
+	}
+
+	/// Push the element into the ring, waiting for free space while the ring is full or the limit is reached.
+	/// Safe to call from multiple producer threads.
+	/// \param[in] value - value to push
+	/// \param[in] timeout - max. time to wait for free space
+	/// \param[in] cancelled - predicate, which returns true when waiting should be cancelled;
+	/// it is evaluated on each pop and on notifyAll() call
+	/// \return true if the element is pushed, false on timeout or cancellation
+	template< typename U, typename Pred >
+	bool push( U &&value, std::chrono::milliseconds timeout, Pred &&cancelled )
+	{
+		const auto deadline = std::chrono::steady_clock::now() + timeout;
+
+		// value is moved only on successful push, so it is safe to forward it on each attempt
+		while( !tryPush( std::forward< U >( value ) ) )
+		{
+			const auto now = std::chrono::steady_clock::now();
+			if( now >= deadline )
+				return false;
+			const auto time_left = std::chrono::duration_cast< std::chrono::milliseconds >( deadline - now );
+			if( !wait( [ & ] { return size() < limitGet() || cancelled(); }, time_left ) || cancelled() )
+				return false;
+		}
+		return true;
+	}
+
+	/// Get the oldest element of the ring. Should be called only by the consumer.
+	/// \return pointer to the oldest element or nullptr if the ring is empty
+	T *front()
+	{
+		std::lock_guard< std::mutex > lock( m_mutex );
+		return m_elements.empty() ? nullptr : &m_elements.front();
+	}
+
+	/// Get the element at given distance from the newest element of the ring. Should be called only when producers
+	/// are not active, and the element is not accessed by the consumer.
+	/// \param[in] index - distance from the newest element: 0 for the newest one
+	/// \return pointer to the element or nullptr if the ring has not so many elements
+	T *back( size_t index = 0 )
+	{
+		std::lock_guard< std::mutex > lock( m_mutex );
+		if( index >= m_elements.size() )
+			return nullptr;
+		return &m_elements[ m_elements.size() - 1 - index ];
+	}
+
+	/// Remove given number of the newest elements from the ring, which must exist. Should be called only when
+	/// producers are not active, and the elements are not accessed by the consumer. Waiters, if any, are notified.
+	/// \param[in] count - number of elements to remove
+	void popBack( size_t count )
+	{
+		{
+			std::lock_guard< std::mutex > lock( m_mutex );
+			m_elements.erase( m_elements.end() - count, m_elements.end() );
+		}
+		notifyAll( false );
+	}
+
+	/// Remove the oldest element from the ring, which must exist. Should be called only by the consumer.
+	/// Waiters, if any, are notified.
+	void pop()
+	{
+		{
+			std::lock_guard< std::mutex > lock( m_mutex );
+			m_elements.pop_front();
+		}
+		notifyAll( false );
+	}
+
+	/// Move the oldest element out of the ring. Should be called only by the consumer.
+	/// \param[out] value - where to move the element
+	/// \return true if the element was retrieved, false if the ring is empty
+	bool tryPop( T &value )
+	{
+		{
+			std::lock_guard< std::mutex > lock( m_mutex );
+			if( m_elements.empty() )
+				return false;
+			value = std::move( m_elements.front() );
+			m_elements.pop_front();
+		}
+		notifyAll( false );
+		return true;
+	}
+
+	/// Wait until given condition is met. The condition is evaluated on each pop and on notifyAll() call.
+	/// \param[in] condition - predicate, which returns true when the condition is met
+	/// \param[in] timeout - max. time to wait
+	/// \return the value of the condition at the end of waiting: false means timeout
+	template< typename Pred >
+	bool wait( Pred &&condition, std::chrono::milliseconds timeout )
+	{
+		// waiter is registered before the condition is checked, so the consumer either sees the waiter
+		// and notifies it under the lock, or the condition check sees the consumer progress
+		// the condition may throw, so waiter is unregistered by guard object
+		struct WaiterGuard
+		{
+			std::atomic_int &waiters;
+			WaiterGuard( std::atomic_int &w ) : waiters( w )
+			{
+				waiters++;
+			}
+			~WaiterGuard()
+			{
+				waiters--;
+			}
+		} guard( m_waiters );
+
+		std::unique_lock< std::mutex > lock( m_wait_mutex );
+		return m_cv.wait_for( lock, timeout, condition );
+	}
+
+	/// Wake up all waiters to reevaluate their conditions
+	/// \param[in] always - when false, the mutex is locked only when there are waiters
+	void notifyAll( bool always = true )
+	{
+		if( always || m_waiters.load() > 0 )
+		{
+			std::lock_guard< std::mutex > lock( m_wait_mutex );
+			m_cv.notify_all();
+		}
+	}
+
+private:
+	std::deque< T > m_elements;           //!< ring elements: the oldest one is in front
+	size_t m_capacity = 0;                //!< ring capacity
+	std::atomic< size_t > m_limit{ 0 };   //!< limit of the number of elements
+	mutable std::mutex m_mutex;           //!< mutex to protect m_elements
+	std::atomic_int m_waiters{ 0 };       //!< number of waiters
+	std::mutex m_wait_mutex;              //!< mutex for waiting
+	std::condition_variable m_cv;         //!< condition variable for waiting
+};
+
+}  // namespace DG
+
+#endif  // DG_FRAME_RING_H_
@@ -183,6 +183,15 @@ namespace DG
 			return json::from_msgpack( v );
 		}
 
+		/// Deserialize given memory block with msgpack data into JSON array
+		/// \param[in] data - pointer to msgpack data to deserialize
+		/// \param[in] size - size of msgpack data in bytes
+		/// \return JSON array
+		static json jsonDeserialize( const uint8_t *data, size_t size )
+		{
+			return json::from_msgpack( data, data + size );
+		}
+
 		/// Deserialize given string with msgpack data into JSON array
 		/// \param[in] v - byte vector with msgpack data to deserialize
 		/// \return JSON array
@@ -266,7 +275,7 @@ namespace DG
 			return t;
 		}
 
-		/// Check server JSON response for errors and throw exception, if any
+		/// Check server JSON response for errors and throw exception with ErrServerError code, if any
 		/// \param[in] response - JSON response from server/core
 		/// \param[in] source - description of the server command initiator
 		/// \param[in] do_throw - if true, throws exception in case of error
@@ -286,9 +295,9 @@ namespace DG
 					if( do_throw )
 					{
 						if( source.empty() )
-							DG_ERROR( msg, ErrOperationFailed );
+							DG_ERROR( msg, ErrServerError );
 						else
-							DG_ERROR( source + ": " + msg, ErrOperationFailed );
+							DG_ERROR( source + ": " + msg, ErrServerError );
 					}
 					return msg;  // error detected
 				}
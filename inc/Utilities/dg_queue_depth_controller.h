@@ -0,0 +1,282 @@
+//////////////////////////////////////////////////////////////////////
+/// \file  dg_queue_depth_controller.h
+/// \brief DG adaptive frame queue depth controller
+///
+/// Copyright 2023 DeGirum Corporation
+///
+/// This file contains declaration of the controller, which adjusts
+/// the number of outstanding frames of asynchronous inference session
+/// based on measured throughput and frame round-trip time.
+///
+
+#ifndef DG_QUEUE_DEPTH_CONTROLLER_H_
+#define DG_QUEUE_DEPTH_CONTROLLER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <mutex>
+#include <sstream>
+#include "Utilities/dg_client_structs.h"
+
+namespace DG
+{
+/// Adaptive frame queue depth controller.
+///
+/// Too small queue depth starves the server pipeline, while too large one only adds queueing latency.
+/// The controller measures each round of completed frames (at least one queue depth worth of them): throughput
+/// is the completion rate, and mean frame round-trip time follows from Little's law as the mean number of
+/// outstanding frames divided by throughput. The minimum of recent round-trip times estimates the latency of
+/// unloaded pipeline, so the number of frames, which the pipeline actually needs to stay busy, is throughput
+/// times that minimum, and the rest of outstanding frames is backlog waiting in queues.
+/// The depth is doubled while backlog is negligible and no excess was ever detected (startup), then it is
+/// increased by one while backlog stays below the low threshold, and decreased multiplicatively, but not below
+/// the pipeline needs, when backlog exceeds the high threshold. Queueing delay cannot be told from pipeline
+/// latency while queues are full, so the minimum round-trip time, which was not renewed for BASE_LATENCY_TTL,
+/// is measured again at halved depth for two rounds: one to drain queued frames and one to measure.
+///
+/// The depth is read by producers without locks. Measurements are made only by the single consumer, which
+/// reports completed frames; status is published under the lock once per round.
+class QueueDepthController
+{
+public:
+	/// Min. number of completed frames per measurement round
+	static constexpr size_t MIN_ROUND_FRAMES = 8;
+
+	/// Backlog, below which the depth grows, frames
+	static constexpr double BACKLOG_LOW = 1.0;
+
+	/// Backlog, above which the depth shrinks, frames
+	static constexpr double BACKLOG_HIGH = 3.0;
+
+	/// Multiplicative decrease factor
+	static constexpr double DECREASE_FACTOR = 0.75;
+
+	/// Ratio of mean outstanding frames to the depth, below which the producer is considered the bottleneck,
+	/// so the depth is kept
+	static constexpr double APP_LIMITED_RATIO = 0.75;
+
+	/// Lifetime of min. round-trip time estimate: it is measured again after that to follow load changes
+	static constexpr std::chrono::seconds BASE_LATENCY_TTL{ 10 };
+
+	/// Constructor
+	/// \param[in] depth - initial fixed depth
+	explicit QueueDepthController( size_t depth = DEFAULT_FRAME_QUEUE_DEPTH )
+	{
+		rangeSet( depth, depth, depth );
+	}
+
+	QueueDepthController( const QueueDepthController & ) = delete;
+	QueueDepthController &operator=( const QueueDepthController & ) = delete;
+
+	/// Set the range of adaptive depth. Should be called when no frames are outstanding.
+	/// \param[in] min_depth - lower bound of the depth
+	/// \param[in] max_depth - upper bound of the depth; when it is not greater than min_depth, the depth is fixed
+	/// \param[in] depth - initial depth; it is clamped to the range; in fixed mode it is the fixed depth
+	void rangeSet( size_t min_depth, size_t max_depth, size_t depth )
+	{
+		std::lock_guard< std::mutex > lock( m_mutex );
+		m_status = FrameQueueDepthStatus();
+		m_status.adaptive = max_depth > std::max( min_depth, size_t{ 1 } );
+		m_status.min_depth = std::max( m_status.adaptive ? min_depth : depth, size_t{ 1 } );
+		m_status.max_depth = m_status.adaptive ? max_depth : m_status.min_depth;
+		m_status.depth = std::min( std::max( depth, m_status.min_depth ), m_status.max_depth );
+		m_status.reason = m_status.adaptive ? "initial depth" : "fixed depth";
+		m_depth = m_status.depth;
+		m_startup = true;
+		m_probe_stage = ProbeStage::None;
+		m_base_latency_s = 0;
+		m_round_restart = true;
+	}
+
+	/// Reset the depth to the initial value. In fixed mode the value becomes both bounds of the range.
+	/// Should be called when no frames are outstanding.
+	/// \param[in] depth - initial depth
+	void depthReset( size_t depth )
+	{
+		const FrameQueueDepthStatus status = statusGet();
+		rangeSet( status.min_depth, status.max_depth, depth );
+	}
+
+	/// Get the current depth
+	size_t depthGet() const
+	{
+		return m_depth.load( std::memory_order_relaxed );
+	}
+
+	/// Get the upper bound of the depth: the capacity of frame queues
+	size_t capacityGet() const
+	{
+		std::lock_guard< std::mutex > lock( m_mutex );
+		return m_status.max_depth;
+	}
+
+	/// Get the depth status
+	FrameQueueDepthStatus statusGet() const
+	{
+		std::lock_guard< std::mutex > lock( m_mutex );
+		FrameQueueDepthStatus status = m_status;
+		status.depth = depthGet();
+		return status;
+	}
+
+	/// Start new measurement round, discarding the current one. Safe to call from any thread.
+	/// Should be called when frames start flowing after idle period, which would distort measurements.
+	void restart()
+	{
+		m_round_restart.store( true, std::memory_order_relaxed );
+	}
+
+	/// Account completed frame. Should be called only by the consumer of results.
+	/// \param[in] outstanding - number of outstanding frames including the completed one
+	/// \return true if the depth is changed
+	bool frameCompleted( size_t outstanding )
+	{
+		if( m_round_restart.exchange( false, std::memory_order_relaxed ) )
+			roundStart( std::chrono::steady_clock::now() );
+
+		m_round_frames++;
+		m_round_outstanding += outstanding;
+
+		const size_t depth = depthGet();
+		if( m_round_frames < std::max( depth, MIN_ROUND_FRAMES ) )
+			return false;
+
+		const auto now = std::chrono::steady_clock::now();
+		const double elapsed_s = std::chrono::duration< double >( now - m_round_start ).count();
+		const double outstanding_mean = double( m_round_outstanding ) / double( m_round_frames );
+		const double throughput = elapsed_s > 0 ? double( m_round_frames ) / elapsed_s : 0;
+		roundStart( now );
+
+		std::lock_guard< std::mutex > lock( m_mutex );
+		if( !m_status.adaptive || throughput <= 0 )
+			return false;
+
+		// Little's law: mean number of outstanding frames = throughput * mean round-trip time
+		const double latency_s = outstanding_mean / throughput;
+
+		std::ostringstream reason;
+		reason << std::fixed << std::setprecision( 2 );
+		size_t new_depth = depth;
+		bool probing = true;
+
+		if( m_probe_stage == ProbeStage::Drain )
+		{
+			// frames queued before the depth was reduced are drained: measure in the next round
+			m_probe_stage = ProbeStage::Measure;
+			reason << "draining frames queued before depth reduction to re-measure base round-trip time";
+		}
+		else if( m_probe_stage == ProbeStage::Measure )
+		{
+			// round-trip time at reduced depth replaces outdated estimate, which may include queueing delay
+			m_probe_stage = ProbeStage::None;
+			m_base_latency_s = latency_s;
+			m_base_latency_time = now;
+			new_depth = m_probe_saved_depth;
+			reason << "base round-trip time re-measured at depth " << depth << ", restoring depth";
+		}
+		else if( m_base_latency_s <= 0 || latency_s < m_base_latency_s )
+		{
+			m_base_latency_s = latency_s;
+			m_base_latency_time = now;
+			probing = false;
+		}
+		else if( now - m_base_latency_time > BASE_LATENCY_TTL && depth > m_status.min_depth )
+		{
+			// queueing delay cannot be told from pipeline latency without draining the queue: reduce depth
+			m_probe_stage = ProbeStage::Drain;
+			m_probe_saved_depth = depth;
+			new_depth = std::max( depth / 2, m_status.min_depth );
+			reason << "base round-trip time estimate is older than " << BASE_LATENCY_TTL.count()
+				   << " s, reducing depth to re-measure it";
+		}
+		else
+			probing = false;
+
+		const double needed = throughput * m_base_latency_s;
+		const double backlog = std::max( outstanding_mean - needed, 0.0 );
+
+		m_status.throughput_fps = throughput;
+		m_status.latency_ms = latency_s * 1000;
+		m_status.base_latency_ms = m_base_latency_s * 1000;
+		m_status.backlog_frames = backlog;
+
+		if( probing )
+		{
+			// depth is controlled by base round-trip time probe
+		}
+		else if( outstanding_mean < APP_LIMITED_RATIO * double( depth ) )
+		{
+			reason << "mean outstanding " << outstanding_mean << " frames is well below depth " << depth
+				   << ": frames are not supplied fast enough to fill the queue, keeping depth";
+		}
+		else if( backlog < BACKLOG_LOW )
+		{
+			new_depth = m_startup ? depth * 2 : depth + 1;
+			reason << "backlog " << backlog << " frames is below " << BACKLOG_LOW
+				   << ": pipeline may be starving, increasing depth";
+		}
+		else if( backlog > BACKLOG_HIGH )
+		{
+			m_startup = false;
+			const auto floor_depth = size_t( std::ceil( needed + BACKLOG_LOW ) );
+			new_depth = std::max( size_t( double( depth ) * DECREASE_FACTOR ), floor_depth );
+			reason << "backlog " << backlog << " frames is above " << BACKLOG_HIGH
+				   << ": frames wait in queues adding latency, decreasing depth";
+		}
+		else
+		{
+			m_startup = false;
+			reason << "backlog " << backlog << " frames is within [" << BACKLOG_LOW << ", " << BACKLOG_HIGH
+				   << "] range, keeping depth";
+		}
+
+		const size_t wanted_depth = new_depth;
+		new_depth = std::min( std::max( new_depth, m_status.min_depth ), m_status.max_depth );
+		if( new_depth != depth )
+			reason << " " << depth << " -> " << new_depth;
+		else if( wanted_depth != depth )
+			reason << ", but depth " << depth << " is at the bound of [" << m_status.min_depth << ", "
+				   << m_status.max_depth << "] range";
+		m_status.reason = reason.str();
+		m_depth.store( new_depth, std::memory_order_relaxed );
+		return new_depth != depth;
+	}
+
+private:
+	/// Stage of base round-trip time probe
+	enum class ProbeStage
+	{
+		None,     //!< no probe in progress
+		Drain,    //!< the depth is reduced: frames queued before are being drained
+		Measure,  //!< round-trip time at reduced depth is being measured
+	};
+
+	/// Start measurement round
+	/// \param[in] now - current time
+	void roundStart( std::chrono::steady_clock::time_point now )
+	{
+		m_round_start = now;
+		m_round_frames = 0;
+		m_round_outstanding = 0;
+	}
+
+	mutable std::mutex m_mutex;                                 //!< mutex to protect status and estimates
+	FrameQueueDepthStatus m_status;                             //!< published status; also keeps the depth range
+	std::atomic< size_t > m_depth{ 0 };                         //!< current depth
+	bool m_startup = true;                                      //!< the depth is doubled until excess is detected
+	ProbeStage m_probe_stage = ProbeStage::None;                //!< stage of base round-trip time probe
+	size_t m_probe_saved_depth = 0;                             //!< depth to restore after the probe
+	double m_base_latency_s = 0;                                //!< min. round-trip time recently observed, s
+	std::chrono::steady_clock::time_point m_base_latency_time;  //!< time when min. round-trip time was measured
+	std::atomic_bool m_round_restart{ true };                   //!< new round start is requested
+	std::chrono::steady_clock::time_point m_round_start;        //!< measurement round start time
+	size_t m_round_frames = 0;                                  //!< number of frames completed in the round
+	size_t m_round_outstanding = 0;                             //!< sum of outstanding frames sampled in the round
+};
+
+}  // namespace DG
+
+#endif  // DG_QUEUE_DEPTH_CONTROLLER_H_
@@ -8,8 +8,18 @@
 
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <cstring>
 #include <exception>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
+#include "Utilities/dg_client_structs.h"
 #include "Utilities/dg_tensor_structs.h"
 
 #include <asio.hpp>
@@ -20,8 +30,11 @@ namespace DG
 namespace main_protocol
 {
 
-/// Socket object type
-using socket_t = asio::ip::tcp::socket;
+/// Socket object type. Generic stream socket carries the protocol over either TCP or Unix domain socket.
+using socket_t = asio::generic::stream_protocol::socket;
+
+/// Socket endpoint type: either TCP or Unix domain socket endpoint
+using endpoint_t = socket_t::endpoint_type;
 
 /// I/O context object type
 using io_context_t = asio::io_context;
@@ -29,9 +42,25 @@ using io_context_t = asio::io_context;
 /// Protocol callback type. The callback is called as soon as server reply size is available.
 using callback_t = std::function< void( void ) >;
 
+/// Packet read completion callback type. The callback is called as soon as complete server reply is received
+/// or when error happens. Error code of the read operation is passed as the argument.
+using read_callback_t = std::function< void( const asio::error_code & ) >;
+
 // Header size, just a four byte int
 const int HEADER_SIZE = sizeof( uint32_t ) / sizeof( char );
 
+// Multiplexed packet header size: four byte stream ID followed by four byte packet size
+const int MUX_HEADER_SIZE = 2 * HEADER_SIZE;
+
+// Continuation marker of chunked packets. When it is set in the packet size header, the packet is a chunk of larger
+// packet, and more chunks of it follow; the last chunk has the marker cleared. The chunk with the marker set and
+// zero size aborts the packet being sent in chunks: the server drops the frame it belongs to and replies to that
+// frame with error result.
+const uint32_t CHUNK_CONTINUATION_FLAG = 0x80000000u;
+
+// Max. size of single chunk of chunked packet
+const size_t MAX_CHUNK_SIZE = CHUNK_CONTINUATION_FLAG - 1;
+
 // codes for supported commands
 namespace commands
 {
@@ -44,6 +73,7 @@ constexpr const char *SYSTEM_INFO = "system_info";
 constexpr const char *TRACE_MANAGE = "trace_manage";
 constexpr const char *ZOO_MANAGE = "zoo_manage";
 constexpr const char *DEV_CTRL = "dev_ctrl";
+constexpr const char *MUX = "mux";
 }  // namespace commands
 
 /// Error handling for asio errors (defined as macro to preserve file location info in error messages)
@@ -86,19 +116,426 @@ inline void stop( io_context_t &io_context )
 	io_context.stop();
 }
 
+/// Resolved server endpoints type
+using endpoints_t = std::vector< asio::ip::tcp::endpoint >;
+
+/// Process-wide cache of server host name resolutions.
+/// Host names are resolved asynchronously on the resolver own I/O thread, so callers wait for the result with
+/// a timeout, which is a part of their connection timeout. Successful resolutions are cached for the TTL, and
+/// failed ones are cached for the negative TTL, so repeated connections to the same server do not query system
+/// resolver again. Concurrent resolutions of the same host are coalesced into single query.
+/// Numeric IP addresses are converted to endpoints directly without any query.
+class Resolver
+{
+public:
+	/// Default TTL of successful resolutions, ms
+	static constexpr size_t DEFAULT_TTL_MS = 60000;
+
+	/// Default TTL of failed resolutions, ms
+	static constexpr size_t DEFAULT_NEGATIVE_TTL_MS = 1000;
+
+	/// Get process-wide resolver instance
+	static Resolver &instance()
+	{
+		static Resolver resolver;
+		return resolver;
+	}
+
+	Resolver( const Resolver & ) = delete;
+	Resolver &operator=( const Resolver & ) = delete;
+
+	/// Destructor. Stops resolver thread.
+	~Resolver()
+	{
+		m_work.reset();
+		m_io_context.stop();
+		if( m_thread.joinable() )
+			m_thread.join();
+	}
+
+	/// Configure cache TTLs. Cached resolutions are dropped.
+	/// \param[in] ttl_ms - TTL of successful resolutions, ms; 0 disables caching of successful resolutions
+	/// \param[in] negative_ttl_ms - TTL of failed resolutions, ms; 0 disables caching of failed resolutions
+	void configure( size_t ttl_ms, size_t negative_ttl_ms )
+	{
+		std::lock_guard< std::mutex > lk( m_mutex );
+		m_ttl_ms = ttl_ms;
+		m_negative_ttl_ms = negative_ttl_ms;
+		dropCompleted();
+	}
+
+	/// Drop all cached resolutions
+	void clear()
+	{
+		std::lock_guard< std::mutex > lk( m_mutex );
+		dropCompleted();
+	}
+
+	/// Drop cached resolution of given host, for example, when connection to resolved endpoints fails
+	/// \param[in] host - server domain name
+	/// \param[in] port - server TCP port number
+	void invalidate( const std::string &host, int port )
+	{
+		std::lock_guard< std::mutex > lk( m_mutex );
+		auto it = m_cache.find( keyGet( host, port ) );
+		if( it != m_cache.end() && it->second.expiration != std::chrono::steady_clock::time_point::max() )
+			m_cache.erase( it );
+	}
+
+	/// Resolve server address using the cache.
+	/// When the resolution is not completed in time, it keeps running: its result will be cached.
+	/// \param[in] host - server domain name or IP address string
+	/// \param[in] port - server TCP port number
+	/// \param[in] timeout_ms - max. time to wait for the resolution, ms; 0 to wait until completion
+	/// \return resolved endpoints; throws exception on resolution error or timeout
+	endpoints_t resolve( const std::string &host, int port, size_t timeout_ms )
+	{
+		// numeric addresses do not need resolution
+		asio::error_code ec;
+		const auto address = asio::ip::make_address_v4( host, ec );
+		if( !ec )
+			return { asio::ip::tcp::endpoint( address, static_cast< unsigned short >( port ) ) };
+
+		std::shared_future< Result > result;
+		{
+			std::lock_guard< std::mutex > lk( m_mutex );
+			const std::string key = keyGet( host, port );
+			auto it = m_cache.find( key );
+			if( it == m_cache.end() || it->second.expiration <= std::chrono::steady_clock::now() )
+				it = resolveStart( key, host, port );
+			result = it->second.result;
+		}
+
+		if( timeout_ms > 0 &&
+			result.wait_for( std::chrono::milliseconds( timeout_ms ) ) != std::future_status::ready )
+			DG_ERROR(
+				DG_FORMAT( "Timeout " << timeout_ms << " ms resolving " << host << ":" << port ),
+				ErrTimeout );
+
+		const Result &ret = result.get();
+		if( ret.error )
+			DG_ERROR(
+				DG_FORMAT( "Error resolving " << host << ":" << port << ": " << ret.error.message() ),
+				ErrSystem );
+		return ret.endpoints;
+	}
+
+private:
+	/// Resolution result
+	struct Result
+	{
+		asio::error_code error;  //!< resolution error
+		endpoints_t endpoints;   //!< resolved endpoints
+	};
+
+	/// Cache entry
+	struct Entry
+	{
+		std::shared_future< Result > result;               //!< resolution result
+		std::chrono::steady_clock::time_point expiration;  //!< expiration time; max() for pending resolution
+		uint64_t id;                                       //!< resolution identifier
+	};
+
+	io_context_t m_io_context;                                        //!< resolver I/O context
+	asio::executor_work_guard< io_context_t::executor_type > m_work;  //!< work guard to keep I/O context running
+	asio::ip::tcp::resolver m_resolver;                               //!< asynchronous resolver
+	std::thread m_thread;                                             //!< resolver thread
+	std::mutex m_mutex;                                               //!< mutex to protect the cache
+	std::map< std::string, Entry > m_cache;                           //!< cached resolutions per host:port key
+	uint64_t m_next_id = 0;                                           //!< next resolution identifier
+	size_t m_ttl_ms = DEFAULT_TTL_MS;                                 //!< TTL of successful resolutions, ms
+	size_t m_negative_ttl_ms = DEFAULT_NEGATIVE_TTL_MS;               //!< TTL of failed resolutions, ms
+
+	/// Constructor. Starts resolver thread.
+	Resolver() :
+		m_work( asio::make_work_guard( m_io_context ) ), m_resolver( m_io_context ),
+		m_thread( [ this ]() { m_io_context.run(); } )
+	{}
+
+	/// Compose cache key
+	static std::string keyGet( const std::string &host, int port )
+	{
+		return host + ":" + std::to_string( port );
+	}
+
+	/// Drop all completed resolutions; pending ones will be expired on completion. Should be called under m_mutex lock.
+	void dropCompleted()
+	{
+		for( auto it = m_cache.begin(); it != m_cache.end(); )
+			if( it->second.expiration != std::chrono::steady_clock::time_point::max() )
+				it = m_cache.erase( it );
+			else
+				++it;
+	}
+
+	/// Start asynchronous resolution and put pending entry into the cache. Should be called under m_mutex lock.
+	/// \param[in] key - cache key
+	/// \param[in] host - server domain name
+	/// \param[in] port - server TCP port number
+	/// \return iterator to the cache entry
+	std::map< std::string, Entry >::iterator resolveStart( const std::string &key, const std::string &host, int port )
+	{
+		auto promise = std::make_shared< std::promise< Result > >();
+		const uint64_t id = m_next_id++;
+		auto it = m_cache.insert_or_assign( key, Entry{ promise->get_future().share(),
+														 std::chrono::steady_clock::time_point::max(),
+														 id } )
+					  .first;
+
+		m_resolver.async_resolve(
+			asio::ip::tcp::v4(),
+			host,
+			std::to_string( port ),
+			[ this, key, id, promise ](
+				const asio::error_code &ec,
+				const asio::ip::tcp::resolver::results_type &results ) {
+				Result result;
+				result.error = ec;
+				for( const auto &r : results )
+					result.endpoints.push_back( r.endpoint() );
+				if( !result.error && result.endpoints.empty() )
+					result.error = asio::error::host_not_found;
+
+				{
+					// set expiration time, unless the entry was replaced meanwhile
+					std::lock_guard< std::mutex > lk( m_mutex );
+					auto entry = m_cache.find( key );
+					if( entry != m_cache.end() && entry->second.id == id )
+						entry->second.expiration = std::chrono::steady_clock::now() +
+							std::chrono::milliseconds( result.error ? m_negative_ttl_ms : m_ttl_ms );
+				}
+				promise->set_value( std::move( result ) );
+			} );
+		return it;
+	}
+};
+
+/// Compute timeout of connection attempt: the first attempt gets the time left after host name resolution,
+/// next attempts get full timeout
+/// \param[in] start - time when connection started
+/// \param[in] timeout_s - intended timeout in seconds; 0 means no timeout
+/// \param[in] attempt - attempt index
+/// \return attempt timeout in ms; 0 means no timeout
+inline size_t attempt_timeout_ms( std::chrono::steady_clock::time_point start, size_t timeout_s, int attempt )
+{
+	const size_t timeout_ms = timeout_s * 1000;
+	if( timeout_ms == 0 || attempt > 0 )
+		return timeout_ms;
+	const auto elapsed_ms = (size_t)std::chrono::duration_cast< std::chrono::milliseconds >(
+								std::chrono::steady_clock::now() - start )
+								.count();
+	return elapsed_ms < timeout_ms ? timeout_ms - elapsed_ms : 1;
+}
+
+/// Failure to set one socket option
+struct SocketOptionFailure
+{
+	std::string name;        //!< option name
+	asio::error_code error;  //!< error code
+};
+
+/// Apply client transport options to the socket.
+/// It is intended to be called before the socket is connected, so buffer sizes take part in TCP window negotiation.
+/// Each option is applied independently, so failure to set one option does not prevent others from being set.
+/// Options, which are not supported by the platform, are ignored.
+/// \param[in] handle - native socket handle
+/// \param[in] options - client transport options
+/// \param[in] tcp - true for TCP socket; otherwise only options, which are not specific to TCP, are applied
+/// \return failures of options, which cannot be set; empty when all options are set
+inline std::vector< SocketOptionFailure >
+socket_options_apply( socket_t::native_handle_type handle, const ClientOptions &options, bool tcp = true )
+{
+	std::vector< SocketOptionFailure > ret;
+	auto option_set = [ handle, &ret ]( const char *option_name, int level, int name, int value ) {
+		if( ::setsockopt( handle, level, name, reinterpret_cast< const char * >( &value ), sizeof( value ) ) == 0 )
+			return;
+#ifdef _WIN32
+		ret.push_back( { option_name, asio::error_code( ::WSAGetLastError(), asio::error::get_system_category() ) } );
+#else
+		ret.push_back( { option_name, asio::error_code( errno, asio::error::get_system_category() ) } );
+#endif
+	};
+
+	if( options.send_buffer_size > 0 )
+		option_set( "SO_SNDBUF", SOL_SOCKET, SO_SNDBUF, options.send_buffer_size );
+	if( options.receive_buffer_size > 0 )
+		option_set( "SO_RCVBUF", SOL_SOCKET, SO_RCVBUF, options.receive_buffer_size );
+	if( !tcp )
+		return ret;
+
+	option_set( "TCP_NODELAY", IPPROTO_TCP, TCP_NODELAY, options.tcp_no_delay ? 1 : 0 );
+#ifdef TCP_QUICKACK
+	if( options.tcp_quick_ack )
+		option_set( "TCP_QUICKACK", IPPROTO_TCP, TCP_QUICKACK, 1 );
+#endif
+#ifdef SO_BUSY_POLL
+	if( options.busy_poll_us > 0 )
+		option_set( "SO_BUSY_POLL", SOL_SOCKET, SO_BUSY_POLL, options.busy_poll_us );
+#endif
+	return ret;
+}
+
+/// Re-arm quick acknowledgement mode of the connected socket, when it is requested by client options.
+/// Linux does not keep TCP_QUICKACK: it falls back to delayed acknowledgements after the next one, so the option
+/// has to be set again after each receive. Errors are ignored: the option is only a hint.
+/// \param[in] socket - socket to use
+/// \param[in] options - client transport options
+inline void socket_quick_ack_rearm( socket_t &socket, const ClientOptions &options )
+{
+	if( !options.tcp_quick_ack || !socket.is_open() )
+		return;
+#ifdef TCP_QUICKACK
+	const int value = 1;
+	::setsockopt( socket.native_handle(), IPPROTO_TCP, TCP_QUICKACK, &value, sizeof( value ) );
+#endif
+}
+
+/// Check if endpoint is TCP endpoint
+/// \param[in] endpoint - endpoint to check
+inline bool endpoint_is_tcp( const endpoint_t &endpoint )
+{
+	const int family = endpoint.protocol().family();
+	return family == AF_INET || family == AF_INET6;
+}
+
+/// Convert endpoint to string for diagnostic messages
+/// \param[in] endpoint - endpoint to convert
+/// \return "address:port" string for TCP endpoint or socket file path for Unix domain socket endpoint
+inline std::string endpoint_to_string( const endpoint_t &endpoint )
+{
+	if( endpoint_is_tcp( endpoint ) )
+	{
+		asio::ip::tcp::endpoint tcp_endpoint;
+		std::memcpy( tcp_endpoint.data(), endpoint.data(), endpoint.size() );
+		return tcp_endpoint.address().to_string() + ":" + std::to_string( tcp_endpoint.port() );
+	}
+#if defined( ASIO_HAS_LOCAL_SOCKETS )
+	asio::local::stream_protocol::endpoint local_endpoint;
+	std::memcpy( local_endpoint.data(), endpoint.data(), endpoint.size() );
+	local_endpoint.resize( endpoint.size() );
+	return local_endpoint.path();
+#else
+	return "";
+#endif
+}
+
+/// Get endpoints of the server: resolve TCP server address using the cache or make Unix domain socket endpoint
+/// \param[in] server_address - server address
+/// \param[in] timeout_ms - max. time to wait for the resolution, ms; 0 to wait until completion
+/// \return server endpoints; throws exception on resolution error or timeout
+inline std::vector< endpoint_t > server_endpoints_get( const ServerAddress &server_address, size_t timeout_ms )
+{
+	if( server_address.is_local() )
+	{
+#if defined( ASIO_HAS_LOCAL_SOCKETS )
+		return { asio::local::stream_protocol::endpoint( server_address.ip ) };
+#else
+		DG_ERROR( "Unix domain sockets are not supported on this platform", ErrNotSupported );
+#endif
+	}
+
+	const endpoints_t endpoints = Resolver::instance().resolve( server_address.ip, server_address.port, timeout_ms );
+	return std::vector< endpoint_t >( endpoints.begin(), endpoints.end() );
+}
+
+/// Cancellation of the connection operation started by endpoints_connect_async(), when the I/O context is run
+/// by other threads. Connection steps are executed in the strand, so the cancellation posted to the same strand
+/// never runs concurrently with them.
+struct ConnectCancellation
+{
+	/// Constructor
+	/// \param[in] io_context - I/O context of the socket being connected
+	explicit ConnectCancellation( io_context_t &io_context ) : strand( asio::make_strand( io_context ) )
+	{}
+
+	asio::strand< io_context_t::executor_type > strand;  //!< strand, which serializes connection steps
+	bool cancelled = false;                               //!< no more endpoints should be tried; accessed in strand
+};
+
+/// Connect socket to the first reachable endpoint asynchronously, applying client transport options before each
+/// connection attempt. Unlike asio::async_connect(), it opens the socket by itself, so options, which affect
+/// connection establishment, take effect. Socket, endpoints and options must outlive the operation.
+/// \param[in,out] socket - socket to connect
+/// \param[in] endpoints - endpoints to try in order
+/// \param[in] options - client transport options
+/// \param[in] handler - completion handler; it receives the error code of the last connection attempt
+/// \param[in] index - index of the endpoint to try
+/// \param[in] cancellation - cancellation object, which strand runs connection steps (or nullptr, when the I/O
+/// context is run by the caller thread only); it must outlive the operation
+inline void endpoints_connect_async(
+	socket_t &socket,
+	const std::vector< endpoint_t > &endpoints,
+	const ClientOptions &options,
+	std::function< void( const asio::error_code & ) > handler,
+	size_t index = 0,
+	ConnectCancellation *cancellation = nullptr )
+{
+	if( index >= endpoints.size() )
+		return handler( asio::error::host_not_found );
+	if( cancellation != nullptr && cancellation->cancelled )
+		return handler( asio::error::operation_aborted );
+
+	asio::error_code ec;
+	socket.close( ec );
+	socket.open( endpoints[ index ].protocol(), ec );
+	if( ec )
+		return handler( ec );
+	const auto failures = socket_options_apply( socket.native_handle(), options, endpoint_is_tcp( endpoints[ index ] ) );
+	if( !failures.empty() )
+		return handler( failures.front().error );
+
+	auto connect_handler = [ &socket, &endpoints, &options, handler, index, cancellation ](
+							   const asio::error_code &result_error ) {
+		// cancellation by timeout stops the operation; other errors move on to the next endpoint
+		if( result_error && result_error != asio::error::operation_aborted && index + 1 < endpoints.size() )
+			endpoints_connect_async( socket, endpoints, options, handler, index + 1, cancellation );
+		else
+			handler( result_error );
+	};
+
+	if( cancellation != nullptr )
+		socket.async_connect( endpoints[ index ], asio::bind_executor( cancellation->strand, connect_handler ) );
+	else
+		socket.async_connect( endpoints[ index ], connect_handler );
+}
+
+/// Handle connection error: drop cached resolution of server host name and compose error message
+/// \param[in] server_address - server address
+/// \param[in] timeout_s - connection timeout in seconds
+/// \param[in] retries - number of connection attempts
+/// \param[in] error - error code of the last attempt
+/// \return error message
+inline std::string connect_error_handle(
+	const ServerAddress &server_address,
+	size_t timeout_s,
+	int retries,
+	const asio::error_code &error )
+{
+	// server may have moved: resolve again next time
+	if( !server_address.is_local() )
+		Resolver::instance().invalidate( server_address.ip, server_address.port );
+	return DG_FORMAT(
+		"Error connecting to " << std::string( server_address ) << " after " << retries << " retries with timeout "
+							   << timeout_s << " s: " << error.message() );
+}
+
 /// Open socket and connect to server
 /// \param[in,out] io_context - execution context
-/// \param[in] ip - server domain name or IP address string
-/// \param[in] port - server TCP port number
-/// \param[in] timeout_s - intended timeout in seconds
+/// \param[in] server_address - server address: TCP server host and port, or Unix domain socket path
+/// \param[in] timeout_s - intended timeout in seconds; host name resolution time counts toward the first attempt
+/// \param[in] options - client transport options to apply to the socket
+/// \param[in] retries - number of connection attempts
 /// \return socket object with established connection to server
-inline socket_t
-socket_connect( io_context_t &io_context, const std::string &ip, int port, size_t timeout_s, int retries = 3 )
+inline socket_t socket_connect(
+	io_context_t &io_context,
+	const ServerAddress &server_address,
+	size_t timeout_s,
+	const ClientOptions &options = ClientOptions(),
+	int retries = 3 )
 {
 	asio::error_code error;
-	asio::ip::tcp::resolver resolver( io_context );
-	asio::ip::tcp::resolver::results_type endpoints = resolver
-														  .resolve( asio::ip::tcp::v4(), ip, std::to_string( port ) );
+	const auto start = std::chrono::steady_clock::now();
+	const std::vector< endpoint_t > endpoints = server_endpoints_get( server_address, timeout_s * 1000 );
 	socket_t ret( io_context );
 
 	for( int attempt = 0; attempt < retries; attempt++ )
@@ -107,15 +544,12 @@ socket_connect( io_context_t &io_context, const std::string &ip, int port, size_
 
 		// Start the asynchronous operation itself. The lambda that is used as a
 		// callback will update the error variable when the operation completes.
-		asio::async_connect(
-			ret,
-			endpoints,
-			[ &error ]( const asio::error_code &result_error, const asio::ip::tcp::endpoint & /*result_endpoint*/ ) {
-				error = result_error;
-			} );
+		endpoints_connect_async( ret, endpoints, options, [ &error ]( const asio::error_code &result_error ) {
+			error = result_error;
+		} );
 
 		// Run the operation until it completes, or until the timeout.
-		run_async( io_context, timeout_s * 1000 );
+		run_async( io_context, attempt_timeout_ms( start, timeout_s, attempt ) );
 
 		// If the asynchronous operation completed successfully then the io_context
 		// would have been stopped due to running out of work. If it was not
@@ -139,30 +573,209 @@ socket_connect( io_context_t &io_context, const std::string &ip, int port, size_
 
 	// Report final error
 	if( error )
-		DG_ERROR(
-			DG_FORMAT(
-				"Error connecting to " << ip << ":" << port << " after " << retries << " retries with timeout "
-									   << timeout_s << " s: " << error.message() ),
-			ErrSystem );
+		DG_ERROR( connect_error_handle( server_address, timeout_s, retries, error ), ErrSystem );
 
-	ret.set_option( asio::ip::tcp::no_delay( true ) );
 	return ret;
 }
 
-/// Close given socket
+/// I/O engine: fixed pool of threads, which run single I/O context.
+/// It is used to drive sockets of many clients, so the number of I/O threads does not depend on the number of
+/// connections. All completion handlers are executed by pool threads.
+class IoEngine
+{
+public:
+	/// Create engine and start its worker threads.
+	/// The engine may be released from its own completion handler, for example, when the client, which holds
+	/// the last reference, is destroyed there. Worker thread cannot join itself, so in that case the engine is
+	/// destroyed by a separate thread outside the pool.
+	/// \param[in] thread_count - number of worker threads
+	/// \return pointer to created engine
+	static std::shared_ptr< IoEngine > create( size_t thread_count )
+	{
+		return std::shared_ptr< IoEngine >( new IoEngine( thread_count ), []( IoEngine *engine ) {
+			if( engine->isOwnThread() )
+				std::thread( [ engine ]() { delete engine; } ).detach();
+			else
+				delete engine;
+		} );
+	}
+
+	IoEngine( const IoEngine & ) = delete;
+	IoEngine &operator=( const IoEngine & ) = delete;
+
+	/// Destructor. Stops I/O context and joins worker threads. Must not be called by worker threads.
+	~IoEngine()
+	{
+		m_work.reset();
+		m_io_context.stop();
+		for( auto &t : m_threads )
+			if( t.joinable() )
+				t.join();
+	}
+
+	/// Get I/O context run by this engine
+	io_context_t &context()
+	{
+		return m_io_context;
+	}
+
+	/// Get the number of worker threads
+	size_t threadCountGet() const
+	{
+		return m_threads.size();
+	}
+
+	/// Open socket on engine I/O context and connect to server.
+	/// Unlike socket_connect(), it does not run I/O context by itself, relying on engine worker threads instead.
+	/// \param[in] server_address - server address: TCP server host and port, or Unix domain socket path
+	/// \param[in] timeout_s - intended timeout in seconds; host name resolution time counts toward the first attempt
+	/// \param[in] options - client transport options to apply to the socket
+	/// \param[in] retries - number of connection attempts
+	/// \return socket object with established connection to server
+	socket_t connect(
+		const ServerAddress &server_address,
+		size_t timeout_s,
+		const ClientOptions &options = ClientOptions(),
+		int retries = 3 )
+	{
+		asio::error_code error;
+		const auto start = std::chrono::steady_clock::now();
+		const std::vector< endpoint_t > endpoints = server_endpoints_get( server_address, timeout_s * 1000 );
+		socket_t ret( m_io_context );
+
+		for( int attempt = 0; attempt < retries; attempt++ )
+		{
+			std::promise< asio::error_code > result;
+			auto done = result.get_future();
+
+			// connection steps run in engine threads: they are serialized with the cancellation by the strand
+			ConnectCancellation cancellation( m_io_context );
+			asio::post( cancellation.strand, [ & ]() {
+				endpoints_connect_async(
+					ret,
+					endpoints,
+					options,
+					[ &result ]( const asio::error_code &result_error ) { result.set_value( result_error ); },
+					0,
+					&cancellation );
+			} );
+
+			// On timeout close the socket in the strand to cancel the outstanding operation, unless it is just
+			// completed, and wait for its completion
+			const size_t timeout_ms = attempt_timeout_ms( start, timeout_s, attempt );
+			if( timeout_ms > 0 &&
+				done.wait_for( std::chrono::milliseconds( timeout_ms ) ) != std::future_status::ready )
+			{
+				std::promise< void > cancelled;
+				asio::post( cancellation.strand, [ & ]() {
+					cancellation.cancelled = true;
+					if( done.wait_for( std::chrono::seconds( 0 ) ) != std::future_status::ready )
+					{
+						asio::error_code ec;
+						ret.close( ec );
+					}
+					cancelled.set_value();
+				} );
+				cancelled.get_future().wait();
+			}
+			error = done.get();
+
+			if( !error )
+				break;
+		}
+
+		if( error )
+			DG_ERROR( connect_error_handle( server_address, timeout_s, retries, error ), ErrSystem );
+
+		return ret;
+	}
+
+	/// Get process-wide shared engine
+	/// \return pointer to shared engine or nullptr if shared engine is not configured
+	static std::shared_ptr< IoEngine > sharedGet()
+	{
+		std::lock_guard< std::mutex > lk( sharedMutex() );
+		return sharedInstance();
+	}
+
+	/// Configure process-wide shared engine. Clients, which already use previous shared engine, keep using it.
+	/// \param[in] thread_count - number of worker threads; 0 to disable shared engine
+	static void sharedConfigure( size_t thread_count )
+	{
+		std::shared_ptr< IoEngine > engine = thread_count > 0 ? create( thread_count ) : nullptr;
+		std::lock_guard< std::mutex > lk( sharedMutex() );
+		sharedInstance().swap( engine );
+	}
+
+private:
+	io_context_t m_io_context;                                        //!< I/O context
+	asio::executor_work_guard< io_context_t::executor_type > m_work;  //!< work guard to keep I/O context running
+	std::vector< std::thread > m_threads;                             //!< worker threads
+
+	/// Constructor. Starts worker threads.
+	/// \param[in] thread_count - number of worker threads
+	explicit IoEngine( size_t thread_count ) : m_work( asio::make_work_guard( m_io_context ) )
+	{
+		m_threads.reserve( thread_count );
+		for( size_t ti = 0; ti < std::max( thread_count, size_t{ 1 } ); ti++ )
+			m_threads.emplace_back( [ this ]() { workerThread(); } );
+	}
+
+	/// Check if the calling thread is one of the engine worker threads
+	bool isOwnThread() const
+	{
+		const auto id = std::this_thread::get_id();
+		return std::any_of( m_threads.begin(), m_threads.end(), [ id ]( const std::thread &t ) {
+			return t.get_id() == id;
+		} );
+	}
+
+	/// Worker thread function
+	void workerThread()
+	{
+		for( ;; )
+		{
+			try
+			{
+				m_io_context.run();
+				break;  // normal exit: I/O context is stopped
+			}
+			catch( ... )
+			{}  // errors in completion handlers must be handled by clients: keep running
+		}
+	}
+
+	/// Shared engine instance storage
+	static std::shared_ptr< IoEngine > &sharedInstance()
+	{
+		static std::shared_ptr< IoEngine > instance;
+		return instance;
+	}
+
+	/// Shared engine instance mutex
+	static std::mutex &sharedMutex()
+	{
+		static std::mutex mx;
+		return mx;
+	}
+};
+
+/// Close given socket. Errors are ignored: the socket may be already disconnected by the peer
 inline void socket_close( socket_t &socket )
 {
-	socket.shutdown( socket_t::shutdown_both );
-	socket.close();
+	asio::error_code ec;
+	socket.shutdown( socket_t::shutdown_both, ec );
+	socket.close( ec );
 }
 
 /// Read all incoming data to buffer, synchronously
 /// \param[in] socket - socket to use. Must be connected
-/// \param[out] response_buffer - buffer for response. Will be resized as needed
+/// \param[out] response_buffer - buffer for response. Will be resized as needed; use DefaultInitAllocator
+/// to avoid zero-filling on resize
 /// \param[in] ignore_errors - if true, ignore errors and return 0 on error
 /// \return number of read bytes
-template< typename T = char >
-size_t read( socket_t &socket, std::vector< T > &response_buffer, bool ignore_errors = false )
+template< typename T = char, typename Alloc = std::allocator< T > >
+size_t read( socket_t &socket, std::vector< T, Alloc > &response_buffer, bool ignore_errors = false )
 {
 	asio::error_code error;
 	size_t bytes_read = 0;
@@ -177,7 +790,7 @@ size_t read( socket_t &socket, std::vector< T > &response_buffer, bool ignore_er
 		return 0;
 	else if( bytes_read < HEADER_SIZE )
 		DG_ERROR(
-			"Fail to read incoming packet length from socket " + socket.remote_endpoint().address().to_string(),
+			"Fail to read incoming packet length from socket " + endpoint_to_string( socket.remote_endpoint() ),
 			ErrOperationFailed );
 	if( !throw_exception_if_error_is_serious( error, ignore_errors ) )
 		return 0;
@@ -216,7 +829,7 @@ inline size_t read( socket_t &socket, BasicTensor *response_buffer, bool ignore_
 		return 0;
 	else if( bytes_read < HEADER_SIZE )
 		DG_ERROR(
-			"Fail to read incoming packet length from socket " + socket.remote_endpoint().address().to_string(),
+			"Fail to read incoming packet length from socket " + endpoint_to_string( socket.remote_endpoint() ),
 			ErrOperationFailed );
 	if( !throw_exception_if_error_is_serious( error, ignore_errors ) )
 		return 0;
@@ -246,8 +859,8 @@ inline size_t write( socket_t &socket, const char *request_buffer, size_t packet
 	uint32_t big_endian_size = 0;
 	const char *size_buffer = reinterpret_cast< const char * >( &big_endian_size );
 
-	// Prepare a 4 byte packet to signal message length
-	assert( int( packet_size ) < ( std::numeric_limits< int32_t >::max )() );
+	// Prepare a 4 byte packet to signal message length; larger packets should be sent by write_chunk()
+	assert( packet_size < size_t( ( std::numeric_limits< int32_t >::max )() ) );
 	big_endian_size = htonl( static_cast< uint32_t >( packet_size ) );
 
 	// Signal message length
@@ -262,18 +875,240 @@ inline size_t write( socket_t &socket, const char *request_buffer, size_t packet
 	return bytes_sent;
 }
 
-/// Asynchronously write data to socket.
+/// Compose size header of packet chunk
+/// \param[in] size - chunk size; should not exceed MAX_CHUNK_SIZE
+/// \param[in] last - true for the last chunk of the packet
+/// \return chunk header in network byte order
+inline uint32_t chunk_header_get( size_t size, bool last )
+{
+	assert( size <= MAX_CHUNK_SIZE );
+	return htonl( static_cast< uint32_t >( size ) | ( last ? 0 : CHUNK_CONTINUATION_FLAG ) );
+}
+
+/// Write next chunk of a packet to socket, synchronously.
+/// The packet is sent as a sequence of chunks, so it may be sent as soon as its parts become available,
+/// and its total size is not limited. The chunk larger than MAX_CHUNK_SIZE is split into several chunks.
+/// \param[in] socket - socket to use. Must be connected
+/// \param[in] data - chunk data to send
+/// \param[in] size - size of chunk data, in bytes
+/// \param[in] last - true for the last chunk of the packet; the last chunk may be empty
+/// \param[in] ignore_errors - if true, ignore errors and return 0 on error
+/// \return number of written payload bytes (headers are not counted)
+inline size_t write_chunk( socket_t &socket, const char *data, size_t size, bool last, bool ignore_errors = false )
+{
+	asio::error_code error;
+	size_t bytes_sent = 0;
+
+	// Empty chunk, which is not the last one, would be taken for abort marker
+	if( size == 0 && !last )
+		return 0;
+
+	do
+	{
+		const size_t chunk_size = std::min( size - bytes_sent, MAX_CHUNK_SIZE );
+		const bool last_chunk = last && bytes_sent + chunk_size == size;
+		const uint32_t header = chunk_header_get( chunk_size, last_chunk );
+		const std::array< asio::const_buffer, 2 > bufs = { asio::buffer( &header, HEADER_SIZE ),
+														   asio::buffer( data + bytes_sent, chunk_size ) };
+		asio::write( socket, bufs, error );
+		if( !throw_exception_if_error_is_serious( error, ignore_errors ) )
+			return 0;
+		bytes_sent += chunk_size;
+	} while( bytes_sent < size );
+
+	return bytes_sent;
+}
+
+/// Abort the packet being sent in chunks by write_chunk(): the server drops the frame the packet belongs to
+/// and replies to that frame with error result
+/// \param[in] socket - socket to use. Must be connected
+/// \param[in] ignore_errors - if true, ignore errors
+inline void write_chunk_abort( socket_t &socket, bool ignore_errors = false )
+{
+	asio::error_code error;
+	const uint32_t header = htonl( CHUNK_CONTINUATION_FLAG );
+	asio::write( socket, asio::buffer( &header, HEADER_SIZE ), error );
+	throw_exception_if_error_is_serious( error, ignore_errors );
+}
+
+#if !defined( _WIN32 )
+
+/// Pass file descriptor to the peer process over Unix domain socket, synchronously.
+/// The descriptor is sent in SCM_RIGHTS ancillary data of single zero byte, which follows the packets written
+/// before; the peer receives it by descriptor_receive(). The peer gets its own descriptor of the same open file,
+/// so access rights of the file are not checked again.
+/// \param[in] socket - Unix domain socket to use. Must be connected
+/// \param[in] fd - file descriptor to pass
+inline void descriptor_send( socket_t &socket, int fd )
+{
+	char byte = 0;
+	iovec iov = { &byte, 1 };
+	alignas( cmsghdr ) char control[ CMSG_SPACE( sizeof( int ) ) ] = {};
+	msghdr msg = {};
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof( control );
+	cmsghdr *cmsg = CMSG_FIRSTHDR( &msg );
+	cmsg->cmsg_level = SOL_SOCKET;
+	cmsg->cmsg_type = SCM_RIGHTS;
+	cmsg->cmsg_len = CMSG_LEN( sizeof( int ) );
+	std::memcpy( CMSG_DATA( cmsg ), &fd, sizeof( fd ) );
+
+#if defined( MSG_NOSIGNAL )
+	const int flags = MSG_NOSIGNAL;
+#else
+	const int flags = 0;
+#endif
+	for( ;; )
+	{
+		if( ::sendmsg( socket.native_handle(), &msg, flags ) == 1 )
+			return;
+
+		// socket is in non-blocking mode, when asynchronous operations were used on it: wait until it is writable
+		asio::error_code error( errno, asio::error::get_system_category() );
+		if( errno == EAGAIN || errno == EWOULDBLOCK )
+			socket.wait( socket_t::wait_write, error );
+		else if( errno == EINTR )
+			error.clear();
+		if( error )
+			DG_ERROR( "Error passing file descriptor over socket: " + error.message(), ErrSystem );
+	}
+}
+
+/// Receive file descriptor passed by descriptor_send(), synchronously
+/// \param[in] socket - Unix domain socket to use. Must be connected
+/// \return received file descriptor, which the caller should close
+inline int descriptor_receive( socket_t &socket )
+{
+	char byte = 0;
+	iovec iov = { &byte, 1 };
+	alignas( cmsghdr ) char control[ CMSG_SPACE( sizeof( int ) ) ] = {};
+	msghdr msg = {};
+	msg.msg_iov = &iov;
+	msg.msg_iovlen = 1;
+	msg.msg_control = control;
+	msg.msg_controllen = sizeof( control );
+
+	for( ;; )
+	{
+		const auto ret = ::recvmsg( socket.native_handle(), &msg, 0 );
+		if( ret == 0 )
+			DG_ERROR( "Connection closed while receiving file descriptor", ErrOperationFailed );
+		if( ret > 0 )
+			break;
+
+		// socket is in non-blocking mode, when asynchronous operations were used on it: wait until it is readable
+		asio::error_code error( errno, asio::error::get_system_category() );
+		if( errno == EAGAIN || errno == EWOULDBLOCK )
+			socket.wait( socket_t::wait_read, error );
+		else if( errno == EINTR )
+			error.clear();
+		if( error )
+			DG_ERROR( "Error receiving file descriptor from socket: " + error.message(), ErrSystem );
+	}
+
+	const cmsghdr *cmsg = CMSG_FIRSTHDR( &msg );
+	if( ( msg.msg_flags & MSG_CTRUNC ) != 0 || cmsg == nullptr || cmsg->cmsg_level != SOL_SOCKET ||
+		cmsg->cmsg_type != SCM_RIGHTS || cmsg->cmsg_len != CMSG_LEN( sizeof( int ) ) )
+		DG_ERROR( "File descriptor is expected, but not received from socket", ErrOperationFailed );
+
+	int fd = -1;
+	std::memcpy( &fd, CMSG_DATA( cmsg ), sizeof( fd ) );
+	return fd;
+}
+
+#endif  // !_WIN32
+
+/// Prepare scatter/gather list for all inputs of one frame.
+/// Each input is framed the same way as by write(): 4-byte big-endian size header followed by input data.
+/// \param[in] frame - array of frame inputs; each element should provide data() and size() methods
+/// \param[out] headers - storage for size headers: at least frame.size() elements; must stay valid until data is sent
+/// \param[in,out] bufs - gather list to append header and data buffers to
+/// \return number of payload bytes (headers are not counted)
+template< typename Container >
+size_t frame_buffers_prepare(
+	const std::vector< Container > &frame,
+	uint32_t *headers,
+	std::vector< asio::const_buffer > &bufs )
+{
+	size_t bytes_total = 0;
+	for( size_t i = 0; i < frame.size(); i++ )
+	{
+		const size_t packet_size = frame[ i ].size() * sizeof( *frame[ i ].data() );
+		assert( packet_size < size_t( ( std::numeric_limits< int32_t >::max )() ) );
+		headers[ i ] = htonl( static_cast< uint32_t >( packet_size ) );
+		bufs.push_back( asio::buffer( &headers[ i ], HEADER_SIZE ) );
+		if( packet_size > 0 )
+			bufs.push_back( asio::buffer( frame[ i ].data(), packet_size ) );
+		bytes_total += packet_size;
+	}
+	return bytes_total;
+}
+
+/// Write all inputs of multiple frames to socket, synchronously, using single scatter/gather write.
+/// Each input is framed the same way as by write(): 4-byte big-endian size header followed by input data.
+/// \param[in] socket - socket to use. Must be connected
+/// \param[in] frames - pointer to the array of frames; each frame is an array of frame inputs,
+/// each element of which should provide data() and size() methods
+/// \param[in] frame_count - number of frames to write
+/// \param[in] ignore_errors - if true, ignore errors and return 0 on error
+/// \return number of written payload bytes (headers are not counted)
+template< typename Container >
+size_t write_frames(
+	socket_t &socket,
+	const std::vector< Container > *frames,
+	size_t frame_count,
+	bool ignore_errors = false )
+{
+	asio::error_code error;
+	size_t input_count = 0;
+	for( size_t fi = 0; fi < frame_count; fi++ )
+		input_count += frames[ fi ].size();
+
+	std::vector< uint32_t > headers( input_count );
+	std::vector< asio::const_buffer > bufs;
+	bufs.reserve( 2 * input_count );
+
+	// Prepare headers and gather list
+	size_t bytes_total = 0;
+	uint32_t *frame_headers = headers.data();
+	for( size_t fi = 0; fi < frame_count; fi++ )
+	{
+		bytes_total += frame_buffers_prepare( frames[ fi ], frame_headers, bufs );
+		frame_headers += frames[ fi ].size();
+	}
+
+	// Send all headers and messages at once
+	asio::write( socket, bufs, error );
+	if( !throw_exception_if_error_is_serious( error, ignore_errors ) )
+		return 0;
+	return bytes_total;
+}
+
+/// Write all inputs of one frame to socket, synchronously, using single scatter/gather write.
+/// Each input is framed the same way as by write(): 4-byte big-endian size header followed by input data.
+/// \param[in] socket - socket to use. Must be connected
+/// \param[in] frame - array of frame inputs; each element should provide data() and size() methods
+/// \param[in] ignore_errors - if true, ignore errors and return 0 on error
+/// \return number of written payload bytes (headers are not counted)
+template< typename Container >
+size_t write_frame( socket_t &socket, const std::vector< Container > &frame, bool ignore_errors = false )
+{
+	return write_frames( socket, &frame, 1, ignore_errors );
+}
+
+/// Asynchronously write data to socket taking ownership of the data buffer: no data copy is made.
 /// run_async() should be running in some worker thread to process event loop.
 /// \param[in] socket - socket to use. Must be connected
-/// \param[in] request_buffer - data to send
-/// \param[in] packet_size - size of data to send, in bytes
+/// \param[in] data - data to send; it is moved into the write context and kept there until the write completes
 /// \return completion waiting function.
 /// It returns true if all bytes were sent, false otherwise.
 /// It accepts timeout in ms. Pass zero to query current state without waiting.
-inline std::function< bool( size_t ) > write_async( socket_t &socket, const char *request_buffer, size_t packet_size )
+inline std::function< bool( size_t ) > write_async( socket_t &socket, std::vector< char > &&data )
 {
 	// Prepare a 4 byte packet to signal message length
-	assert( int( packet_size ) < ( std::numeric_limits< int32_t >::max )() );
+	assert( data.size() < size_t( ( std::numeric_limits< int32_t >::max )() ) );
 
 	/// Data structure which stores async. write execution context
 	struct WriteContext
@@ -285,18 +1120,15 @@ inline std::function< bool( size_t ) > write_async( socket_t &socket, const char
 		std::vector< char > data;              //!< data to transfer
 
 		/// Constructor
-		/// \param[in] request_buffer - data to send
-		/// \param[in] packet_size - size of data to send, in bytes
-		WriteContext( const char *request_buffer, size_t packet_size ) :
-			big_endian_size( htonl( static_cast< uint32_t >( packet_size ) ) ),
-			bytes_total( HEADER_SIZE + packet_size ), data( packet_size )
-		{
-			std::memcpy( data.data(), request_buffer, packet_size );
-		}
+		/// \param[in] data - data to send
+		WriteContext( std::vector< char > &&data ) :
+			bytes_total( HEADER_SIZE + data.size() ),
+			big_endian_size( htonl( static_cast< uint32_t >( data.size() ) ) ), data( std::move( data ) )
+		{}
 	};
 
 	// Create write context
-	auto write_context = std::make_shared< WriteContext >( request_buffer, packet_size );
+	auto write_context = std::make_shared< WriteContext >( std::move( data ) );
 
 	// Write completion event handler
 	auto write_handler = [ write_context ]( const asio::error_code &ec, std::size_t bytes_transferred ) {
@@ -332,6 +1164,17 @@ inline std::function< bool( size_t ) > write_async( socket_t &socket, const char
 	};
 }
 
+/// Asynchronously write data to socket.
+/// run_async() should be running in some worker thread to process event loop.
+/// \param[in] socket - socket to use. Must be connected
+/// \param[in] request_buffer - data to send; it is copied, so it may be released right after the call
+/// \param[in] packet_size - size of data to send, in bytes
+/// \return completion waiting function: see write_async() overload accepting data vector
+inline std::function< bool( size_t ) > write_async( socket_t &socket, const char *request_buffer, size_t packet_size )
+{
+	return write_async( socket, std::vector< char >( request_buffer, request_buffer + packet_size ) );
+}
+
 /// Initiate a reply read, the result of which will be supplied to a callback. Use after sending a frame.
 /// This function just queues a read of four bytes to get the message length. Do not call more than once before handling
 /// the reply! run_async() should be running in some worker thread to process event loop. \param[in] socket - socket to
@@ -357,12 +1200,47 @@ inline void initiate_read( socket_t &socket, uint32_t *read_size, callback_t asy
 		} );
 }
 
+/// Initiate asynchronous read of complete reply packet: both size header and packet body are read asynchronously.
+/// Use after sending a frame. Do not call more than once before completion callback is called!
+/// Some thread should run I/O context to process event loop.
+/// \param[in] socket - socket to use. Must be connected
+/// \param[out] read_size - pointer to result packet size. Must be preallocated and stay valid until completion
+/// \param[out] response_buffer - buffer for packet body. Will be resized as needed. Must stay valid until completion
+/// \param[in] completion_callback - callback called on completion or on error; it is responsible for error handling
+template< typename T, typename Alloc >
+inline void initiate_packet_read(
+	socket_t &socket,
+	uint32_t *read_size,
+	std::vector< T, Alloc > &response_buffer,
+	read_callback_t completion_callback )
+{
+	asio::async_read(
+		socket,
+		asio::buffer( read_size, HEADER_SIZE ),
+		[ &socket, read_size, &response_buffer, completion_callback ](
+			const asio::error_code &error,
+			size_t /*bytes_transferred*/ ) {
+			if( error )
+				return completion_callback( error );
+
+			// Convert size to host endianness and read packet body
+			*read_size = ntohl( *read_size );
+			response_buffer.resize( *read_size / sizeof( T ) );
+			asio::async_read(
+				socket,
+				asio::buffer( response_buffer ),
+				[ completion_callback ]( const asio::error_code &error, size_t /*bytes_transferred*/ ) {
+					completion_callback( error );
+				} );
+		} );
+}
+
 /// Handle reading a reply. Call after the callback from initiate_read has received packet length
 /// \param[in] socket - socket to use. Must be connected
 /// \param[in] async_result_callback - callback for reply
 /// \param[in] read_size - packet size to read in bytes as returned from initiate_read()
-template< typename T = char >
-inline void handle_read( socket_t &socket, std::vector< T > &response_buffer, uint32_t read_size )
+template< typename T = char, typename Alloc = std::allocator< T > >
+inline void handle_read( socket_t &socket, std::vector< T, Alloc > &response_buffer, uint32_t read_size )
 {
 	asio::error_code error;
 
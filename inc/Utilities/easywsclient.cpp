@@ -106,7 +106,10 @@ using easywsclient::Callback_Imp;
 namespace
 {  // private module-only namespace
 
-socket_t hostname_connect( const std::string &hostname, int port )
+socket_t hostname_connect(
+	const std::string &hostname,
+	int port,
+	const easywsclient::WebSocket::socket_setup_t &socket_setup )
 {
 	DG_TRC_BLOCK( easywsclient, hostname_connect, DGTrace::lvlDetailed, "hostname %s:%d", hostname.c_str(), port );
 
@@ -136,6 +139,10 @@ socket_t hostname_connect( const std::string &hostname, int port )
 		{
 			continue;
 		}
+		if( socket_setup )
+		{
+			socket_setup( static_cast< std::uintptr_t >( sockfd ) );
+		}
 		if( connect( sockfd, p->ai_addr, p->ai_addrlen ) != SOCKET_ERROR )
 		{
 			break;
@@ -162,6 +169,8 @@ public:
 	{}
 	void sendBinary( const std::vector< char > &message )
 	{}
+	void sendBinary( const void *message, size_t size )
+	{}
 	void sendPing()
 	{}
 	void close()
@@ -455,8 +464,12 @@ public:
 					}
 				}
 
-				receivedData_.resize( receivedData_.size() + (size_t)ws.N );
-				std::memcpy( &receivedData_[ receivedData_.size() - (size_t)ws.N ], &rxbuf_[ ws.header_size ], (size_t)ws.N );
+				// append without zero-filling; receivedData_ is cleared after dispatch but keeps its capacity,
+				// so it is effectively a recycled receive buffer
+				receivedData_.insert(
+					receivedData_.end(),
+					rxbuf_.begin() + ws.header_size,
+					rxbuf_.begin() + ws.header_size + (size_t)ws.N );
 				if( ws.fin )
 				{
 					callable( receivedData_ );
@@ -519,6 +532,11 @@ public:
 		sendData( wsheader_type::BINARY_FRAME, message.size(), message.data() );
 	}
 
+	void sendBinary( const void *message, size_t size )
+	{
+		sendData( wsheader_type::BINARY_FRAME, size, static_cast< const uint8_t * >( message ) );
+	}
+
 	template< class Element >
 	void sendData( wsheader_type::opcode_type type, uint64_t message_size, Element *message_begin )
 	{
@@ -609,7 +627,11 @@ public:
 	}
 };
 
-easywsclient::WebSocket::pointer from_url( const std::string &url, bool useMask, const std::string &origin )
+easywsclient::WebSocket::pointer from_url(
+	const std::string &url,
+	bool useMask,
+	const std::string &origin,
+	const easywsclient::WebSocket::socket_setup_t &socket_setup = nullptr )
 {
 	DG_TRC_BLOCK( easywsclient, from_url, DGTrace::lvlDetailed, "url %s", url.c_str() );
 
@@ -648,7 +670,7 @@ easywsclient::WebSocket::pointer from_url( const std::string &url, bool useMask,
 		return NULL;
 	}
 
-	socket_t sockfd = hostname_connect( host, port );
+	socket_t sockfd = hostname_connect( host, port, socket_setup );
 	if( sockfd == INVALID_SOCKET )
 	{
 		DG_ERROR( DG_FORMAT( "WebSocket: unable to connect to " << host << ":" << port ), ErrOperationFailed );
@@ -729,8 +751,11 @@ easywsclient::WebSocket::pointer from_url( const std::string &url, bool useMask,
 		DG_TRC_POINT( easywsclient, from_url : verify_done, DGTrace::lvlFull );
 
 	}
-	int flag = 1;
-	setsockopt( sockfd, IPPROTO_TCP, TCP_NODELAY, (char *)&flag, sizeof( flag ) );  // Disable Nagle's algorithm
+	if( !socket_setup )
+	{
+		int flag = 1;
+		setsockopt( sockfd, IPPROTO_TCP, TCP_NODELAY, (char *)&flag, sizeof( flag ) );  // Disable Nagle's algorithm
+	}
 #ifdef _WIN32
 	u_long on = 1;
 	ioctlsocket( sockfd, FIONBIO, &on );
@@ -757,9 +782,10 @@ WebSocket::pointer WebSocket::from_url( const std::string &url, const std::strin
 	return ::from_url( url, true, origin );
 }
 
-WebSocket::pointer WebSocket::from_url_no_mask( const std::string &url, const std::string &origin )
+WebSocket::pointer
+WebSocket::from_url_no_mask( const std::string &url, const std::string &origin, const socket_setup_t &socket_setup )
 {
-	return ::from_url( url, false, origin );
+	return ::from_url( url, false, origin, socket_setup );
 }
 
 }  // namespace easywsclient
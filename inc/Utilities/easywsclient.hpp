@@ -32,6 +32,8 @@ THE SOFTWARE.
 // wget https://raw.github.com/dhbaird/easywsclient/master/easywsclient.hpp
 // wget https://raw.github.com/dhbaird/easywsclient/master/easywsclient.cpp
 
+#include <cstdint>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -59,10 +61,16 @@ public:
 		OPEN
 	} readyStateValues;
 
+	// Socket setup callback: called with native socket handle before the socket is connected
+	typedef std::function< void( std::uintptr_t ) > socket_setup_t;
+
 	// Factories:
 	static pointer create_dummy();
 	static pointer from_url( const std::string &url, const std::string &origin = std::string() );
-	static pointer from_url_no_mask( const std::string &url, const std::string &origin = std::string() );
+	static pointer from_url_no_mask(
+		const std::string &url,
+		const std::string &origin = std::string(),
+		const socket_setup_t &socket_setup = nullptr );
 
 	// Interfaces:
 	virtual ~WebSocket()
@@ -72,6 +80,7 @@ public:
 	virtual void sendBinary( const std::string &message ) = 0;
 	virtual void sendBinary( const std::vector< uint8_t > &message ) = 0;
 	virtual void sendBinary( const std::vector< char > &message ) = 0;
+	virtual void sendBinary( const void *message, size_t size ) = 0;
 	virtual void sendPing() = 0;
 	virtual void close() = 0;
 	virtual readyStateValues getReadyState() const = 0;